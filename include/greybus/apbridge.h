@@ -12,11 +12,17 @@
 #define _GREYBUS_APBRIDGE_H_
 
 #include <greybus/greybus_messages.h>
+#include <zephyr/sys/atomic.h>
 
-#define AP_MAX_NODES  CONFIG_GREYBUS_APBRIDGE_CPORTS
-#define SVC_INF_ID    0
-#define AP_INF_ID     1
-#define INTF_START_ID 2
+/* Maximum number of simultaneous connections */
+#define AP_MAX_NODES      CONFIG_GREYBUS_APBRIDGE_CPORTS
+#define AP_MAX_INTERFACES CONFIG_GREYBUS_APBRIDGE_INTERFACES
+#define SVC_INF_ID        0
+#define AP_INF_ID         1
+#define INTF_START_ID     2
+
+/* Highest cport id of the UniPro cport space */
+#define GB_APBRIDGE_CPORT_ID_MAX 4095
 
 struct gb_interface;
 
@@ -27,6 +33,9 @@ struct gb_interface;
  * @param greybus message to send
  * @param Cport to write to
  *
+ * With CONFIG_GREYBUS_APBRIDGE_TX_QUEUE, called from a TX worker thread. Blocking then only
+ * holds up messages to this interface.
+ *
  * @return 0 if successful. Negative in case of error
  */
 typedef int (*gb_controller_write_callback_t)(struct gb_interface *, struct gb_message *, uint16_t);
@@ -53,12 +62,15 @@ typedef void (*gb_controller_destroy_connection_t)(struct gb_interface *, uint16
  * A greybus interface. Can have multiple Cports
  *
  * @param id: Interface ID
- * @param write: a non-blocking write function. The ownership of message is
- * transferred.
+ * @param write: write function. The ownership of message is transferred. Should not block for
+ * long, gb_interface_remove() waits for writes in progress.
  * @param create_connection: Called when a new connection with a cport is created. Optional.
  * @param destroy_connection: Called when an existing connection with a cport is destroyed.
  * Optional.
  * @param ctrl_data: private controller data
+ * @param returns_credits: The controller calls gb_apbridge_credit_return() once it consumed a
+ * message. Otherwise the credit comes back as soon as write returns. Only used with
+ * CONFIG_GREYBUS_APBRIDGE_CREDITS.
  */
 struct gb_interface {
 	gb_controller_write_callback_t write;
@@ -66,6 +78,32 @@ struct gb_interface {
 	gb_controller_destroy_connection_t destroy_connection;
 	void *ctrl_data;
 	uint8_t id;
+#ifdef CONFIG_GREYBUS_APBRIDGE_CREDITS
+	bool returns_credits;
+#endif
+#ifdef CONFIG_GREYBUS_APBRIDGE_TX_QUEUE
+	/* Private to APBridge, set up by gb_interface_add() */
+	struct gb_apbridge_txq *txq;
+#endif
+	/* Private to APBridge, writes in progress */
+	atomic_t refs;
+};
+
+/**
+ * Per interface TX queue statistics. Only maintained with CONFIG_GREYBUS_APBRIDGE_TX_QUEUE.
+ *
+ * @param queued: messages currently waiting
+ * @param max_queued: highest number of messages waiting at once
+ * @param sent: messages handed to the interface write callback
+ * @param dropped: messages dropped because the queue stayed full
+ * @param write_errors: messages the write callback failed
+ */
+struct gb_apbridge_tx_stats {
+	uint32_t queued;
+	uint32_t max_queued;
+	uint32_t sent;
+	uint32_t dropped;
+	uint32_t write_errors;
 };
 
 /**
@@ -84,7 +122,8 @@ void gb_apbridge_deinit(void);
 /**
  * Create connection between 2 interface cports.
  *
- * NOTE: It is only possible to create connection between AP-Node. Node-Node and AP-AP are not
+ * Connections are either between the AP and a node, or directly between two nodes without going
+ * through the AP. The create_connection hooks of both node interfaces are called. AP-AP is not
  * supported.
  *
  * @param intf1_id
@@ -115,19 +154,60 @@ int gb_apbridge_connection_destroy(uint8_t intf1_id, uint16_t intf1_cport, uint8
 /**
  * Send message between connected cports.
  *
- * Looks up the target connected inteface and sends the greybus message.
+ * Looks up the target connected inteface and sends the greybus message. Ownership of the message
+ * is transferred, it is freed if there is no connection.
  *
  * @param intf_id: Interface ID of the origin.
  * @param intf_cport: Interface CPort of the origin.
  * @param msg: Message to send
  *
+ * With CONFIG_GREYBUS_APBRIDGE_CREDITS, each message takes a credit of the connection. Once the
+ * window is used up, the sender waits for the receiver to return one. Senders in ISR don't wait.
+ *
  * @return 0 in case of success.
+ * @return -EAGAIN if no credit came back in time, or none was left for a sender in ISR.
  * @return < 0 in case of error.
  */
 int gb_apbridge_send(uint8_t intf_id, uint16_t intf_cport, struct gb_message *msg);
 
 /**
- * Get greybus interface by ID;
+ * Return a send credit to the other end of a connection.
+ *
+ * Called by controllers with returns_credits set once a message written to them has been
+ * consumed. Can be called from ISR.
+ *
+ * @param intf_id: Interface ID of the receiver.
+ * @param intf_cport: Interface CPort of the receiver.
+ *
+ * @return 0 in case of success.
+ * @return < 0 if there is no such connection.
+ */
+int gb_apbridge_credit_return(uint8_t intf_id, uint16_t intf_cport);
+
+/**
+ * Get the number of messages a cport can still send before running out of credits.
+ *
+ * @param intf_id: Interface ID of the origin.
+ * @param intf_cport: Interface CPort of the origin.
+ *
+ * @return number of credits.
+ * @return < 0 if there is no such connection.
+ */
+int gb_apbridge_credits(uint8_t intf_id, uint16_t intf_cport);
+
+/**
+ * Get TX queue statistics of an interface.
+ *
+ * @param intf_id: Interface ID
+ * @param stats: Filled with a snapshot of the statistics
+ *
+ * @return 0 in case of success.
+ * @return -ENOENT if the interface does not exist.
+ */
+int gb_apbridge_tx_stats(uint8_t intf_id, struct gb_apbridge_tx_stats *stats);
+
+/**
+ * Get greybus interface by ID. Never blocks, can be called from ISR.
  */
 struct gb_interface *gb_interface_get(uint8_t id);
 
@@ -170,6 +250,9 @@ int gb_interface_add(struct gb_interface *intf);
 /**
  * Remove greybus interface from cache
  *
+ * Returns once no message is being routed to the interface anymore, the caller can free it
+ * then. Must not be called from an interface write callback.
+ *
  * @param id: Greybus interface ID
  */
 void gb_interface_remove(uint8_t id);
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2026 BeagleBoard.org
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _INCLUDE_GREYBUS_GPIO_H_
+#define _INCLUDE_GREYBUS_GPIO_H_
+
+#include <stdint.h>
+
+struct gb_gpio_irq_stats {
+	/* IRQ events sent to the host */
+	uint32_t sent;
+	/* Edges merged into an event that was already pending */
+	uint32_t merged;
+	/* IRQ events the transport failed to send */
+	uint32_t dropped;
+	/* Edges swallowed by the software debounce while a line was settling */
+	uint32_t debounced;
+};
+
+/**
+ * Get the IRQ event statistics of a GPIO port.
+ *
+ * @param cport: Cport of the GPIO port
+ * @param stats: Filled with the statistics
+ *
+ * @return 0 on success, -ENOENT if the cport is not a GPIO port
+ */
+int gb_gpio_irq_stats(uint16_t cport, struct gb_gpio_irq_stats *stats);
+
+struct gb_gpio_capture_stats {
+	/* Edges recorded */
+	uint32_t captured;
+	/* Edges lost because the buffer was full */
+	uint32_t overruns;
+	/* Capture events sent to the host */
+	uint32_t sent;
+	/* Records lost because a capture event could not be allocated or sent */
+	uint32_t dropped;
+};
+
+/**
+ * Get the edge capture statistics of a GPIO port.
+ *
+ * @param cport: Cport of the GPIO port
+ * @param stats: Filled with the statistics
+ *
+ * @return 0 on success, -ENOENT if the cport is not a GPIO port, -ENOTSUP if edge capture is
+ * not enabled in the build
+ */
+int gb_gpio_capture_stats(uint16_t cport, struct gb_gpio_capture_stats *stats);
+
+/**
+ * Forget the cached configuration of a GPIO port. Call this when the lines may have changed
+ * without Greybus, e.g. after the GPIO expander was reset or reconfigured by the application.
+ *
+ * @param cport: Cport of the GPIO port
+ *
+ * @return 0 on success, -ENOENT if the cport is not a GPIO port, -ENOTSUP if the cache is not
+ * enabled in the build
+ */
+int gb_gpio_cache_invalidate(uint16_t cport);
+
+#endif // _INCLUDE_GREYBUS_GPIO_H_
@@ -32,6 +32,7 @@
 #define _GREYBUS_H_
 
 #include <greybus/greybus_messages.h>
+#include <zephyr/sys/util.h>
 
 /**
  * A struct to combine greybus message and cport
@@ -41,6 +42,24 @@ struct gb_msg_with_cport {
 	struct gb_message *msg;
 };
 
+/* Messages are handed to the link without an intermediate copy */
+#define GB_TRANSPORT_CAP_ZERO_COPY      BIT(0)
+/* A message can be gathered from several buffers on send */
+#define GB_TRANSPORT_CAP_SCATTER_GATHER BIT(1)
+
+/**
+ * Capabilities of a transport link. All sizes are of complete greybus messages, operation header
+ * included.
+ */
+struct gb_transport_caps {
+	/* Largest message the link can carry */
+	size_t max_message_size;
+	/* Largest message the link carries without splitting it up, for sizing bulk transfers */
+	size_t preferred_message_size;
+	/* GB_TRANSPORT_CAP_* flags */
+	uint32_t flags;
+};
+
 /**
  * Greybus transport backend structure.
  */
@@ -55,6 +74,12 @@ struct gb_transport_backend {
 	int (*stop_listening)(uint16_t cport);
 	/* Send greybus message */
 	int (*send)(uint16_t cport, const struct gb_message *msg);
+	/* Send greybus message, taking ownership of it whether or not sending succeeds. Optional,
+	 * for backends that can hand the buffer on instead of copying it. */
+	int (*send_owned)(uint16_t cport, struct gb_message *msg);
+	/* Query link capabilities. Optional, caps holds the defaults on entry. Can change at
+	 * runtime, e.g. when a link is renegotiated. */
+	void (*get_caps)(struct gb_transport_caps *caps);
 };
 
 /**
@@ -62,4 +87,43 @@ struct gb_transport_backend {
  */
 int greybus_rx_handler(uint16_t cport, struct gb_message *msg);
 
+/**
+ * Per backend transport statistics. Only maintained with CONFIG_GREYBUS_XPORT_MULTI.
+ */
+struct gb_transport_stats {
+	uint32_t rx_messages;
+	uint64_t rx_bytes;
+	uint32_t tx_messages;
+	uint64_t tx_bytes;
+	uint32_t tx_errors;
+	/* Messages sent over this backend because the routed one failed */
+	uint32_t failovers;
+	/* Whether the backend is currently considered usable */
+	bool up;
+};
+
+/**
+ * Get the number of registered transport backends.
+ */
+size_t gb_transport_backend_count(void);
+
+/**
+ * Get the name of a registered transport backend.
+ *
+ * @param idx backend index, 0 being the active backend
+ *
+ * @return backend name, or NULL if idx is out of range
+ */
+const char *gb_transport_backend_name(size_t idx);
+
+/**
+ * Get a snapshot of the statistics of a registered transport backend.
+ *
+ * @param idx backend index, 0 being the active backend
+ * @param stats filled with the statistics
+ *
+ * @return 0 on success, -EINVAL if idx is out of range
+ */
+int gb_transport_backend_stats(size_t idx, struct gb_transport_stats *stats);
+
 #endif /* _GREYBUS_H_ */
@@ -161,6 +161,27 @@ struct gb_control_intf_pm_response {
 	__u8 status;
 } __packed;
 
+/* Control protocol TimeSync */
+#define GB_TIMESYNC_MAX_STROBES 0x04
+
+struct gb_control_timesync_enable_request {
+	__u8 count;
+	__le64 frame_time;
+	__le32 strobe_delay;
+	__le32 refclk;
+} __packed;
+/* timesync enable response has no payload */
+
+struct gb_control_timesync_authoritative_request {
+	__le64 frame_time[GB_TIMESYNC_MAX_STROBES];
+} __packed;
+/* timesync authoritative response has no payload */
+
+/* timesync get_last_event_request has no payload */
+struct gb_control_timesync_get_last_event_response {
+	__le64 frame_time;
+} __packed;
+
 /* APBridge protocol */
 
 /* request APB1 log */
@@ -713,6 +734,16 @@ struct gb_i2c_transfer_response {
 #define GB_GPIO_TYPE_IRQ_UNMASK    0x0d
 #define GB_GPIO_TYPE_IRQ_EVENT     0x0e
 
+/* Port wide operations, vendor extension */
+#define GB_GPIO_TYPE_PORT_GET       0x70
+#define GB_GPIO_TYPE_PORT_SET       0x71
+#define GB_GPIO_TYPE_PORT_DIRECTION 0x72
+
+/* Edge capture, vendor extension */
+#define GB_GPIO_TYPE_CAPTURE_ENABLE  0x73
+#define GB_GPIO_TYPE_CAPTURE_DISABLE 0x74
+#define GB_GPIO_TYPE_CAPTURE_EVENT   0x75
+
 #define GB_GPIO_IRQ_TYPE_NONE         0x00
 #define GB_GPIO_IRQ_TYPE_EDGE_RISING  0x01
 #define GB_GPIO_IRQ_TYPE_EDGE_FALLING 0x02
@@ -794,6 +825,64 @@ struct gb_gpio_irq_event_request {
 } __packed;
 /* irq event has no response */
 
+/*
+ * Port wide operations work on raw pin levels, bit n of a mask or value is line n. Lines outside
+ * of the port are invalid.
+ */
+
+/* port get request has no payload */
+struct gb_gpio_port_get_response {
+	__le32 value;
+} __packed;
+
+/* Only lines set in mask are changed */
+struct gb_gpio_port_set_request {
+	__le32 mask;
+	__le32 value;
+} __packed;
+/* port set response has no payload */
+
+/* Lines set in mask become outputs if set in output, driven to value, inputs otherwise */
+struct gb_gpio_port_direction_request {
+	__le32 mask;
+	__le32 output;
+	__le32 value;
+} __packed;
+/* port direction response has no payload */
+
+/*
+ * Edge capture records every edge of the lines in mask with a timestamp of the module cycle
+ * counter. Records are sent in capture events once count records are buffered, or latency_us
+ * after the oldest record was taken. Zero selects the module default for either.
+ */
+struct gb_gpio_capture_enable_request {
+	__le32 mask;
+	__le32 latency_us;
+	__le16 count;
+} __packed;
+
+/* Frequency of the timestamp counter */
+struct gb_gpio_capture_enable_response {
+	__le32 clock_hz;
+} __packed;
+
+/* capture disable request has no payload, buffered records are sent before the response */
+/* capture disable response has no payload */
+
+struct gb_gpio_capture_record {
+	__le64 timestamp;
+	__u8 which;
+	__u8 value; /* level after the edge */
+} __packed;
+
+/* capture event requests originate on another module and are handled on the AP */
+struct gb_gpio_capture_event_request {
+	__le32 overruns; /* records lost since the previous event, buffer was full */
+	__le16 count;
+	struct gb_gpio_capture_record records[];
+} __packed;
+/* capture event has no response */
+
 /* PWM */
 
 /* Greybus PWM operation types */
@@ -1228,6 +1317,28 @@ struct gb_svc_pwrmon_intf_sample_get_response {
 	__le32 measurement;
 } __packed;
 
+struct gb_svc_timesync_enable_request {
+	__u8 count;
+	__le64 frame_time;
+	__le32 strobe_delay;
+	__le32 refclk;
+} __packed;
+/* timesync enable response has no payload */
+
+/* timesync authoritative request has no payload */
+struct gb_svc_timesync_authoritative_response {
+	__le64 frame_time[GB_TIMESYNC_MAX_STROBES];
+} __packed;
+
+struct gb_svc_timesync_wake_pins_acquire_request {
+	__le32 strobe_mask;
+} __packed;
+
+/* timesync ping request has no payload */
+struct gb_svc_timesync_ping_response {
+	__le64 frame_time;
+} __packed;
+
 #define GB_SVC_MODULE_INSERTED_FLAG_NO_PRIMARY 0x0001
 
 struct gb_svc_module_inserted_request {
@@ -2206,4 +2317,22 @@ struct gb_log_send_log_request {
 #define GB_VIBRATOR_TYPE_ON  0x02
 #define GB_VIBRATOR_TYPE_OFF 0x03
 
+/* Message aggregation */
+
+/* Envelopes travel on a cport id that can never be assigned */
+#define GB_AGGREGATE_CPORT 0xffff
+
+/* operations */
+#define GB_AGGREGATE_TYPE_ENVELOPE 0x01
+
+/*
+ * The envelope payload is a sequence of entries packed back to back, each entry holding one
+ * complete greybus message.
+ */
+struct gb_aggregate_entry {
+	__le16 cport;
+	struct gb_operation_msg_hdr hdr;
+	__u8 payload[];
+} __packed;
+
 #endif /* __GREYBUS_PROTOCOLS_H */
@@ -39,8 +39,17 @@ int greybus_raw_register(greybus_raw_cb_t cb, void *priv);
  * @param data
  *
  * @returns 0 in case of success.
+ * @returns -EMSGSIZE if len is larger than greybus_raw_max_send_len().
  * @returns < 0 in case of error.
  */
 int greybus_raw_send_data(uint16_t id, uint32_t len, const uint8_t *data);
 
+/**
+ * Get the largest amount of data that can be sent to AP at once. Depends on the transport link
+ * and can change at runtime, e.g. when a link is renegotiated.
+ *
+ * @returns max len accepted by greybus_raw_send_data.
+ */
+uint32_t greybus_raw_max_send_len(void);
+
 #endif // _GREYBUS_RAW_H_
@@ -10,7 +10,32 @@
 #include <stdint.h>
 
 /**
- * Intialize SVC
+ * Called once SVC initialization is done, from the SVC work queue.
+ *
+ * @param status: 0 once the AP answered the SVC hello, negative in case of error
+ * @param user_data: as passed to gb_svc_init_async()
+ */
+typedef void (*gb_svc_init_cb_t)(int status, void *user_data);
+
+/**
+ * Intialize SVC without waiting for the AP.
+ *
+ * Starts the SVC work queue, which handles all messages sent to the SVC, and the version and
+ * hello exchange with the AP.
+ *
+ * @param cb: Completion callback
+ * @param user_data: Passed to the callback
+ *
+ * @return 0 if the exchange was started, negative in case of error. The callback is not called
+ * then.
+ */
+int gb_svc_init_async(gb_svc_init_cb_t cb, void *user_data);
+
+/**
+ * Intialize SVC and wait for the exchange with the AP. Must not be called from the SVC work
+ * queue.
+ *
+ * @return 0 if successfully, negative in case of error
  */
 int gb_svc_init(void);
 
@@ -19,6 +44,12 @@ int gb_svc_init(void);
  */
 void gb_svc_deinit(void);
 
+/**
+ * Get the number of operations dropped because the SVC queue stayed full, see
+ * CONFIG_GREYBUS_SVC_QUEUE_TIMEOUT_MS.
+ */
+uint32_t gb_svc_dropped(void);
+
 /**
  * Send the SVC module inserted request.
  *
@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2026 BeagleBoard.org
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _GREYBUS_TIMESYNC_H_
+#define _GREYBUS_TIMESYNC_H_
+
+#include <stdint.h>
+
+/**
+ * Get the current frame time, the timebase shared with the AP once TimeSync completed.
+ *
+ * Callable from ISR.
+ *
+ * @return frame time in ticks of the TimeSync reference clock
+ */
+uint64_t gb_timesync_get_frame_time(void);
+
+/**
+ * Signal a TimeSync strobe. Boards call this from the wake pin interrupt, the SVC strobes
+ * itself. Latches the frame time of the strobe as last event.
+ *
+ * Callable from ISR.
+ */
+void gb_timesync_strobe(void);
+
+/**
+ * Get the frame time of the last strobe.
+ *
+ * @param frame_time: Frame time of the strobe
+ *
+ * @return 0 on success, -ENODATA if there was no strobe since TimeSync was enabled
+ */
+int gb_timesync_get_last_event(uint64_t *frame_time);
+
+#endif // _GREYBUS_TIMESYNC_H_
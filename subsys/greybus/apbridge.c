@@ -1,58 +1,529 @@
 #include <greybus/apbridge.h>
+#include <string.h>
+#include <zephyr/kernel.h>
 #include <zephyr/sys/errno_private.h>
+#include <zephyr/sys/util.h>
 #include <zephyr/logging/log.h>
+#include "greybus_heap.h"
+#include "greybus_internal.h"
 
 LOG_MODULE_REGISTER(greybus_apbridge, CONFIG_GREYBUS_LOG_LEVEL);
 
-struct node_ap_item {
-	struct gb_interface *node_intf;
+/* Smallest non-empty connection table */
+#define CONN_MIN_CAPACITY 4
+
+enum conn_index_type {
+	CONN_INDEX_PEER,
+#ifndef CONFIG_GREYBUS_APBRIDGE_LINEAR_LOOKUP
+	CONN_INDEX_NODE,
+#endif
+	CONN_INDEX_COUNT,
+};
+
+#ifdef CONFIG_GREYBUS_APBRIDGE_CREDITS
+enum credit_direction {
+	CREDIT_TO_NODE,
+	CREDIT_TO_PEER,
+	CREDIT_DIRECTION_COUNT,
+};
+
+/*
+ * Send credits of a connection, one semaphore per direction counting the messages the sender may
+ * still have in flight. Allocated separately from the connection table so blocked senders keep a
+ * stable pointer across table resizes. The table holds one reference, each blocked sender one
+ * more, the last one frees it. References are counted under conns_lock, and are as wide as a
+ * count of threads needs to be.
+ */
+struct gb_apbridge_credits {
+	struct k_sem sem[CREDIT_DIRECTION_COUNT];
+	uint32_t refs;
+	bool closed;
+};
+#endif
+
+/*
+ * A connection between a node cport and a peer cport. The peer is the AP, or another node for
+ * direct node to node connections.
+ */
+struct conn_item {
+#ifdef CONFIG_GREYBUS_APBRIDGE_CREDITS
+	struct gb_apbridge_credits *credits;
+#endif
 	uint16_t node_cport;
+	uint16_t peer_cport;
+	uint8_t node_id;
+	uint8_t peer_id;
 };
 
-static struct node_ap_item node_ap_map[AP_MAX_NODES] = {0};
+/*
+ * Active connections, packed at the start of items. The table is allocated from the greybus heap
+ * and grows and shrinks by powers of two, so memory follows the number of connections rather
+ * than the cport id space.
+ *
+ * Each index is an open addressing hash table with linear probing, at most half full. Slots hold
+ * the item position + 1, keys are read back from the items.
+ */
+struct conn_table {
+	struct conn_item *items;
+	uint16_t *index[CONN_INDEX_COUNT];
+	size_t count;
+	size_t capacity;
+	uint8_t index_bits;
+};
+
+static struct conn_table conns;
+/* Serializes connection changes */
+static K_MUTEX_DEFINE(conns_mutex);
+/* Protects conns against lookups from other contexts */
+static struct k_spinlock conns_lock;
 
-static int node_ap_add(uint16_t ap_cport, uint16_t node_cport, struct gb_interface *node_intf)
+static uint32_t end_key(uint8_t intf_id, uint16_t intf_cport)
 {
-	if (ap_cport >= ARRAY_SIZE(node_ap_map)) {
-		return -EOVERFLOW;
+	return ((uint32_t)intf_id << 16) | intf_cport;
+}
+
+static uint32_t item_key(const struct conn_item *item, enum conn_index_type type)
+{
+	if (type == CONN_INDEX_PEER) {
+		return end_key(item->peer_id, item->peer_cport);
 	}
 
-	if (node_ap_map[ap_cport].node_intf) {
-		return -EALREADY;
+	return end_key(item->node_id, item->node_cport);
+}
+
+static size_t key_hash(const struct conn_table *table, uint32_t key)
+{
+	/* Fibonacci hashing, the top bits are the well mixed ones */
+	return (uint32_t)(key * 0x9e3779b1U) >> (32 - table->index_bits);
+}
+
+static size_t index_next(const struct conn_table *table, size_t slot)
+{
+	return (slot + 1) & (BIT(table->index_bits) - 1);
+}
+
+static int index_find(const struct conn_table *table, enum conn_index_type type, uint32_t key)
+{
+	const uint16_t *index = table->index[type];
+	size_t i;
+
+	if (!table->capacity) {
+		return -EINVAL;
 	}
 
-	node_ap_map[ap_cport].node_cport = node_cport;
-	node_ap_map[ap_cport].node_intf = node_intf;
+	for (i = key_hash(table, key); index[i]; i = index_next(table, i)) {
+		if (item_key(&table->items[index[i] - 1], type) == key) {
+			return index[i] - 1;
+		}
+	}
 
-	return 0;
+	return -EINVAL;
 }
 
-static int node_ap_remove(uint16_t ap_cport)
+/* Slot holding the item at pos */
+static size_t index_slot(const struct conn_table *table, enum conn_index_type type, size_t pos)
 {
-	if (ap_cport >= ARRAY_SIZE(node_ap_map)) {
-		return -EOVERFLOW;
+	const uint16_t *index = table->index[type];
+	size_t i = key_hash(table, item_key(&table->items[pos], type));
+
+	while (index[i] != pos + 1) {
+		i = index_next(table, i);
+	}
+
+	return i;
+}
+
+static void index_insert(struct conn_table *table, enum conn_index_type type, size_t pos)
+{
+	uint16_t *index = table->index[type];
+	size_t i = key_hash(table, item_key(&table->items[pos], type));
+
+	/* Never full, there are twice as many slots as items */
+	while (index[i]) {
+		i = index_next(table, i);
+	}
+
+	index[i] = pos + 1;
+}
+
+/*
+ * Remove by shifting back the entries that follow in the same probe sequence, so lookups never
+ * have to skip over deleted slots.
+ */
+static void index_remove(struct conn_table *table, enum conn_index_type type, size_t pos)
+{
+	const size_t mask = BIT(table->index_bits) - 1;
+	uint16_t *index = table->index[type];
+	size_t i = index_slot(table, type, pos);
+	size_t j, home;
+
+	for (j = index_next(table, i); index[j]; j = index_next(table, j)) {
+		home = key_hash(table, item_key(&table->items[index[j] - 1], type));
+
+		/* Entry stays if its home slot lies cyclically in (i, j] */
+		if (((j - home) & mask) < ((j - i) & mask)) {
+			continue;
+		}
+
+		index[i] = index[j];
+		i = j;
 	}
 
-	node_ap_map[ap_cport].node_cport = 0;
-	node_ap_map[ap_cport].node_intf = NULL;
+	index[i] = 0;
+}
+
+/*
+ * Move the table to a new allocation of the given capacity, 0 frees it. Must be called with
+ * conns_mutex held, lookups only block for the pointer swap.
+ */
+static int conn_table_resize(size_t capacity)
+{
+	struct conn_table table = {0};
+	struct conn_table old;
+	k_spinlock_key_t key;
+	size_t index_size;
+	uint8_t *mem;
+
+	if (capacity > 0) {
+		table.capacity = capacity;
+		table.index_bits = LOG2CEIL(2 * capacity);
+		index_size = BIT(table.index_bits) * sizeof(uint16_t);
+
+		mem = gb_alloc(capacity * sizeof(*table.items) + CONN_INDEX_COUNT * index_size);
+		if (!mem) {
+			return -ENOMEM;
+		}
+
+		table.items = (struct conn_item *)mem;
+		for (size_t i = 0; i < CONN_INDEX_COUNT; i++) {
+			table.index[i] = (uint16_t *)(mem + capacity * sizeof(*table.items) +
+						      i * index_size);
+			memset(table.index[i], 0, index_size);
+		}
+
+		/* Only this thread modifies conns, reading it unlocked is fine */
+		table.count = conns.count;
+		if (conns.count > 0) {
+			memcpy(table.items, conns.items, conns.count * sizeof(*table.items));
+		}
+		for (size_t pos = 0; pos < table.count; pos++) {
+			for (size_t i = 0; i < CONN_INDEX_COUNT; i++) {
+				index_insert(&table, i, pos);
+			}
+		}
+	}
+
+	key = k_spin_lock(&conns_lock);
+	old = conns;
+	conns = table;
+	k_spin_unlock(&conns_lock, key);
+
+	if (old.items) {
+		gb_free(old.items);
+	}
 
 	return 0;
 }
 
-static int node_to_ap_cport(uint8_t node_id, uint16_t node_cport)
+static int node_find(uint8_t node_id, uint16_t node_cport)
 {
-	const struct node_ap_item *item;
+#ifndef CONFIG_GREYBUS_APBRIDGE_LINEAR_LOOKUP
+	return index_find(&conns, CONN_INDEX_NODE, end_key(node_id, node_cport));
+#else
+	/*
+	 * Linear scan over all connections. Slower than the index for anything but a handful of
+	 * connections, kept to compare against it.
+	 */
+	const struct conn_item *item;
 
-	for (size_t i = 0; i < ARRAY_SIZE(node_ap_map); i++) {
-		item = &node_ap_map[i];
+	for (size_t i = 0; i < conns.count; i++) {
+		item = &conns.items[i];
 
-		if (item->node_intf && item->node_intf->id == node_id &&
-		    item->node_cport == node_cport) {
+		if (item->node_id == node_id && item->node_cport == node_cport) {
 			return i;
 		}
 	}
 
 	return -EINVAL;
+#endif
+}
+
+/*
+ * Connection of a cport seen from either of its ends. node_end tells which end the cport is.
+ * Must be called with conns_lock held.
+ */
+static int conn_find(uint8_t intf_id, uint16_t intf_cport, bool *node_end)
+{
+	int ret = index_find(&conns, CONN_INDEX_PEER, end_key(intf_id, intf_cport));
+
+	*node_end = false;
+
+	/* The AP is never the node end */
+	if (ret >= 0 || intf_id == AP_INF_ID) {
+		return ret;
+	}
+
+	*node_end = true;
+
+	return node_find(intf_id, intf_cport);
+}
+
+#ifdef CONFIG_GREYBUS_APBRIDGE_CREDITS
+static struct gb_apbridge_credits *credits_alloc(uint8_t peer_id)
+{
+	const uint8_t to_peer = (peer_id == AP_INF_ID) ? CONFIG_GREYBUS_APBRIDGE_CREDITS_TO_AP
+						       : CONFIG_GREYBUS_APBRIDGE_CREDITS_TO_NODE;
+	struct gb_apbridge_credits *credits = gb_alloc(sizeof(*credits));
+
+	if (!credits) {
+		return NULL;
+	}
+
+	k_sem_init(&credits->sem[CREDIT_TO_NODE], CONFIG_GREYBUS_APBRIDGE_CREDITS_TO_NODE,
+		   CONFIG_GREYBUS_APBRIDGE_CREDITS_TO_NODE);
+	k_sem_init(&credits->sem[CREDIT_TO_PEER], to_peer, to_peer);
+	credits->refs = 1;
+	credits->closed = false;
+
+	return credits;
+}
+
+/* Drop the reference of the connection table, waking up senders blocked on the credits */
+static void credits_close(struct gb_apbridge_credits *credits)
+{
+	k_spinlock_key_t key;
+	bool release;
+
+	key = k_spin_lock(&conns_lock);
+	credits->closed = true;
+	k_spin_unlock(&conns_lock, key);
+
+	for (size_t i = 0; i < CREDIT_DIRECTION_COUNT; i++) {
+		k_sem_reset(&credits->sem[i]);
+	}
+
+	key = k_spin_lock(&conns_lock);
+	release = --credits->refs == 0;
+	k_spin_unlock(&conns_lock, key);
+
+	if (release) {
+		gb_free(credits);
+	}
+}
+
+/*
+ * Take a send credit for a message from the origin cport, waiting for the receiver to return one
+ * if the window is exhausted.
+ */
+static int credit_take(uint8_t intf_id, uint16_t intf_cport)
+{
+	const k_timeout_t timeout = k_is_in_isr() ? K_NO_WAIT
+						  : K_MSEC(CONFIG_GREYBUS_APBRIDGE_CREDITS_TIMEOUT_MS);
+	struct gb_apbridge_credits *credits;
+	enum credit_direction dir;
+	k_spinlock_key_t key;
+	bool node_end, release;
+	int ret;
+
+	key = k_spin_lock(&conns_lock);
+	ret = conn_find(intf_id, intf_cport, &node_end);
+	if (ret < 0) {
+		k_spin_unlock(&conns_lock, key);
+		return ret;
+	}
+
+	credits = conns.items[ret].credits;
+	dir = node_end ? CREDIT_TO_PEER : CREDIT_TO_NODE;
+	if (k_sem_take(&credits->sem[dir], K_NO_WAIT) == 0) {
+		k_spin_unlock(&conns_lock, key);
+		return 0;
+	}
+
+	credits->refs++;
+	k_spin_unlock(&conns_lock, key);
+
+	ret = k_sem_take(&credits->sem[dir], timeout);
+	if (ret == -EBUSY) {
+		/* Not allowed to wait, e.g. in ISR */
+		ret = -EAGAIN;
+	}
+
+	key = k_spin_lock(&conns_lock);
+	if (credits->closed) {
+		ret = -ENOTCONN;
+	}
+	release = --credits->refs == 0;
+	k_spin_unlock(&conns_lock, key);
+
+	if (release) {
+		gb_free(credits);
+	}
+
+	return ret;
+}
+
+int gb_apbridge_credit_return(uint8_t intf_id, uint16_t intf_cport)
+{
+	k_spinlock_key_t key;
+	bool node_end;
+	int ret;
+
+	key = k_spin_lock(&conns_lock);
+	ret = conn_find(intf_id, intf_cport, &node_end);
+	if (ret >= 0) {
+		/* Saturates at the window size */
+		k_sem_give(&conns.items[ret]
+				    .credits->sem[node_end ? CREDIT_TO_NODE : CREDIT_TO_PEER]);
+	}
+	k_spin_unlock(&conns_lock, key);
+
+	return MIN(ret, 0);
+}
+
+int gb_apbridge_credits(uint8_t intf_id, uint16_t intf_cport)
+{
+	k_spinlock_key_t key;
+	bool node_end;
+	int ret;
+
+	key = k_spin_lock(&conns_lock);
+	ret = conn_find(intf_id, intf_cport, &node_end);
+	if (ret >= 0) {
+		ret = k_sem_count_get(
+			&conns.items[ret].credits->sem[node_end ? CREDIT_TO_PEER : CREDIT_TO_NODE]);
+	}
+	k_spin_unlock(&conns_lock, key);
+
+	return ret;
+}
+
+void gb_apbridge_write_done(struct gb_interface *intf, uint16_t cport, int ret)
+{
+	/* A failed write never reaches the controller, so it cannot return the credit */
+	if (ret < 0 || !intf->returns_credits) {
+		gb_apbridge_credit_return(intf->id, cport);
+	}
+}
+#endif
+
+static int conn_add(struct gb_interface *node_intf, uint16_t node_cport, uint8_t peer_id,
+		    uint16_t peer_cport)
+{
+	const struct conn_item item = {
+		.node_cport = node_cport,
+		.peer_cport = peer_cport,
+		.node_id = node_intf->id,
+		.peer_id = peer_id,
+	};
+#ifdef CONFIG_GREYBUS_APBRIDGE_CREDITS
+	struct gb_apbridge_credits *credits;
+#endif
+	k_spinlock_key_t key;
+	bool node_end;
+	int ret = 0;
+
+	if (peer_id == AP_INF_ID && peer_cport > GB_APBRIDGE_CPORT_ID_MAX) {
+		return -EOVERFLOW;
+	}
+
+	k_mutex_lock(&conns_mutex, K_FOREVER);
+
+	if (conn_find(item.node_id, node_cport, &node_end) >= 0 ||
+	    conn_find(peer_id, peer_cport, &node_end) >= 0) {
+		ret = -EALREADY;
+		goto unlock;
+	}
+
+	if (conns.count == AP_MAX_NODES) {
+		ret = -ENOMEM;
+		goto unlock;
+	}
+
+	if (conns.count == conns.capacity) {
+		ret = conn_table_resize(CLAMP(2 * conns.capacity, CONN_MIN_CAPACITY, AP_MAX_NODES));
+		if (ret < 0) {
+			goto unlock;
+		}
+	}
+
+#ifdef CONFIG_GREYBUS_APBRIDGE_CREDITS
+	credits = credits_alloc(peer_id);
+	if (!credits) {
+		ret = -ENOMEM;
+		goto unlock;
+	}
+#endif
+
+	key = k_spin_lock(&conns_lock);
+	conns.items[conns.count] = item;
+#ifdef CONFIG_GREYBUS_APBRIDGE_CREDITS
+	conns.items[conns.count].credits = credits;
+#endif
+	for (size_t i = 0; i < CONN_INDEX_COUNT; i++) {
+		index_insert(&conns, i, conns.count);
+	}
+	conns.count++;
+	k_spin_unlock(&conns_lock, key);
+
+unlock:
+	k_mutex_unlock(&conns_mutex);
+
+	return ret;
+}
+
+static int conn_remove(uint8_t intf_id, uint16_t intf_cport)
+{
+#ifdef CONFIG_GREYBUS_APBRIDGE_CREDITS
+	struct gb_apbridge_credits *credits;
+#endif
+	k_spinlock_key_t key;
+	size_t pos, last;
+	bool node_end;
+	int ret;
+
+	k_mutex_lock(&conns_mutex, K_FOREVER);
+
+	ret = conn_find(intf_id, intf_cport, &node_end);
+	if (ret < 0) {
+		k_mutex_unlock(&conns_mutex);
+		return ret;
+	}
+
+	pos = ret;
+
+	key = k_spin_lock(&conns_lock);
+#ifdef CONFIG_GREYBUS_APBRIDGE_CREDITS
+	credits = conns.items[pos].credits;
+#endif
+	for (size_t i = 0; i < CONN_INDEX_COUNT; i++) {
+		index_remove(&conns, i, pos);
+	}
+
+	/* Keep the items packed by moving the last one into the hole */
+	last = conns.count - 1;
+	if (pos != last) {
+		for (size_t i = 0; i < CONN_INDEX_COUNT; i++) {
+			conns.index[i][index_slot(&conns, i, last)] = pos + 1;
+		}
+		conns.items[pos] = conns.items[last];
+	}
+	conns.count--;
+	k_spin_unlock(&conns_lock, key);
+
+#ifdef CONFIG_GREYBUS_APBRIDGE_CREDITS
+	credits_close(credits);
+#endif
+
+	if (conns.count == 0) {
+		conn_table_resize(0);
+	} else if (conns.capacity > CONN_MIN_CAPACITY && conns.count <= conns.capacity / 4) {
+		/* Shrinking is best effort */
+		conn_table_resize(conns.capacity / 2);
+	}
+
+	k_mutex_unlock(&conns_mutex);
+
+	return 0;
 }
 
 int gb_apbridge_init(void)
@@ -62,51 +533,92 @@ int gb_apbridge_init(void)
 
 void gb_apbridge_deinit(void)
 {
-	for (size_t i = 0; i < ARRAY_SIZE(node_ap_map); ++i) {
-		node_ap_map[i].node_cport = 0;
-		node_ap_map[i].node_intf = NULL;
+	k_mutex_lock(&conns_mutex, K_FOREVER);
+#ifdef CONFIG_GREYBUS_APBRIDGE_CREDITS
+	for (size_t i = 0; i < conns.count; i++) {
+		credits_close(conns.items[i].credits);
+	}
+#endif
+	conn_table_resize(0);
+	k_mutex_unlock(&conns_mutex);
+}
+
+/* create_connection is optional */
+static int intf_connect(struct gb_interface *intf, uint16_t cport)
+{
+	return intf->create_connection ? intf->create_connection(intf, cport) : 0;
+}
+
+/* Ignore if intf has already been cleaned up, or if destroy_connection is not defined */
+static void intf_disconnect(struct gb_interface *intf, uint16_t cport)
+{
+	if (intf && intf->destroy_connection) {
+		intf->destroy_connection(intf, cport);
 	}
 }
 
 int gb_apbridge_connection_create(uint8_t intf1_id, uint16_t intf1_cport, uint8_t intf2_id,
 				  uint16_t intf2_cport)
 {
-	struct gb_interface *intf;
-	uint8_t node_id;
-	uint16_t ap_cport, node_cport;
+	struct gb_interface *node_intf, *peer_intf = NULL;
+	uint8_t node_id, peer_id;
+	uint16_t node_cport, peer_cport;
 	int ret;
 
+	if (intf1_id == AP_INF_ID && intf2_id == AP_INF_ID) {
+		LOG_ERR("Cannot create connection between two AP cports");
+		return -EINVAL;
+	}
+
+	/* The AP is always the peer end */
 	if (intf1_id == AP_INF_ID) {
 		node_id = intf2_id;
 		node_cport = intf2_cport;
-		ap_cport = intf1_cport;
-	} else if (intf2_id == AP_INF_ID) {
+		peer_id = intf1_id;
+		peer_cport = intf1_cport;
+	} else {
 		node_id = intf1_id;
 		node_cport = intf1_cport;
-		ap_cport = intf2_cport;
-	} else {
-		LOG_ERR("Cannot create connection between two non-AP");
-		return -EINVAL;
+		peer_id = intf2_id;
+		peer_cport = intf2_cport;
 	}
 
-	intf = gb_interface_get(node_id);
-	if (!intf) {
+	node_intf = gb_interface_get(node_id);
+	if (!node_intf) {
 		LOG_ERR("Failed to find node interface");
 		return -EINVAL;
 	}
 
-	/* create_connection is optional */
-	if (intf->create_connection) {
-		ret = intf->create_connection(intf, node_cport);
+	if (peer_id != AP_INF_ID) {
+		peer_intf = gb_interface_get(peer_id);
+		if (!peer_intf) {
+			LOG_ERR("Failed to find peer interface");
+			return -EINVAL;
+		}
+	}
+
+	ret = intf_connect(node_intf, node_cport);
+	if (ret < 0) {
+		LOG_ERR("Failed to create node connection");
+		return ret;
+	}
+
+	if (peer_intf) {
+		ret = intf_connect(peer_intf, peer_cport);
 		if (ret < 0) {
-			LOG_ERR("Failed to create node connection");
+			LOG_ERR("Failed to create peer connection");
+			intf_disconnect(node_intf, node_cport);
 			return ret;
 		}
 	}
 
-	ret = node_ap_add(ap_cport, node_cport, intf);
+	ret = conn_add(node_intf, node_cport, peer_id, peer_cport);
 	if (ret < 0) {
-		LOG_ERR("Failed to add AP to node");
+		LOG_ERR("Failed to add connection");
+		intf_disconnect(node_intf, node_cport);
+		if (peer_intf) {
+			intf_disconnect(peer_intf, peer_cport);
+		}
 		return ret;
 	}
 
@@ -116,53 +628,128 @@ int gb_apbridge_connection_create(uint8_t intf1_id, uint16_t intf1_cport, uint8_
 int gb_apbridge_connection_destroy(uint8_t intf1_id, uint16_t intf1_cport, uint8_t intf2_id,
 				   uint16_t intf2_cport)
 {
-	uint8_t node_id;
-	struct gb_interface *intf;
-	uint16_t ap_cport, node_cport;
-
-	if (intf1_id == AP_INF_ID) {
-		node_id = intf2_id;
-		node_cport = intf2_cport;
-		ap_cport = intf1_cport;
-	} else if (intf2_id == AP_INF_ID) {
-		node_id = intf1_id;
-		node_cport = intf1_cport;
-		ap_cport = intf2_cport;
-	} else {
-		LOG_ERR("Cannot destroy connection between two non-AP");
+	if (intf1_id == AP_INF_ID && intf2_id == AP_INF_ID) {
+		LOG_ERR("Cannot destroy connection between two AP cports");
 		return -EINVAL;
 	}
 
-	intf = gb_interface_get(node_id);
-	/* Ignore if intf has already been cleaned up, or if destroy_connection is not defined */
-	if (intf && intf->destroy_connection) {
-		intf->destroy_connection(intf, node_cport);
+	/* The AP has no connection hooks */
+	if (intf1_id != AP_INF_ID) {
+		intf_disconnect(gb_interface_get(intf1_id), intf1_cport);
+	}
+	if (intf2_id != AP_INF_ID) {
+		intf_disconnect(gb_interface_get(intf2_id), intf2_cport);
 	}
 
-	node_ap_remove(ap_cport);
+	conn_remove(intf1_id, intf1_cport);
 
 	return 0;
 }
 
-int gb_apbridge_send(uint8_t intf_id, uint16_t intf_cport, struct gb_message *msg)
+/*
+ * Find the interface and cport a message goes to and take a reference on the interface. Must be
+ * called in an interface read section.
+ */
+static int route_get(uint8_t intf_id, uint16_t intf_cport, struct gb_interface **target,
+		     uint16_t *target_cport_out)
 {
 	struct gb_interface *intf;
-	uint16_t target_cport;
+	const struct conn_item *item;
+	uint8_t target_id = 0;
+	uint16_t target_cport = 0;
+	k_spinlock_key_t key;
+	bool node_end;
 	int ret;
 
-	if (intf_id == AP_INF_ID) {
-		intf = node_ap_map[intf_cport].node_intf;
-		target_cport = node_ap_map[intf_cport].node_cport;
-	} else {
-		ret = node_to_ap_cport(intf_id, intf_cport);
-		if (ret < 0) {
-			LOG_ERR("Failed to find AP cport");
-			return ret;
+	key = k_spin_lock(&conns_lock);
+	ret = conn_find(intf_id, intf_cport, &node_end);
+	if (ret >= 0) {
+		item = &conns.items[ret];
+		if (node_end) {
+			target_id = item->peer_id;
+			target_cport = item->peer_cport;
+		} else {
+			target_id = item->node_id;
+			target_cport = item->node_cport;
 		}
+	}
+	k_spin_unlock(&conns_lock, key);
 
-		intf = gb_interface_get(AP_INF_ID);
-		target_cport = ret;
+	if (ret < 0) {
+		LOG_ERR("No connection for interface %u cport %u", intf_id, intf_cport);
+		return ret;
+	}
+
+	/* Only an interface still published is safe to use, the read section keeps it alive */
+	intf = gb_interface_get(target_id);
+	if (!intf) {
+#ifdef CONFIG_GREYBUS_APBRIDGE_CREDITS
+		gb_apbridge_credit_return(target_id, target_cport);
+#endif
+		return -ENODEV;
+	}
+
+	gb_interface_ref(intf);
+	*target = intf;
+	*target_cport_out = target_cport;
+
+	return 0;
+}
+
+static int route(uint8_t intf_id, uint16_t intf_cport, struct gb_message *msg)
+{
+	struct gb_interface *intf;
+	uint16_t target_cport;
+	int ret, key;
+
+	/*
+	 * The reference keeps the target interface from being removed while the message is
+	 * handed to it, the read section only covers the lookup since writes can block.
+	 */
+	key = gb_interface_read_lock();
+	ret = route_get(intf_id, intf_cport, &intf, &target_cport);
+	gb_interface_read_unlock(key);
+
+	if (ret < 0) {
+		gb_message_dealloc(msg);
+		return ret;
+	}
+
+#ifdef CONFIG_GREYBUS_APBRIDGE_TX_QUEUE
+	ret = gb_apbridge_txq_write(intf, msg, target_cport);
+#ifdef CONFIG_GREYBUS_APBRIDGE_CREDITS
+	/* Queued messages return their credit once the worker wrote them */
+	if (ret < 0) {
+		gb_apbridge_write_done(intf, target_cport, ret);
+	}
+#endif
+#else
+	ret = intf->write(intf, msg, target_cport);
+#ifdef CONFIG_GREYBUS_APBRIDGE_CREDITS
+	gb_apbridge_write_done(intf, target_cport, ret);
+#endif
+#endif
+
+	gb_interface_unref(intf);
+
+	return ret;
+}
+
+int gb_apbridge_send(uint8_t intf_id, uint16_t intf_cport, struct gb_message *msg)
+{
+#ifdef CONFIG_GREYBUS_APBRIDGE_CREDITS
+	const int ret = credit_take(intf_id, intf_cport);
+
+	if (ret < 0) {
+		if (ret == -EAGAIN) {
+			LOG_WRN("No credits for interface %u cport %u", intf_id, intf_cport);
+		} else {
+			LOG_ERR("No connection for interface %u cport %u", intf_id, intf_cport);
+		}
+		gb_message_dealloc(msg);
+		return ret;
 	}
+#endif
 
-	return intf->write(intf, msg, target_cport);
+	return route(intf_id, intf_cport, msg);
 }
@@ -0,0 +1,293 @@
+/*
+ * Copyright (c) 2026 BeagleBoard.org
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Per interface TX queues of the APBridge. Routed messages are queued on the target interface
+ * and written by a pool of worker threads. An interface is served by at most one worker at a
+ * time, which keeps its messages in order, and interfaces with pending messages take turns one
+ * message at a time. A write that stalls only holds its own interface and one worker.
+ */
+
+#include <greybus/apbridge.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/slist.h>
+#include <zephyr/logging/log.h>
+#include "greybus_heap.h"
+#include "greybus_internal.h"
+
+LOG_MODULE_REGISTER(greybus_apbridge_txq, CONFIG_GREYBUS_LOG_LEVEL);
+
+#define TXQ_DEPTH CONFIG_GREYBUS_APBRIDGE_TX_QUEUE_DEPTH
+
+struct gb_apbridge_tx_item {
+	struct gb_message *msg;
+	uint16_t cport;
+};
+
+struct gb_apbridge_txq {
+	/* Entry in the ready list */
+	sys_snode_t node;
+	struct gb_interface *intf;
+	/* Free slots, senders wait on it for backpressure */
+	struct k_sem space;
+	struct gb_apbridge_tx_item items[TXQ_DEPTH];
+	uint8_t head;
+	uint8_t count;
+	/* On the ready list or held by a worker */
+	bool scheduled;
+	/* Interface being removed, nothing is queued or written anymore */
+	bool closed;
+	/* No reader can reach the queue anymore, freed by whoever holds it last */
+	bool released;
+	struct gb_apbridge_tx_stats stats;
+};
+
+/* Queues with messages waiting for a worker */
+static sys_slist_t ready = SYS_SLIST_STATIC_INIT(&ready);
+static K_SEM_DEFINE(ready_sem, 0, K_SEM_MAX_LIMIT);
+static struct k_spinlock lock;
+
+/* Must be called with the lock held */
+static void txq_schedule(struct gb_apbridge_txq *q)
+{
+	q->scheduled = true;
+	sys_slist_append(&ready, &q->node);
+	k_sem_give(&ready_sem);
+}
+
+static void txq_worker(void *p1, void *p2, void *p3)
+{
+	struct gb_apbridge_txq *q;
+	struct gb_apbridge_tx_item item;
+	struct gb_interface *intf;
+	k_spinlock_key_t key;
+	sys_snode_t *node;
+	bool release;
+	int ret, rkey;
+
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (1) {
+		k_sem_take(&ready_sem, K_FOREVER);
+
+		/*
+		 * Entered before looking at the queue. Removal closes the queue before it waits for
+		 * readers, so an item taken from an open queue has an interface to be written to. The
+		 * reference keeps it around for the write, which runs outside of the read section.
+		 */
+		rkey = gb_interface_read_lock();
+
+		key = k_spin_lock(&lock);
+		node = sys_slist_get(&ready);
+		if (!node) {
+			k_spin_unlock(&lock, key);
+			gb_interface_read_unlock(rkey);
+			continue;
+		}
+
+		q = CONTAINER_OF(node, struct gb_apbridge_txq, node);
+		if (q->closed || q->count == 0) {
+			q->scheduled = false;
+			release = q->released;
+			k_spin_unlock(&lock, key);
+			gb_interface_read_unlock(rkey);
+			if (release) {
+				gb_free(q);
+			}
+			continue;
+		}
+
+		item = q->items[q->head];
+		q->head = (q->head + 1) % TXQ_DEPTH;
+		q->count--;
+		q->stats.queued = q->count;
+		intf = q->intf;
+		gb_interface_ref(intf);
+		k_spin_unlock(&lock, key);
+		gb_interface_read_unlock(rkey);
+
+		k_sem_give(&q->space);
+
+		/* Ownership of the message goes to the interface */
+		ret = intf->write(intf, item.msg, item.cport);
+#ifdef CONFIG_GREYBUS_APBRIDGE_CREDITS
+		gb_apbridge_write_done(intf, item.cport, ret);
+#endif
+		gb_interface_unref(intf);
+
+		key = k_spin_lock(&lock);
+		if (ret < 0) {
+			q->stats.write_errors++;
+		} else {
+			q->stats.sent++;
+		}
+
+		release = q->released;
+		if (!q->closed && q->count > 0) {
+			/* Back to the end of the line, other interfaces get their turn */
+			sys_slist_append(&ready, &q->node);
+			k_sem_give(&ready_sem);
+		} else {
+			q->scheduled = false;
+		}
+		k_spin_unlock(&lock, key);
+
+		if (release) {
+			gb_free(q);
+		}
+	}
+}
+
+#define TXQ_WORKER_DEFINE(i, _)                                                                    \
+	K_THREAD_DEFINE(gb_apbridge_txq_tid_##i, CONFIG_GREYBUS_APBRIDGE_TX_STACK_SIZE, txq_worker, \
+			NULL, NULL, NULL, CONFIG_GREYBUS_APBRIDGE_TX_THREAD_PRIORITY, 0, 0)
+
+LISTIFY(CONFIG_GREYBUS_APBRIDGE_TX_WORKERS, TXQ_WORKER_DEFINE, (;));
+
+int gb_apbridge_txq_attach(struct gb_interface *intf)
+{
+	struct gb_apbridge_txq *q = gb_alloc(sizeof(*q));
+
+	if (!q) {
+		return -ENOMEM;
+	}
+
+	memset(q, 0, sizeof(*q));
+	q->intf = intf;
+	k_sem_init(&q->space, TXQ_DEPTH, TXQ_DEPTH);
+	intf->txq = q;
+
+	return 0;
+}
+
+/*
+ * Drop everything still queued and refuse new messages. Called once the interface is
+ * unpublished, before waiting for readers.
+ */
+void gb_apbridge_txq_close(struct gb_interface *intf)
+{
+	struct gb_apbridge_txq *q = intf->txq;
+	struct gb_apbridge_tx_item items[TXQ_DEPTH];
+	k_spinlock_key_t key;
+	size_t count, i;
+
+	if (!q) {
+		return;
+	}
+
+	key = k_spin_lock(&lock);
+	q->closed = true;
+	count = q->count;
+	for (i = 0; i < count; i++) {
+		items[i] = q->items[(q->head + i) % TXQ_DEPTH];
+	}
+	q->count = 0;
+	q->stats.queued = 0;
+	k_spin_unlock(&lock, key);
+
+	for (i = 0; i < count; i++) {
+		gb_message_dealloc(items[i].msg);
+#ifdef CONFIG_GREYBUS_APBRIDGE_CREDITS
+		gb_apbridge_write_done(intf, items[i].cport, -ENODEV);
+#endif
+		/* Senders waiting for space see the queue closed */
+		k_sem_give(&q->space);
+	}
+}
+
+/*
+ * Free the queue once no reader can reach it anymore. A worker still holding it frees it when
+ * done.
+ */
+void gb_apbridge_txq_release(struct gb_interface *intf)
+{
+	struct gb_apbridge_txq *q = intf->txq;
+	k_spinlock_key_t key;
+	bool release;
+
+	if (!q) {
+		return;
+	}
+
+	gb_apbridge_txq_close(intf);
+
+	key = k_spin_lock(&lock);
+	intf->txq = NULL;
+	q->released = true;
+	release = !q->scheduled;
+	k_spin_unlock(&lock, key);
+
+	if (release) {
+		gb_free(q);
+	}
+}
+
+int gb_apbridge_txq_write(struct gb_interface *intf, struct gb_message *msg, uint16_t cport)
+{
+	const k_timeout_t timeout = k_is_in_isr()
+					    ? K_NO_WAIT
+					    : K_MSEC(CONFIG_GREYBUS_APBRIDGE_TX_QUEUE_TIMEOUT_MS);
+	struct gb_apbridge_txq *q = intf->txq;
+	k_spinlock_key_t key;
+	size_t tail;
+
+	if (!q) {
+		gb_message_dealloc(msg);
+		return -ENODEV;
+	}
+
+	if (k_sem_take(&q->space, timeout) < 0) {
+		key = k_spin_lock(&lock);
+		q->stats.dropped++;
+		k_spin_unlock(&lock, key);
+
+		LOG_WRN("Interface %u TX queue full, dropping message", intf->id);
+		gb_message_dealloc(msg);
+		return -ENOBUFS;
+	}
+
+	key = k_spin_lock(&lock);
+	if (q->closed) {
+		k_spin_unlock(&lock, key);
+		gb_message_dealloc(msg);
+		return -ENODEV;
+	}
+
+	tail = (q->head + q->count) % TXQ_DEPTH;
+	q->items[tail].msg = msg;
+	q->items[tail].cport = cport;
+	q->count++;
+	q->stats.queued = q->count;
+	q->stats.max_queued = MAX(q->stats.max_queued, q->count);
+
+	if (!q->scheduled) {
+		txq_schedule(q);
+	}
+	k_spin_unlock(&lock, key);
+
+	return 0;
+}
+
+int gb_apbridge_tx_stats(uint8_t intf_id, struct gb_apbridge_tx_stats *stats)
+{
+	const int rkey = gb_interface_read_lock();
+	struct gb_interface *intf = gb_interface_get(intf_id);
+	k_spinlock_key_t key;
+	int ret = 0;
+
+	key = k_spin_lock(&lock);
+	if (intf && intf->txq) {
+		*stats = intf->txq->stats;
+	} else {
+		ret = -ENOENT;
+	}
+	k_spin_unlock(&lock, key);
+
+	gb_interface_read_unlock(rkey);
+
+	return ret;
+}
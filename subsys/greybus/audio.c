@@ -380,7 +380,7 @@ int gb_audio_send_jack_event(uint16_t cport, uint8_t widget_id, uint8_t jack_att
 	req->event = event;
 
 	/* Send the event to the Linux host */
-	return gb_transport_message_send(msg, cport);
+	return gb_transport_message_send_owned(msg, cport);
 }
 
 int gb_audio_send_button_event(uint16_t cport, uint8_t widget_id, uint8_t button_id, uint8_t event)
@@ -400,7 +400,7 @@ int gb_audio_send_button_event(uint16_t cport, uint8_t widget_id, uint8_t button
 	req->button_id = button_id;
 	req->event = event;
 
-	return gb_transport_message_send(msg, cport);
+	return gb_transport_message_send_owned(msg, cport);
 }
 
 // These are sort of stubs for hardware migration. In a real hardware, this turns on and off the
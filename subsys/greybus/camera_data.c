@@ -41,6 +41,16 @@ static void gb_camera_frame_worker(struct k_work *work)
 
 	uint32_t frame_size = vbuf->bytesused;
 	uint32_t offset = 0;
+	const uint32_t mtu = gb_transport_chunk_size(0, GB_CAMERA_DATA_MTU);
+
+	if (mtu == 0) {
+		LOG_ERR("Transport cannot carry camera data, stopping stream.");
+		atomic_set(&ctx->stream_state, GB_DATA_STATE_IDLE);
+
+		video_enqueue(ctx->video_dev, vbuf);
+		k_mutex_unlock(&ctx->data_lock);
+		return;
+	}
 
 	ctx->frag_state.frame_id++;
 	if (ctx->frag_state.target_frames > 0 &&
@@ -58,8 +68,8 @@ static void gb_camera_frame_worker(struct k_work *work)
 	while (offset < frame_size) {
 
 		uint32_t chunk_size = frame_size - offset;
-		if (chunk_size > GB_CAMERA_DATA_MTU) {
-			chunk_size = GB_CAMERA_DATA_MTU;
+		if (chunk_size > mtu) {
+			chunk_size = mtu;
 		}
 
 		struct gb_message *msg;
@@ -112,6 +122,10 @@ int gb_camera_data_init(struct gb_camera_data_ctx *ctx, const struct device *vid
 	ctx->data_cport = cport;
 	atomic_set(&ctx->stream_state, GB_DATA_STATE_IDLE);
 
+#ifdef CONFIG_GREYBUS_TX_SCHED
+	gb_tx_sched_set_class(cport, GB_TX_CLASS_BULK);
+#endif
+
 	k_mutex_init(&ctx->data_lock);
 	k_work_init_delayable(&ctx->frame_work, gb_camera_frame_worker);
 
@@ -10,6 +10,7 @@
 #include <zephyr/kernel.h>
 #include <zephyr/device.h>
 
+/* Largest fragment, the transport link can impose a smaller one */
 #define GB_CAMERA_DATA_MTU        1024
 #define GB_CAMERA_NUM_BUFFERS     3
 #define GB_CAMERA_BUFFER_SIZE     4096
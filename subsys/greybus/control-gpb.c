@@ -36,6 +36,10 @@
 #include <greybus/greybus_protocols.h>
 #include "greybus_internal.h"
 
+#ifdef CONFIG_GREYBUS_TIMESYNC
+#include <greybus/timesync.h>
+#endif
+
 LOG_MODULE_REGISTER(greybus_control, CONFIG_GREYBUS_LOG_LEVEL);
 
 #define GB_CONTROL_VERSION_MAJOR 0
@@ -48,6 +52,11 @@ static void gb_control_protocol_version(uint16_t cport, struct gb_message *req)
 		.minor = GB_CONTROL_VERSION_MINOR,
 	};
 
+#ifdef CONFIG_GREYBUS_AGGREGATION
+	/* A new host is enumerating the node, it has to opt in to envelopes again */
+	gb_aggregate_reset();
+#endif
+
 	gb_transport_message_response_success_send(req, &resp_data, sizeof(resp_data), cport);
 }
 
@@ -67,9 +76,7 @@ static void gb_control_get_manifest(uint16_t cport, struct gb_message *req)
 
 	manifest_create(msg->payload, manifest_size());
 
-	gb_transport_message_send(msg, cport);
-
-	gb_message_dealloc(msg);
+	gb_transport_message_send_owned(msg, cport);
 }
 
 static void gb_control_connected(uint16_t cport, struct gb_message *req)
@@ -145,6 +152,70 @@ static void gb_control_pm_stub(uint16_t cport, struct gb_message *req)
 	gb_transport_message_response_success_send(req, &resp_data, sizeof(resp_data), cport);
 }
 
+#ifdef CONFIG_GREYBUS_TIMESYNC
+static void gb_control_timesync_enable(uint16_t cport, struct gb_message *req)
+{
+	const struct gb_control_timesync_enable_request *req_data =
+		(const struct gb_control_timesync_enable_request *)req->payload;
+	int retval;
+
+	if (gb_message_payload_len(req) < sizeof(*req_data)) {
+		LOG_ERR("dropping short message");
+		return gb_transport_message_empty_response_send(req, GB_OP_INVALID, cport);
+	}
+
+	retval = gb_timesync_enable(req_data->count, sys_le64_to_cpu(req_data->frame_time),
+				    sys_le32_to_cpu(req_data->refclk));
+
+	gb_transport_message_empty_response_send(req, gb_errno_to_op_result(retval), cport);
+}
+
+static void gb_control_timesync_disable(uint16_t cport, struct gb_message *req)
+{
+	gb_timesync_disable();
+
+	gb_transport_message_empty_response_send(req, GB_OP_SUCCESS, cport);
+}
+
+static void gb_control_timesync_authoritative(uint16_t cport, struct gb_message *req)
+{
+	const struct gb_control_timesync_authoritative_request *req_data =
+		(const struct gb_control_timesync_authoritative_request *)req->payload;
+	uint64_t frame_time[GB_TIMESYNC_MAX_STROBES];
+	int retval;
+
+	if (gb_message_payload_len(req) < sizeof(*req_data)) {
+		LOG_ERR("dropping short message");
+		return gb_transport_message_empty_response_send(req, GB_OP_INVALID, cport);
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(frame_time); i++) {
+		frame_time[i] = sys_le64_to_cpu(req_data->frame_time[i]);
+	}
+
+	retval = gb_timesync_authoritative(frame_time);
+
+	gb_transport_message_empty_response_send(req, gb_errno_to_op_result(retval), cport);
+}
+
+static void gb_control_timesync_get_last_event(uint16_t cport, struct gb_message *req)
+{
+	struct gb_control_timesync_get_last_event_response resp_data;
+	uint64_t frame_time;
+	int retval;
+
+	retval = gb_timesync_get_last_event(&frame_time);
+	if (retval) {
+		return gb_transport_message_empty_response_send(req, gb_errno_to_op_result(retval),
+								cport);
+	}
+
+	resp_data.frame_time = sys_cpu_to_le64(frame_time);
+
+	gb_transport_message_response_success_send(req, &resp_data, sizeof(resp_data), cport);
+}
+#endif
+
 static void gb_control_handler(const void *priv, struct gb_message *msg, uint16_t cport)
 {
 	ARG_UNUSED(priv);
@@ -172,12 +243,22 @@ static void gb_control_handler(const void *priv, struct gb_message *msg, uint16_
 	/* XXX SW-4136: see control-gb.h */
 	/*GB_HANDLER(GB_CONTROL_TYPE_INTF_POWER_STATE_SET, gb_control_intf_pwr_set),
 	GB_HANDLER(GB_CONTROL_TYPE_BUNDLE_POWER_STATE_SET, gb_control_bundle_pwr_set),*/
-	/* TODO: Properly implement timesync */
+#ifdef CONFIG_GREYBUS_TIMESYNC
+	case GB_CONTROL_TYPE_TIMESYNC_ENABLE:
+		return gb_control_timesync_enable(cport, msg);
+	case GB_CONTROL_TYPE_TIMESYNC_DISABLE:
+		return gb_control_timesync_disable(cport, msg);
+	case GB_CONTROL_TYPE_TIMESYNC_AUTHORITATIVE:
+		return gb_control_timesync_authoritative(cport, msg);
+	case GB_CONTROL_TYPE_TIMESYNC_GET_LAST_EVENT:
+		return gb_control_timesync_get_last_event(cport, msg);
+#else
 	case GB_CONTROL_TYPE_TIMESYNC_ENABLE:
 	case GB_CONTROL_TYPE_TIMESYNC_DISABLE:
 	case GB_CONTROL_TYPE_TIMESYNC_AUTHORITATIVE:
 	case GB_CONTROL_TYPE_TIMESYNC_GET_LAST_EVENT:
 		return gb_transport_message_empty_response_send(msg, GB_OP_SUCCESS, cport);
+#endif
 	default:
 		LOG_ERR("Invalid type");
 		gb_transport_message_empty_response_send(msg, GB_OP_INVALID, cport);
@@ -15,12 +15,11 @@
 
 LOG_MODULE_REGISTER(greybus_fw_download, CONFIG_GREYBUS_LOG_LEVEL);
 
-#define DATA_SIZE_MAX 64
-
 struct fw_download_priv_data {
 	struct flash_img_context ctx;
 	uint32_t fw_size;
 	uint32_t offset;
+	uint32_t chunk_size;
 	int req_id;
 	uint8_t fw_id;
 };
@@ -55,6 +54,25 @@ static void gb_fw_download_fetch_firmware(uint16_t cport, uint8_t id, uint16_t o
 	gb_transport_message_send((const struct gb_message *)&req, cport);
 }
 
+static void gb_fw_release_firmware(uint16_t cport, u8 firmware_id)
+{
+	struct gb_message *req =
+		gb_message_request_alloc(sizeof(struct gb_fw_download_release_firmware_request),
+					 GB_FW_DOWNLOAD_TYPE_RELEASE_FIRMWARE, false);
+	struct gb_fw_download_release_firmware_request *req_data =
+		(struct gb_fw_download_release_firmware_request *)req->payload;
+
+	req_data->firmware_id = firmware_id;
+
+	gb_transport_message_send_owned(req, cport);
+}
+
+static void gb_fw_download_early_fail(uint16_t cport, u8 firmware_id, uint8_t req_id)
+{
+	gb_fw_release_firmware(cport, firmware_id);
+	gb_fw_mgmt_interface_fw_loaded(req_id, GB_FW_LOAD_STATUS_FAILED, 0, 0);
+}
+
 static void gb_fw_download_find_firmware_response_handler(uint16_t cport, struct gb_message *resp)
 {
 	const struct gb_fw_download_find_firmware_response *resp_data =
@@ -69,30 +87,19 @@ static void gb_fw_download_find_firmware_response_handler(uint16_t cport, struct
 	priv_data.fw_id = resp_data->firmware_id;
 	priv_data.fw_size = resp_data->size;
 	priv_data.offset = 0;
+	priv_data.chunk_size = gb_transport_chunk_size(0, CONFIG_GREYBUS_FW_DOWNLOAD_CHUNK_SIZE);
 
 	gb_message_dealloc(resp);
 
-	gb_fw_download_fetch_firmware(cport, resp_data->firmware_id, 0, DATA_SIZE_MAX);
-}
-
-static void gb_fw_release_firmware(uint16_t cport, u8 firmware_id)
-{
-	struct gb_message *req =
-		gb_message_request_alloc(sizeof(struct gb_fw_download_release_firmware_request),
-					 GB_FW_DOWNLOAD_TYPE_RELEASE_FIRMWARE, false);
-	struct gb_fw_download_release_firmware_request *req_data =
-		(struct gb_fw_download_release_firmware_request *)req->payload;
-
-	req_data->firmware_id = firmware_id;
-
-	gb_transport_message_send(req, cport);
-	gb_message_dealloc(req);
-}
+	/* Empty fetches would never get to the end of the firmware */
+	if (priv_data.chunk_size == 0) {
+		LOG_ERR("Transport cannot carry firmware chunks");
+		gb_fw_download_early_fail(cport, priv_data.fw_id, priv_data.req_id);
+		priv_data.req_id = -1;
+		return;
+	}
 
-static void gb_fw_download_early_fail(uint16_t cport, u8 firmware_id, uint8_t req_id)
-{
-	gb_fw_release_firmware(cport, firmware_id);
-	gb_fw_mgmt_interface_fw_loaded(req_id, GB_FW_LOAD_STATUS_FAILED, 0, 0);
+	gb_fw_download_fetch_firmware(cport, priv_data.fw_id, 0, priv_data.chunk_size);
 }
 
 static void gb_fw_download_fetch_final(uint16_t cport, u8 firmware_id, uint8_t req_id)
@@ -120,7 +127,7 @@ static void gb_fw_download_fetch_firmware_response_handler(uint16_t cport, struc
 {
 	int ret;
 	uint32_t new_data_size;
-	uint32_t cur_data_size = MIN(priv_data.fw_size - priv_data.offset, DATA_SIZE_MAX);
+	uint32_t cur_data_size = MIN(priv_data.fw_size - priv_data.offset, priv_data.chunk_size);
 	bool is_final_write = priv_data.offset + cur_data_size >= priv_data.fw_size;
 
 	if (!gb_message_is_success(resp)) {
@@ -132,7 +139,7 @@ static void gb_fw_download_fetch_firmware_response_handler(uint16_t cport, struc
 	if (is_final_write) {
 		gb_fw_release_firmware(cport, priv_data.fw_id);
 	} else {
-		new_data_size = MIN(priv_data.fw_size - priv_data.offset, DATA_SIZE_MAX);
+		new_data_size = MIN(priv_data.fw_size - priv_data.offset, priv_data.chunk_size);
 		gb_fw_download_fetch_firmware(cport, priv_data.fw_id, priv_data.offset,
 					      new_data_size);
 	}
@@ -186,6 +193,5 @@ void gb_fw_download_find_firmware(uint8_t req_id, const char *firmware_tag)
 	priv_data.req_id = req_id;
 	strncpy(req_data->firmware_tag, firmware_tag, sizeof(req_data->firmware_tag));
 
-	gb_transport_message_send(req, GREYBUS_FW_DOWNLOAD_CPORT);
-	gb_message_dealloc(req);
+	gb_transport_message_send_owned(req, GREYBUS_FW_DOWNLOAD_CPORT);
 }
@@ -37,9 +37,702 @@
 #include "greybus_gpio.h"
 #include <greybus/greybus_protocols.h>
 #include "greybus_internal.h"
+#include "greybus_cport.h"
+#include <greybus/gpio.h>
 
 LOG_MODULE_REGISTER(greybus_gpio, CONFIG_GREYBUS_LOG_LEVEL);
 
+struct gpio_irq_event_request_msg {
+	struct gb_operation_msg_hdr hdr;
+	struct gb_gpio_irq_event_request body;
+} __packed;
+
+/*
+ * IRQ events are sent from a work queue of their own, sending can block in the transport. The
+ * interrupt only marks lines pending, so a noisy line costs one event per batch at most.
+ */
+static K_THREAD_STACK_DEFINE(gpio_wq_stack, CONFIG_GREYBUS_GPIO_IRQ_STACK_SIZE);
+static struct k_work_q gpio_wq;
+static bool gpio_wq_started;
+/* Protects irq_holdoff and the scheduling of the debounce work */
+static struct k_spinlock irq_lock;
+
+static void gpio_irq_work_handler(struct k_work *work)
+{
+	struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+	struct gb_gpio_driver_data *data =
+		CONTAINER_OF(dwork, struct gb_gpio_driver_data, irq_work);
+	uint8_t buf[sizeof(struct gpio_irq_event_request_msg)] = {0};
+	struct gpio_irq_event_request_msg *msg = (struct gpio_irq_event_request_msg *)buf;
+	gpio_port_pins_t pins = atomic_clear(&data->irq_pending);
+	k_spinlock_key_t key;
+	int ret;
+
+	if (CONFIG_GREYBUS_GPIO_IRQ_INTERVAL_US > 0) {
+		key = k_spin_lock(&irq_lock);
+		data->irq_holdoff = sys_timepoint_calc(K_USEC(CONFIG_GREYBUS_GPIO_IRQ_INTERVAL_US));
+		k_spin_unlock(&irq_lock, key);
+	}
+
+	msg->hdr.size = sys_cpu_to_le16(sizeof(buf));
+	msg->hdr.type = GB_GPIO_TYPE_IRQ_EVENT;
+
+	for (; pins != 0; pins &= pins - 1) {
+		msg->body.which = u32_count_trailing_zeros(pins);
+		ret = gb_transport_message_send_tracked((const struct gb_message *)buf, data->cport,
+							&data->irq_failed);
+		if (ret < 0) {
+			LOG_ERR("GPIO irq send failed: %d", ret);
+			atomic_inc(&data->irq_dropped);
+		} else {
+			atomic_inc(&data->irq_sent);
+		}
+	}
+}
+
+static int gb_gpio_irq_flags(uint8_t type, gpio_flags_t *flags)
+{
+	switch (type) {
+	case GB_GPIO_IRQ_TYPE_NONE:
+		*flags = GPIO_INT_DISABLE;
+		break;
+	case GB_GPIO_IRQ_TYPE_EDGE_RISING:
+		*flags = GPIO_INT_EDGE_RISING;
+		break;
+	case GB_GPIO_IRQ_TYPE_EDGE_FALLING:
+		*flags = GPIO_INT_EDGE_FALLING;
+		break;
+	case GB_GPIO_IRQ_TYPE_EDGE_BOTH:
+		*flags = GPIO_INT_EDGE_BOTH;
+		break;
+	case GB_GPIO_IRQ_TYPE_LEVEL_HIGH:
+		*flags = GPIO_INT_LEVEL_HIGH;
+		break;
+	case GB_GPIO_IRQ_TYPE_LEVEL_LOW:
+		*flags = GPIO_INT_LEVEL_LOW;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+/* Queue IRQ events for lines. Callable from ISR. */
+static void gpio_irq_post(struct gb_gpio_driver_data *data, gpio_port_pins_t pins)
+{
+	gpio_port_pins_t merged;
+	k_timeout_t delay;
+	k_spinlock_key_t key;
+
+	merged = atomic_or(&data->irq_pending, pins) & pins;
+	if (merged) {
+		atomic_add(&data->irq_merged, POPCOUNT(merged));
+	}
+
+	key = k_spin_lock(&irq_lock);
+	delay = sys_timepoint_timeout(data->irq_holdoff);
+	k_spin_unlock(&irq_lock, key);
+
+	/* Does nothing if the batch is already scheduled */
+	k_work_schedule_for_queue(&gpio_wq, &data->irq_work, delay);
+}
+
+#ifdef CONFIG_GREYBUS_GPIO_CACHE
+/*
+ * Shadow of the line configuration. Every change the protocol makes goes through the helpers
+ * below, which skip driver calls that would not change anything and answer reads of direction
+ * and output level. Levels are kept physical like the port operations, single line accessors
+ * translate through the active-low mask of the port the way gpio_pin_get()/gpio_pin_set() do.
+ * Lines only become known once configured here, anything done behind the back of Greybus needs
+ * gb_gpio_cache_invalidate().
+ */
+static struct gb_gpio_cache *gpio_cache(const struct gb_gpio_driver_data *data)
+{
+	return (struct gb_gpio_cache *)&data->cache;
+}
+
+static gpio_port_pins_t gpio_line_invert(const struct gb_gpio_driver_data *data)
+{
+	return ((const struct gpio_driver_data *)data->dev->data)->invert;
+}
+
+static void gpio_cache_drop(const struct gb_gpio_driver_data *data, gpio_port_pins_t pins)
+{
+	struct gb_gpio_cache *cache = gpio_cache(data);
+	const k_spinlock_key_t key = k_spin_lock(&cache->lock);
+
+	cache->valid &= ~pins;
+	cache->irq_valid &= ~pins;
+
+	k_spin_unlock(&cache->lock, key);
+}
+
+/* Output flags must carry the initial level */
+static int gpio_line_configure(const struct gb_gpio_driver_data *data, gpio_pin_t pin,
+			       gpio_flags_t flags)
+{
+	struct gb_gpio_cache *cache = gpio_cache(data);
+	const bool output = (flags & GPIO_OUTPUT) != 0;
+	const bool high = (flags & GPIO_OUTPUT_INIT_HIGH) != 0;
+	k_spinlock_key_t key;
+	bool hit;
+	int ret;
+
+	key = k_spin_lock(&cache->lock);
+	hit = (cache->valid & BIT(pin)) && ((cache->output & BIT(pin)) != 0) == output &&
+	      (!output || ((cache->value & BIT(pin)) != 0) == high);
+	k_spin_unlock(&cache->lock, key);
+
+	if (hit) {
+		return 0;
+	}
+
+	ret = gpio_pin_configure(data->dev, pin, flags);
+
+	key = k_spin_lock(&cache->lock);
+	if (ret == 0) {
+		cache->valid |= BIT(pin);
+		WRITE_BIT(cache->output, pin, output);
+		WRITE_BIT(cache->value, pin, output && high);
+	} else {
+		cache->valid &= ~BIT(pin);
+	}
+	k_spin_unlock(&cache->lock, key);
+
+	return ret;
+}
+
+static int gpio_line_is_input(const struct gb_gpio_driver_data *data, gpio_pin_t pin)
+{
+	struct gb_gpio_cache *cache = gpio_cache(data);
+	k_spinlock_key_t key;
+	int ret = -ENODATA;
+
+	key = k_spin_lock(&cache->lock);
+	if (cache->valid & BIT(pin)) {
+		ret = (cache->output & BIT(pin)) ? 0 : 1;
+	}
+	k_spin_unlock(&cache->lock, key);
+
+	if (ret != -ENODATA) {
+		return ret;
+	}
+
+	ret = gpio_pin_is_input(data->dev, pin);
+
+	/* The level of an output is unknown, only inputs can be learned here */
+	if (ret == 1) {
+		key = k_spin_lock(&cache->lock);
+		cache->valid |= BIT(pin);
+		cache->output &= ~BIT(pin);
+		k_spin_unlock(&cache->lock, key);
+	}
+
+	return ret;
+}
+
+static int gpio_line_get(const struct gb_gpio_driver_data *data, gpio_pin_t pin)
+{
+	struct gb_gpio_cache *cache = gpio_cache(data);
+	const k_spinlock_key_t key = k_spin_lock(&cache->lock);
+	int ret = -ENODATA;
+
+	if (cache->valid & cache->output & BIT(pin)) {
+		ret = ((cache->value ^ gpio_line_invert(data)) & BIT(pin)) ? 1 : 0;
+	}
+	k_spin_unlock(&cache->lock, key);
+
+	/* Inputs are always read */
+	return ret != -ENODATA ? ret : gpio_pin_get(data->dev, pin);
+}
+
+static int gpio_line_port_set(const struct gb_gpio_driver_data *data, gpio_port_pins_t mask,
+			      gpio_port_value_t value)
+{
+	struct gb_gpio_cache *cache = gpio_cache(data);
+	gpio_port_pins_t known;
+	k_spinlock_key_t key;
+	int ret;
+
+	/* Only outputs known to be at another level are written */
+	key = k_spin_lock(&cache->lock);
+	known = cache->valid & cache->output;
+	mask &= ~(known & ~(cache->value ^ value));
+	k_spin_unlock(&cache->lock, key);
+
+	if (mask == 0) {
+		return 0;
+	}
+
+	ret = gpio_port_set_masked_raw(data->dev, mask, value);
+
+	key = k_spin_lock(&cache->lock);
+	if (ret == 0) {
+		cache->value = (cache->value & ~mask) | (value & mask);
+	} else {
+		cache->valid &= ~mask;
+	}
+	k_spin_unlock(&cache->lock, key);
+
+	return ret;
+}
+
+static int gpio_line_set(const struct gb_gpio_driver_data *data, gpio_pin_t pin, int value)
+{
+	const gpio_port_value_t level = value ? BIT(pin) : 0;
+
+	/* Logical like gpio_pin_set(), the cache and port writes are physical */
+	return gpio_line_port_set(data, BIT(pin), (level ^ gpio_line_invert(data)) & BIT(pin));
+}
+
+static int gpio_line_interrupt_configure(const struct gb_gpio_driver_data *data, gpio_pin_t pin,
+					 gpio_flags_t flags)
+{
+	struct gb_gpio_cache *cache = gpio_cache(data);
+	k_spinlock_key_t key;
+	bool hit;
+	int ret;
+
+	key = k_spin_lock(&cache->lock);
+	hit = (cache->irq_valid & BIT(pin)) && cache->irq[pin] == flags;
+	k_spin_unlock(&cache->lock, key);
+
+	if (hit) {
+		return 0;
+	}
+
+	ret = gpio_pin_interrupt_configure(data->dev, pin, flags);
+
+	key = k_spin_lock(&cache->lock);
+	if (ret == 0) {
+		cache->irq_valid |= BIT(pin);
+		cache->irq[pin] = flags;
+	} else {
+		cache->irq_valid &= ~BIT(pin);
+	}
+	k_spin_unlock(&cache->lock, key);
+
+	return ret;
+}
+#else
+static inline void gpio_cache_drop(const struct gb_gpio_driver_data *data, gpio_port_pins_t pins)
+{
+	ARG_UNUSED(data);
+	ARG_UNUSED(pins);
+}
+
+static inline int gpio_line_configure(const struct gb_gpio_driver_data *data, gpio_pin_t pin,
+				      gpio_flags_t flags)
+{
+	return gpio_pin_configure(data->dev, pin, flags);
+}
+
+static inline int gpio_line_is_input(const struct gb_gpio_driver_data *data, gpio_pin_t pin)
+{
+	return gpio_pin_is_input(data->dev, pin);
+}
+
+static inline int gpio_line_get(const struct gb_gpio_driver_data *data, gpio_pin_t pin)
+{
+	return gpio_pin_get(data->dev, pin);
+}
+
+static inline int gpio_line_port_set(const struct gb_gpio_driver_data *data,
+				     gpio_port_pins_t mask, gpio_port_value_t value)
+{
+	return gpio_port_set_masked_raw(data->dev, mask, value);
+}
+
+static inline int gpio_line_set(const struct gb_gpio_driver_data *data, gpio_pin_t pin, int value)
+{
+	return gpio_pin_set(data->dev, pin, value);
+}
+
+static inline int gpio_line_interrupt_configure(const struct gb_gpio_driver_data *data,
+						gpio_pin_t pin, gpio_flags_t flags)
+{
+	return gpio_pin_interrupt_configure(data->dev, pin, flags);
+}
+#endif
+
+#ifdef CONFIG_GREYBUS_GPIO_CAPTURE
+static bool gpio_line_captured(const struct gb_gpio_driver_data *data, gpio_pin_t pin)
+{
+	struct gb_gpio_capture *cap = (struct gb_gpio_capture *)&data->capture;
+	const k_spinlock_key_t key = k_spin_lock(&cap->lock);
+	const bool captured = cap->mask & BIT(pin);
+
+	k_spin_unlock(&cap->lock, key);
+
+	return captured;
+}
+#else
+static inline bool gpio_line_captured(const struct gb_gpio_driver_data *data, gpio_pin_t pin)
+{
+	ARG_UNUSED(data);
+	ARG_UNUSED(pin);
+
+	return false;
+}
+#endif
+
+/*
+ * Configure the interrupt of a line as the host set it up. Captured lines keep their edge
+ * interrupt, the setup is only recorded and applied once capture stops.
+ */
+static int gpio_irq_configure(const struct gb_gpio_driver_data *data, gpio_pin_t pin,
+			      gpio_flags_t flags)
+{
+#ifdef CONFIG_GREYBUS_GPIO_CAPTURE
+	((struct gb_gpio_capture *)&data->capture)->irq_flags[pin] = flags;
+#endif
+	if (gpio_line_captured(data, pin)) {
+		return 0;
+	}
+
+	return gpio_line_interrupt_configure(data, pin, flags);
+}
+
+#ifdef CONFIG_GREYBUS_GPIO_DEBOUNCE
+/*
+ * Software debounce. Interrupts of a filtered line are taken on both edges, each edge restarts
+ * the settle time of the line. Once it passed the port is read and a settled change of level is
+ * reported if it matches the IRQ type of the line. Pulses shorter than the settle time are never
+ * seen by the host.
+ */
+/* Handlers get the driver data const, the debounce state is only changed here */
+static struct gb_gpio_debounce *gpio_debounce(const struct gb_gpio_driver_data *data)
+{
+	return (struct gb_gpio_debounce *)&data->debounce;
+}
+
+static uint32_t gpio_settle_us(const struct gb_gpio_debounce *db, gpio_pin_t pin)
+{
+	return MAX(db->usec[pin], CONFIG_GREYBUS_GPIO_GLITCH_FILTER_US);
+}
+
+static bool gpio_irq_type_rising(uint8_t type)
+{
+	return type == GB_GPIO_IRQ_TYPE_EDGE_RISING || type == GB_GPIO_IRQ_TYPE_EDGE_BOTH ||
+	       type == GB_GPIO_IRQ_TYPE_LEVEL_HIGH;
+}
+
+static bool gpio_irq_type_falling(uint8_t type)
+{
+	return type == GB_GPIO_IRQ_TYPE_EDGE_FALLING || type == GB_GPIO_IRQ_TYPE_EDGE_BOTH ||
+	       type == GB_GPIO_IRQ_TYPE_LEVEL_LOW;
+}
+
+/* Run the debounce work of the port in ticks at the latest. Callable from ISR. */
+static void gpio_debounce_schedule(struct gb_gpio_driver_data *data, uint32_t ticks)
+{
+	struct k_work_delayable *work = &data->debounce.work;
+	const k_spinlock_key_t key = k_spin_lock(&irq_lock);
+	const int busy = k_work_delayable_busy_get(work);
+
+	/* A running work item has to run again, it may have missed the line */
+	if (!(busy & K_WORK_QUEUED) &&
+	    !((busy & K_WORK_DELAYED) && k_work_delayable_remaining_get(work) <= ticks)) {
+		k_work_reschedule_for_queue(&gpio_wq, work, K_TICKS(ticks));
+	}
+
+	k_spin_unlock(&irq_lock, key);
+}
+
+/* Take edges of filtered lines, returns the lines that are not filtered */
+static gpio_port_pins_t gpio_debounce_filter(struct gb_gpio_driver_data *data,
+					     gpio_port_pins_t pins)
+{
+	struct gb_gpio_debounce *db = &data->debounce;
+	const uint32_t now = (uint32_t)k_uptime_ticks();
+	gpio_port_pins_t filtered = 0, bouncing;
+	uint32_t ticks, next = UINT32_MAX;
+	gpio_pin_t pin;
+
+	for (gpio_port_pins_t p = pins; p != 0; p &= p - 1) {
+		pin = u32_count_trailing_zeros(p);
+		if (gpio_settle_us(db, pin) == 0) {
+			continue;
+		}
+
+		ticks = k_us_to_ticks_ceil32(gpio_settle_us(db, pin));
+		db->settle[pin] = now + ticks;
+		next = MIN(next, ticks);
+		filtered |= BIT(pin);
+	}
+
+	if (filtered) {
+		bouncing = atomic_or(&db->bouncing, filtered) & filtered;
+		if (bouncing) {
+			atomic_add(&data->irq_debounced, POPCOUNT(bouncing));
+		}
+
+		gpio_debounce_schedule(data, next);
+	}
+
+	return pins & ~filtered;
+}
+
+static void gpio_debounce_work_handler(struct k_work *work)
+{
+	struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+	struct gb_gpio_driver_data *data =
+		CONTAINER_OF(dwork, struct gb_gpio_driver_data, debounce.work);
+	struct gb_gpio_debounce *db = &data->debounce;
+	const uint32_t now = (uint32_t)k_uptime_ticks();
+	gpio_port_pins_t bouncing = atomic_get(&db->bouncing);
+	gpio_port_pins_t settled = 0, changed, events = 0;
+	gpio_port_value_t value;
+	uint32_t next = UINT32_MAX;
+	int32_t remaining;
+	gpio_pin_t pin;
+
+	for (; bouncing != 0; bouncing &= bouncing - 1) {
+		pin = u32_count_trailing_zeros(bouncing);
+		remaining = (int32_t)(db->settle[pin] - now);
+		if (remaining > 0) {
+			next = MIN(next, (uint32_t)remaining);
+		} else {
+			settled |= BIT(pin);
+		}
+	}
+
+	/* An edge racing this is reported with the level read below */
+	atomic_and(&db->bouncing, ~settled);
+
+	if (settled && gpio_port_get_raw(data->dev, &value) == 0) {
+		changed = (value ^ db->level) & settled;
+		db->level ^= changed;
+
+		for (; changed != 0; changed &= changed - 1) {
+			pin = u32_count_trailing_zeros(changed);
+			if ((value & BIT(pin)) ? gpio_irq_type_rising(db->type[pin])
+					       : gpio_irq_type_falling(db->type[pin])) {
+				events |= BIT(pin);
+			}
+		}
+
+		events &= db->enabled;
+		if (events) {
+			gpio_irq_post(data, events);
+		}
+	}
+
+	if (next != UINT32_MAX) {
+		gpio_debounce_schedule(data, next);
+	}
+}
+
+/* Configure the interrupt of a line from its IRQ type, mask and settle time */
+static int gpio_debounce_apply(const struct gb_gpio_driver_data *data, gpio_pin_t pin)
+{
+	struct gb_gpio_debounce *db = gpio_debounce(data);
+	gpio_flags_t flags;
+	int ret;
+
+	if (!(db->enabled & BIT(pin)) || db->type[pin] == GB_GPIO_IRQ_TYPE_NONE) {
+		return gpio_irq_configure(data, pin, GPIO_INT_DISABLE);
+	}
+
+	if (gpio_settle_us(db, pin) == 0) {
+		ret = gb_gpio_irq_flags(db->type[pin], &flags);
+		return ret ? ret : gpio_irq_configure(data, pin, flags);
+	}
+
+	/* Settled changes are reported against the level the line has now */
+	ret = gpio_pin_get_raw(data->dev, pin);
+	if (ret < 0) {
+		return ret;
+	}
+
+	WRITE_BIT(db->level, pin, ret);
+	atomic_and(&db->bouncing, ~BIT(pin));
+
+	return gpio_irq_configure(data, pin, GPIO_INT_EDGE_BOTH);
+}
+#endif
+
+#ifdef CONFIG_GREYBUS_GPIO_CAPTURE
+/*
+ * Edge capture. The interrupt appends a record per edge to the ring of the port, the work sends
+ * what is buffered once count records are in or the oldest record is latency_us old.
+ */
+BUILD_ASSERT(sizeof(struct gb_gpio_capture_event_request) +
+		     CONFIG_GREYBUS_GPIO_CAPTURE_COUNT * sizeof(struct gb_gpio_capture_record) <=
+	     UINT16_MAX - sizeof(struct gb_operation_msg_hdr));
+
+static struct gb_gpio_capture *gpio_capture(const struct gb_gpio_driver_data *data)
+{
+	return (struct gb_gpio_capture *)&data->capture;
+}
+
+/* Must be called with the lock held */
+static k_timeout_t gpio_capture_delay(const struct gb_gpio_capture *cap)
+{
+	const uint64_t age = k_cyc_to_us_floor64(k_cycle_get_64() - cap->ring[cap->head].timestamp);
+
+	return age < cap->latency_us ? K_USEC(cap->latency_us - age) : K_NO_WAIT;
+}
+
+/* Record edges of captured lines. Callable from ISR. */
+static void gpio_capture_record(struct gb_gpio_driver_data *data, gpio_port_pins_t pins)
+{
+	struct gb_gpio_capture *cap = &data->capture;
+	const uint64_t timestamp = k_cycle_get_64();
+	gpio_port_value_t value = 0;
+	struct gb_gpio_capture_entry *entry;
+	k_spinlock_key_t key;
+	gpio_pin_t pin;
+
+	/* Records carry the level after the edge, a failed read reports low */
+	(void)gpio_port_get_raw(data->dev, &value);
+
+	key = k_spin_lock(&cap->lock);
+
+	for (; pins != 0; pins &= pins - 1) {
+		pin = u32_count_trailing_zeros(pins);
+		if (cap->queued == ARRAY_SIZE(cap->ring)) {
+			cap->overruns++;
+			cap->stats.overruns++;
+			continue;
+		}
+
+		entry = &cap->ring[(cap->head + cap->queued) % ARRAY_SIZE(cap->ring)];
+		entry->timestamp = timestamp;
+		entry->which = pin;
+		entry->value = (value & BIT(pin)) ? 1 : 0;
+		cap->queued++;
+		cap->stats.captured++;
+	}
+
+	if (cap->queued >= cap->count) {
+		k_work_reschedule_for_queue(&gpio_wq, &cap->work, K_NO_WAIT);
+	} else {
+		/* Does nothing if already scheduled for an earlier record */
+		k_work_schedule_for_queue(&gpio_wq, &cap->work, gpio_capture_delay(cap));
+	}
+
+	k_spin_unlock(&cap->lock, key);
+}
+
+static void gpio_capture_work_handler(struct k_work *work)
+{
+	struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+	struct gb_gpio_capture *cap = CONTAINER_OF(dwork, struct gb_gpio_capture, work);
+	struct gb_gpio_driver_data *data = CONTAINER_OF(cap, struct gb_gpio_driver_data, capture);
+	struct gb_gpio_capture_event_request *event;
+	struct gb_gpio_capture_entry *entry;
+	struct gb_message *msg;
+	k_spinlock_key_t key;
+	size_t pending, n, i;
+	int ret;
+
+	/* Only what is buffered now, a busy line must not keep the work queue to itself */
+	key = k_spin_lock(&cap->lock);
+	pending = cap->queued;
+	k_spin_unlock(&cap->lock, key);
+
+	while (pending > 0) {
+		n = MIN(pending, cap->count);
+		pending -= n;
+
+		msg = gb_message_request_alloc(sizeof(*event) + n * sizeof(event->records[0]),
+					       GB_GPIO_TYPE_CAPTURE_EVENT, true);
+
+		key = k_spin_lock(&cap->lock);
+		if (!msg) {
+			cap->head = (cap->head + n) % ARRAY_SIZE(cap->ring);
+			cap->queued -= n;
+			cap->stats.dropped += n;
+			k_spin_unlock(&cap->lock, key);
+			LOG_ERR("Failed to allocate capture event, dropping %zu records", n);
+			continue;
+		}
+
+		event = (struct gb_gpio_capture_event_request *)msg->payload;
+		event->overruns = sys_cpu_to_le32(cap->overruns);
+		event->count = sys_cpu_to_le16(n);
+		cap->overruns = 0;
+
+		for (i = 0; i < n; i++) {
+			entry = &cap->ring[cap->head];
+			event->records[i].timestamp = sys_cpu_to_le64(entry->timestamp);
+			event->records[i].which = entry->which;
+			event->records[i].value = entry->value;
+			cap->head = (cap->head + 1) % ARRAY_SIZE(cap->ring);
+		}
+		cap->queued -= n;
+		k_spin_unlock(&cap->lock, key);
+
+		ret = gb_transport_message_send_owned(msg, data->cport);
+
+		key = k_spin_lock(&cap->lock);
+		if (ret < 0) {
+			cap->stats.dropped += n;
+		} else {
+			cap->stats.sent++;
+		}
+		k_spin_unlock(&cap->lock, key);
+
+		if (ret < 0) {
+			LOG_ERR("GPIO capture send failed: %d", ret);
+		}
+	}
+
+	/* Records taken while sending wait for their own latency */
+	key = k_spin_lock(&cap->lock);
+	if (cap->queued > 0) {
+		k_work_schedule_for_queue(&gpio_wq, &cap->work, gpio_capture_delay(cap));
+	}
+	k_spin_unlock(&cap->lock, key);
+}
+
+/* Hand a line no longer captured back to the host's IRQ setup */
+static int gpio_capture_restore(const struct gb_gpio_driver_data *data, gpio_pin_t pin)
+{
+#ifdef CONFIG_GREYBUS_GPIO_DEBOUNCE
+	return gpio_debounce_apply(data, pin);
+#else
+	const gpio_flags_t flags = gpio_capture(data)->irq_flags[pin];
+
+	/* Lines the host never set up have no flags */
+	return gpio_line_interrupt_configure(data, pin, flags ? flags : GPIO_INT_DISABLE);
+#endif
+}
+
+/* Stop capturing, records already buffered are kept */
+static void gpio_capture_stop(const struct gb_gpio_driver_data *data)
+{
+	struct gb_gpio_capture *cap = gpio_capture(data);
+	gpio_port_pins_t mask;
+	k_spinlock_key_t key;
+	gpio_pin_t pin;
+
+	key = k_spin_lock(&cap->lock);
+	mask = cap->mask;
+	cap->mask = 0;
+	k_spin_unlock(&cap->lock, key);
+
+	for (; mask != 0; mask &= mask - 1) {
+		pin = u32_count_trailing_zeros(mask);
+		if (gpio_capture_restore(data, pin) < 0) {
+			LOG_ERR("Failed to restore IRQ setup of GPIO %u", pin);
+		}
+	}
+}
+
+static bool gpio_capture_pending(struct gb_gpio_capture *cap)
+{
+	const k_spinlock_key_t key = k_spin_lock(&cap->lock);
+	const bool pending = cap->queued > 0;
+
+	k_spin_unlock(&cap->lock, key);
+
+	return pending;
+}
+#endif
+
 static void gb_gpio_line_count(uint16_t cport, struct gb_message *req,
 			       const struct gb_gpio_driver_data *data)
 {
@@ -104,7 +797,7 @@ static void gb_gpio_get_direction(uint16_t cport, struct gb_message *req,
 		return gb_transport_message_empty_response_send(req, GB_OP_INVALID, cport);
 	}
 	/* In Greybus 0 := output, 1 := input. */
-	resp_data.direction = gpio_pin_is_input(data->dev, request->which);
+	resp_data.direction = gpio_line_is_input(data, request->which);
 	gb_transport_message_response_success_send(req, &resp_data, sizeof(resp_data), cport);
 }
 
@@ -123,8 +816,7 @@ static void gb_gpio_direction_in(uint16_t cport, struct gb_message *req,
 		LOG_ERR("Invalid GPIO pin index: %u", request->which);
 		return gb_transport_message_empty_response_send(req, GB_OP_INVALID, cport);
 	}
-	ret = gb_errno_to_op_result(
-		gpio_pin_configure(data->dev, (gpio_pin_t)request->which, GPIO_INPUT));
+	ret = gb_errno_to_op_result(gpio_line_configure(data, request->which, GPIO_INPUT));
 	return gb_transport_message_empty_response_send(req, ret, cport);
 }
 
@@ -143,14 +835,10 @@ static void gb_gpio_direction_out(uint16_t cport, struct gb_message *req,
 		LOG_ERR("Invalid GPIO pin index: %u", request->which);
 		return gb_transport_message_empty_response_send(req, GB_OP_INVALID, cport);
 	}
-	ret = gpio_pin_configure(data->dev, request->which, GPIO_OUTPUT);
-	if (ret != 0) {
-		return gb_transport_message_empty_response_send(req, gb_errno_to_op_result(ret),
-								cport);
-	}
-
-	ret = gb_errno_to_op_result(gpio_pin_set(data->dev, request->which, request->value));
-	gb_transport_message_empty_response_send(req, ret, cport);
+	/* Starts at the requested level without a glitch */
+	ret = gpio_line_configure(data, request->which,
+				  request->value ? GPIO_OUTPUT_HIGH : GPIO_OUTPUT_LOW);
+	gb_transport_message_empty_response_send(req, gb_errno_to_op_result(ret), cport);
 }
 
 static void gb_gpio_get_value(uint16_t cport, struct gb_message *req,
@@ -168,7 +856,7 @@ static void gb_gpio_get_value(uint16_t cport, struct gb_message *req,
 		LOG_ERR("Invalid GPIO pin index: %u", request->which);
 		return gb_transport_message_empty_response_send(req, GB_OP_INVALID, cport);
 	}
-	resp_data.value = gpio_pin_get(data->dev, (gpio_pin_t)request->which);
+	resp_data.value = gpio_line_get(data, request->which);
 	gb_transport_message_response_success_send(req, &resp_data, sizeof(resp_data), cport);
 }
 
@@ -187,7 +875,7 @@ static void gb_gpio_set_value(uint16_t cport, struct gb_message *req,
 		LOG_ERR("Invalid GPIO pin index: %u", request->which);
 		return gb_transport_message_empty_response_send(req, GB_OP_INVALID, cport);
 	}
-	ret = gb_errno_to_op_result(gpio_pin_set(data->dev, request->which, request->value));
+	ret = gb_errno_to_op_result(gpio_line_set(data, request->which, request->value));
 	gb_transport_message_empty_response_send(req, ret, cport);
 }
 
@@ -196,6 +884,9 @@ static void gb_gpio_set_debounce(uint16_t cport, struct gb_message *req,
 {
 	uint8_t ret = GB_OP_SUCCESS;
 	gpio_flags_t flags = 0;
+#if defined(CONFIG_GREYBUS_GPIO_DEBOUNCE) && !defined(DT_HAS_TI_CC13XX_CC26XX_GPIO_ENABLED)
+	struct gb_gpio_debounce *db;
+#endif
 	const struct gb_gpio_set_debounce_request *request =
 		(const struct gb_gpio_set_debounce_request *)req->payload;
 
@@ -211,10 +902,22 @@ static void gb_gpio_set_debounce(uint16_t cport, struct gb_message *req,
 		LOG_ERR("Invalid GPIO pin index: %u", request->which);
 		return gb_transport_message_empty_response_send(req, GB_OP_INVALID, cport);
 	}
+#if defined(CONFIG_GREYBUS_GPIO_DEBOUNCE) && !defined(DT_HAS_TI_CC13XX_CC26XX_GPIO_ENABLED)
+	/* No debounce in hardware, filter in software */
+	ARG_UNUSED(flags);
+	db = gpio_debounce(data);
+	db->usec[request->which] = sys_le16_to_cpu(request->usec);
+	if (db->enabled & BIT(request->which)) {
+		ret = gb_errno_to_op_result(gpio_debounce_apply(data, request->which));
+	}
+#else
 	if (sys_le16_to_cpu(request->usec) > 0) {
+		/* Not a direction, the line configuration is no longer known */
+		gpio_cache_drop(data, BIT(request->which));
 		ret = gb_errno_to_op_result(
 			gpio_pin_configure(data->dev, (gpio_pin_t)request->which, flags));
 	}
+#endif
 
 	gb_transport_message_empty_response_send(req, ret, cport);
 }
@@ -234,8 +937,10 @@ static void gb_gpio_irq_mask(uint16_t cport, struct gb_message *req,
 		LOG_ERR("Invalid GPIO pin index: %u", request->which);
 		return gb_transport_message_empty_response_send(req, GB_OP_INVALID, cport);
 	}
-	ret = gb_errno_to_op_result(
-		gpio_pin_interrupt_configure(data->dev, request->which, GPIO_INT_DISABLE));
+#ifdef CONFIG_GREYBUS_GPIO_DEBOUNCE
+	gpio_debounce(data)->enabled &= ~BIT(request->which);
+#endif
+	ret = gb_errno_to_op_result(gpio_irq_configure(data, request->which, GPIO_INT_DISABLE));
 	gb_transport_message_empty_response_send(req, ret, cport);
 }
 
@@ -243,6 +948,9 @@ static void gb_gpio_irq_unmask(uint16_t cport, struct gb_message *req,
 			       const struct gb_gpio_driver_data *data)
 {
 	uint8_t ret;
+#ifdef CONFIG_GREYBUS_GPIO_DEBOUNCE
+	struct gb_gpio_debounce *db;
+#endif
 	const struct gb_gpio_irq_unmask_request *request =
 		(const struct gb_gpio_irq_unmask_request *)req->payload;
 
@@ -254,8 +962,17 @@ static void gb_gpio_irq_unmask(uint16_t cport, struct gb_message *req,
 		LOG_ERR("Invalid GPIO pin index: %u", request->which);
 		return gb_transport_message_empty_response_send(req, GB_OP_INVALID, cport);
 	}
-	ret = gb_errno_to_op_result(gpio_pin_interrupt_configure(
-		data->dev, request->which, GPIO_INT_ENABLE | GPIO_INT_EDGE_RISING));
+#ifdef CONFIG_GREYBUS_GPIO_DEBOUNCE
+	db = gpio_debounce(data);
+	if (db->type[request->which] == GB_GPIO_IRQ_TYPE_NONE) {
+		db->type[request->which] = GB_GPIO_IRQ_TYPE_EDGE_RISING;
+	}
+	db->enabled |= BIT(request->which);
+	ret = gb_errno_to_op_result(gpio_debounce_apply(data, request->which));
+#else
+	ret = gb_errno_to_op_result(
+		gpio_irq_configure(data, request->which, GPIO_INT_ENABLE | GPIO_INT_EDGE_RISING));
+#endif
 	gb_transport_message_empty_response_send(req, ret, cport);
 }
 
@@ -264,6 +981,9 @@ static void gb_gpio_irq_type(uint16_t cport, struct gb_message *req,
 {
 	uint8_t ret;
 	gpio_flags_t flags;
+#ifdef CONFIG_GREYBUS_GPIO_DEBOUNCE
+	struct gb_gpio_debounce *db;
+#endif
 	const struct gb_gpio_irq_type_request *request =
 		(const struct gb_gpio_irq_type_request *)req->payload;
 
@@ -275,34 +995,203 @@ static void gb_gpio_irq_type(uint16_t cport, struct gb_message *req,
 		LOG_ERR("Invalid GPIO pin index: %u", request->which);
 		return gb_transport_message_empty_response_send(req, GB_OP_INVALID, cport);
 	}
-	switch (request->type) {
-	case GB_GPIO_IRQ_TYPE_NONE:
-		flags = GPIO_INT_DISABLE;
-		break;
-	case GB_GPIO_IRQ_TYPE_EDGE_RISING:
-		flags = GPIO_INT_EDGE_RISING;
-		break;
-	case GB_GPIO_IRQ_TYPE_EDGE_FALLING:
-		flags = GPIO_INT_EDGE_FALLING;
-		break;
-	case GB_GPIO_IRQ_TYPE_EDGE_BOTH:
-		flags = GPIO_INT_EDGE_BOTH;
-		break;
-	case GB_GPIO_IRQ_TYPE_LEVEL_HIGH:
-		flags = GPIO_INT_LEVEL_HIGH;
-		break;
-	case GB_GPIO_IRQ_TYPE_LEVEL_LOW:
-		flags = GPIO_INT_LEVEL_LOW;
-		break;
-	default:
+	if (gb_gpio_irq_flags(request->type, &flags) < 0) {
+		return gb_transport_message_empty_response_send(req, GB_OP_INVALID, cport);
+	}
+
+#ifdef CONFIG_GREYBUS_GPIO_DEBOUNCE
+	db = gpio_debounce(data);
+	db->type[request->which] = request->type;
+	db->enabled |= BIT(request->which);
+	ret = gb_errno_to_op_result(gpio_debounce_apply(data, request->which));
+#else
+	ret = gb_errno_to_op_result(gpio_irq_configure(data, request->which, flags));
+#endif
+
+	gb_transport_message_empty_response_send(req, ret, cport);
+}
+
+#ifdef CONFIG_GREYBUS_GPIO_PORT_OPS
+static gpio_port_pins_t gb_gpio_port_pins(const struct gb_gpio_driver_data *data)
+{
+	const struct gpio_driver_config *cfg = (const struct gpio_driver_config *)data->dev->config;
+
+	return cfg->port_pin_mask;
+}
+
+static void gb_gpio_port_get(uint16_t cport, struct gb_message *req,
+			     const struct gb_gpio_driver_data *data)
+{
+	struct gb_gpio_port_get_response resp_data;
+	gpio_port_value_t value;
+	int ret;
+
+	ret = gpio_port_get_raw(data->dev, &value);
+	if (ret < 0) {
+		return gb_transport_message_empty_response_send(req, gb_errno_to_op_result(ret),
+								cport);
+	}
+
+	resp_data.value = sys_cpu_to_le32(value & gb_gpio_port_pins(data));
+	gb_transport_message_response_success_send(req, &resp_data, sizeof(resp_data), cport);
+}
+
+static void gb_gpio_port_set(uint16_t cport, struct gb_message *req,
+			     const struct gb_gpio_driver_data *data)
+{
+	uint8_t ret;
+	const struct gb_gpio_port_set_request *request =
+		(const struct gb_gpio_port_set_request *)req->payload;
+	gpio_port_pins_t mask;
+
+	if (gb_message_payload_len(req) < sizeof(*request)) {
+		LOG_ERR("dropping short message");
 		return gb_transport_message_empty_response_send(req, GB_OP_INVALID, cport);
 	}
 
-	ret = gb_errno_to_op_result(gpio_pin_interrupt_configure(data->dev, request->which, flags));
+	mask = sys_le32_to_cpu(request->mask);
+	if (mask & ~gb_gpio_port_pins(data)) {
+		LOG_ERR("Invalid GPIO pin mask: 0x%08x", mask);
+		return gb_transport_message_empty_response_send(req, GB_OP_INVALID, cport);
+	}
 
+	ret = gb_errno_to_op_result(
+		gpio_line_port_set(data, mask, sys_le32_to_cpu(request->value)));
 	gb_transport_message_empty_response_send(req, ret, cport);
 }
 
+static void gb_gpio_port_direction(uint16_t cport, struct gb_message *req,
+				   const struct gb_gpio_driver_data *data)
+{
+	int ret = 0;
+	const struct gb_gpio_port_direction_request *request =
+		(const struct gb_gpio_port_direction_request *)req->payload;
+	gpio_port_pins_t mask, output, value;
+	gpio_flags_t flags;
+	gpio_pin_t pin;
+
+	if (gb_message_payload_len(req) < sizeof(*request)) {
+		LOG_ERR("dropping short message");
+		return gb_transport_message_empty_response_send(req, GB_OP_INVALID, cport);
+	}
+
+	mask = sys_le32_to_cpu(request->mask);
+	output = sys_le32_to_cpu(request->output);
+	value = sys_le32_to_cpu(request->value);
+	if (mask & ~gb_gpio_port_pins(data)) {
+		LOG_ERR("Invalid GPIO pin mask: 0x%08x", mask);
+		return gb_transport_message_empty_response_send(req, GB_OP_INVALID, cport);
+	}
+
+	/* Zephyr has no port wide configure, outputs start at their level without a glitch */
+	for (; mask != 0 && ret == 0; mask &= mask - 1) {
+		pin = u32_count_trailing_zeros(mask);
+		if (output & BIT(pin)) {
+			flags = GPIO_OUTPUT |
+				((value & BIT(pin)) ? GPIO_OUTPUT_INIT_HIGH : GPIO_OUTPUT_INIT_LOW);
+		} else {
+			flags = GPIO_INPUT;
+		}
+
+		ret = gpio_line_configure(data, pin, flags);
+	}
+
+	gb_transport_message_empty_response_send(req, gb_errno_to_op_result(ret), cport);
+}
+#endif
+
+#ifdef CONFIG_GREYBUS_GPIO_CAPTURE
+static void gb_gpio_capture_enable(uint16_t cport, struct gb_message *req,
+				   const struct gb_gpio_driver_data *data)
+{
+	const struct gpio_driver_config *cfg = (const struct gpio_driver_config *)data->dev->config;
+	const struct gb_gpio_capture_enable_request *request =
+		(const struct gb_gpio_capture_enable_request *)req->payload;
+	const struct gb_gpio_capture_enable_response resp_data = {
+		.clock_hz = sys_cpu_to_le32(sys_clock_hw_cycles_per_sec()),
+	};
+	struct gb_gpio_capture *cap = gpio_capture(data);
+	gpio_port_pins_t mask, pins;
+	k_spinlock_key_t key;
+	uint32_t latency_us;
+	uint16_t count;
+	int ret = 0;
+
+	if (gb_message_payload_len(req) < sizeof(*request)) {
+		LOG_ERR("dropping short message");
+		return gb_transport_message_empty_response_send(req, GB_OP_INVALID, cport);
+	}
+
+	mask = sys_le32_to_cpu(request->mask);
+	latency_us = sys_le32_to_cpu(request->latency_us);
+	count = sys_le16_to_cpu(request->count);
+	if (latency_us == 0) {
+		latency_us = CONFIG_GREYBUS_GPIO_CAPTURE_LATENCY_US;
+	}
+	if (count == 0) {
+		count = CONFIG_GREYBUS_GPIO_CAPTURE_COUNT;
+	}
+
+	if (mask == 0 || (mask & ~cfg->port_pin_mask)) {
+		LOG_ERR("Invalid GPIO pin mask: 0x%08x", mask);
+		return gb_transport_message_empty_response_send(req, GB_OP_INVALID, cport);
+	}
+	/* A count the buffer can't hold would only ever be sent on latency */
+	if (count > CONFIG_GREYBUS_GPIO_CAPTURE_COUNT ||
+	    count > CONFIG_GREYBUS_GPIO_CAPTURE_BUFFER_SIZE) {
+		LOG_ERR("Invalid capture count: %u", count);
+		return gb_transport_message_empty_response_send(req, GB_OP_INVALID, cport);
+	}
+
+	key = k_spin_lock(&cap->lock);
+	if (cap->mask) {
+		ret = -EBUSY;
+	} else {
+		cap->mask = mask;
+		cap->latency_us = latency_us;
+		cap->count = count;
+		cap->overruns = 0;
+	}
+	k_spin_unlock(&cap->lock, key);
+
+	if (ret < 0) {
+		LOG_ERR("Capture already enabled");
+		return gb_transport_message_empty_response_send(req, gb_errno_to_op_result(ret),
+								cport);
+	}
+
+	for (pins = mask; pins != 0 && ret == 0; pins &= pins - 1) {
+		ret = gpio_line_interrupt_configure(data, u32_count_trailing_zeros(pins),
+						    GPIO_INT_EDGE_BOTH);
+	}
+
+	if (ret < 0) {
+		gpio_capture_stop(data);
+		return gb_transport_message_empty_response_send(req, gb_errno_to_op_result(ret),
+								cport);
+	}
+
+	gb_transport_message_response_success_send(req, &resp_data, sizeof(resp_data), cport);
+}
+
+static void gb_gpio_capture_disable(uint16_t cport, struct gb_message *req,
+				    const struct gb_gpio_driver_data *data)
+{
+	struct gb_gpio_capture *cap = gpio_capture(data);
+	struct k_work_sync sync;
+
+	gpio_capture_stop(data);
+
+	/* Hand everything recorded to the host before the response */
+	while (gpio_capture_pending(cap)) {
+		k_work_reschedule_for_queue(&gpio_wq, &cap->work, K_NO_WAIT);
+		k_work_flush_delayable(&cap->work, &sync);
+	}
+
+	gb_transport_message_empty_response_send(req, GB_OP_SUCCESS, cport);
+}
+#endif
+
 static void gb_gpio_handler(const void *priv, struct gb_message *msg, uint16_t cport)
 {
 	const struct gb_gpio_driver_data *data = priv;
@@ -332,39 +1221,119 @@ static void gb_gpio_handler(const void *priv, struct gb_message *msg, uint16_t c
 		return gb_gpio_irq_mask(cport, msg, data);
 	case GB_GPIO_TYPE_IRQ_UNMASK:
 		return gb_gpio_irq_unmask(cport, msg, data);
+#ifdef CONFIG_GREYBUS_GPIO_PORT_OPS
+	case GB_GPIO_TYPE_PORT_GET:
+		return gb_gpio_port_get(cport, msg, data);
+	case GB_GPIO_TYPE_PORT_SET:
+		return gb_gpio_port_set(cport, msg, data);
+	case GB_GPIO_TYPE_PORT_DIRECTION:
+		return gb_gpio_port_direction(cport, msg, data);
+#endif
+#ifdef CONFIG_GREYBUS_GPIO_CAPTURE
+	case GB_GPIO_TYPE_CAPTURE_ENABLE:
+		return gb_gpio_capture_enable(cport, msg, data);
+	case GB_GPIO_TYPE_CAPTURE_DISABLE:
+		return gb_gpio_capture_disable(cport, msg, data);
+#endif
 	default:
 		LOG_ERR("Invalid type");
 		gb_transport_message_empty_response_send(msg, GB_OP_INVALID, cport);
 	}
 }
 
-struct gpio_irq_event_request_msg {
-	struct gb_operation_msg_hdr hdr;
-	struct gb_gpio_irq_event_request body;
-} __packed;
-
 static void gpio_callback_handler(const struct device *port, struct gpio_callback *cb,
 				  gpio_port_pins_t pins)
 {
-	int ret;
-	size_t i;
 	struct gb_gpio_driver_data *data = CONTAINER_OF(cb, struct gb_gpio_driver_data, cb);
-	uint8_t buf[sizeof(struct gpio_irq_event_request_msg)] = {0};
-	struct gpio_irq_event_request_msg *msg = (struct gpio_irq_event_request_msg *)buf;
+#ifdef CONFIG_GREYBUS_GPIO_CAPTURE
+	gpio_port_pins_t captured;
+#endif
 
-	msg->hdr.size = sys_cpu_to_le16(sizeof(buf));
-	msg->hdr.type = GB_GPIO_TYPE_IRQ_EVENT;
+	ARG_UNUSED(port);
 
-	for (i = 0; i < GPIO_MAX_PINS_PER_PORT && pins != 0; ++i, pins >>= 1) {
-		if (pins & 1) {
-			msg->body.which = i;
-			ret = gb_transport_message_send((const struct gb_message *)buf,
-							data->cport);
-			if (ret < 0) {
-				LOG_ERR("GPIO irq send failed: %d", ret);
-			}
-		}
+#ifdef CONFIG_GREYBUS_GPIO_CAPTURE
+	/* Captured lines are streamed, they do not raise IRQ events */
+	captured = pins & data->capture.mask;
+	if (captured) {
+		gpio_capture_record(data, captured);
+		pins &= ~captured;
+	}
+#endif
+
+#ifdef CONFIG_GREYBUS_GPIO_DEBOUNCE
+	pins = gpio_debounce_filter(data, pins);
+#endif
+
+	if (pins) {
+		gpio_irq_post(data, pins);
+	}
+}
+
+int gb_gpio_irq_stats(uint16_t cport, struct gb_gpio_irq_stats *stats)
+{
+	const struct gb_cport *cp = gb_cport_get(cport);
+	const struct gb_gpio_driver_data *data;
+	uint32_t failed;
+
+	if (!cp || cp->driver != &gb_gpio_driver) {
+		return -ENOENT;
+	}
+
+	data = cp->priv;
+	failed = atomic_get(&data->irq_failed);
+	stats->sent = atomic_get(&data->irq_sent) - failed;
+	stats->merged = atomic_get(&data->irq_merged);
+	stats->dropped = atomic_get(&data->irq_dropped) + failed;
+#ifdef CONFIG_GREYBUS_GPIO_DEBOUNCE
+	stats->debounced = atomic_get(&data->irq_debounced);
+#else
+	stats->debounced = 0;
+#endif
+
+	return 0;
+}
+
+int gb_gpio_capture_stats(uint16_t cport, struct gb_gpio_capture_stats *stats)
+{
+	const struct gb_cport *cp = gb_cport_get(cport);
+#ifdef CONFIG_GREYBUS_GPIO_CAPTURE
+	struct gb_gpio_capture *cap;
+	k_spinlock_key_t key;
+#endif
+
+	if (!cp || cp->driver != &gb_gpio_driver) {
+		return -ENOENT;
+	}
+
+#ifdef CONFIG_GREYBUS_GPIO_CAPTURE
+	cap = gpio_capture(cp->priv);
+	key = k_spin_lock(&cap->lock);
+	*stats = cap->stats;
+	k_spin_unlock(&cap->lock, key);
+
+	return 0;
+#else
+	ARG_UNUSED(stats);
+
+	return -ENOTSUP;
+#endif
+}
+
+int gb_gpio_cache_invalidate(uint16_t cport)
+{
+	const struct gb_cport *cp = gb_cport_get(cport);
+
+	if (!cp || cp->driver != &gb_gpio_driver) {
+		return -ENOENT;
 	}
+
+	if (!IS_ENABLED(CONFIG_GREYBUS_GPIO_CACHE)) {
+		return -ENOTSUP;
+	}
+
+	gpio_cache_drop(cp->priv, UINT32_MAX);
+
+	return 0;
 }
 
 static void gb_gpio_connected(const void *priv, uint16_t cport)
@@ -373,7 +1342,32 @@ static void gb_gpio_connected(const void *priv, uint16_t cport)
 	struct gb_gpio_driver_data *data = (struct gb_gpio_driver_data *)priv;
 	const struct gpio_driver_config *cfg = (const struct gpio_driver_config *)data->dev->config;
 
+	if (!gpio_wq_started) {
+		k_work_queue_start(&gpio_wq, gpio_wq_stack, K_THREAD_STACK_SIZEOF(gpio_wq_stack),
+				   CONFIG_GREYBUS_GPIO_IRQ_THREAD_PRIORITY, NULL);
+		k_thread_name_set(&gpio_wq.thread, "greybus_gpio");
+		gpio_wq_started = true;
+	}
+
 	data->cport = cport;
+#ifdef CONFIG_GREYBUS_TX_SCHED
+	/* IRQ events must not wait behind bulk traffic, responses keep their order with them */
+	gb_tx_sched_set_class(cport, GB_TX_CLASS_EVENT);
+#endif
+	/* Lines may have changed while disconnected */
+	gpio_cache_drop(data, UINT32_MAX);
+	atomic_clear(&data->irq_pending);
+	k_work_init_delayable(&data->irq_work, gpio_irq_work_handler);
+#ifdef CONFIG_GREYBUS_GPIO_DEBOUNCE
+	atomic_clear(&data->debounce.bouncing);
+	k_work_init_delayable(&data->debounce.work, gpio_debounce_work_handler);
+#endif
+#ifdef CONFIG_GREYBUS_GPIO_CAPTURE
+	data->capture.mask = 0;
+	data->capture.head = 0;
+	data->capture.queued = 0;
+	k_work_init_delayable(&data->capture.work, gpio_capture_work_handler);
+#endif
 	gpio_init_callback(&data->cb, gpio_callback_handler, cfg->port_pin_mask);
 
 	ret = gpio_add_callback(data->dev, &data->cb);
@@ -385,8 +1379,18 @@ static void gb_gpio_connected(const void *priv, uint16_t cport)
 static void gb_gpio_disconnected(const void *priv)
 {
 	struct gb_gpio_driver_data *data = (struct gb_gpio_driver_data *)priv;
+	struct k_work_sync sync;
 
 	gpio_remove_callback(data->dev, &data->cb);
+#ifdef CONFIG_GREYBUS_GPIO_CAPTURE
+	gpio_capture_stop(data);
+	k_work_cancel_delayable_sync(&data->capture.work, &sync);
+#endif
+#ifdef CONFIG_GREYBUS_GPIO_DEBOUNCE
+	k_work_cancel_delayable_sync(&data->debounce.work, &sync);
+#endif
+	k_work_cancel_delayable_sync(&data->irq_work, &sync);
+	atomic_clear(&data->irq_pending);
 }
 
 const struct gb_driver gb_gpio_driver = {
@@ -43,6 +43,9 @@ LOG_MODULE_REGISTER(greybus, CONFIG_GREYBUS_LOG_LEVEL);
 /* 2 msg per cport seems to be a good number */
 K_MSGQ_DEFINE(gb_rx_msgq, sizeof(struct gb_msg_with_cport), GREYBUS_CPORT_COUNT * 2, 1);
 
+/* Given whenever a transport queues a message or publishes to an RX ring */
+static K_SEM_DEFINE(gb_rx_signal, 0, 1);
+
 K_THREAD_STACK_DEFINE(gb_rx_thread_stack, 1280);
 static struct k_thread gb_rx_thread;
 
@@ -108,38 +111,79 @@ static void gb_process_msg(struct gb_message *msg, uint16_t cport)
 	cport_ptr->driver->op_handler(cport_ptr->priv, msg, cport);
 }
 
+void gb_rx_wake(void)
+{
+	k_sem_give(&gb_rx_signal);
+}
+
+void gb_rx_dispatch(const struct gb_transport_backend *backend, uint16_t cport,
+		    struct gb_message *msg)
+{
+	const struct gb_cport *cport_ptr;
+
+	gb_transport_rx_note(backend, cport, msg);
+
+#ifdef CONFIG_GREYBUS_AGGREGATION
+	if (cport == GB_AGGREGATE_CPORT) {
+		gb_aggregate_rx(msg);
+		return;
+	}
+#endif
+
+	cport_ptr = gb_cport_get(cport);
+	if (!cport_ptr || !cport_ptr->driver || !cport_ptr->driver->op_handler) {
+		LOG_ERR("Cport %u does not have a valid driver registered", cport);
+		gb_message_dealloc(msg);
+		return;
+	}
+
+	LOG_DBG("CPort: %d, Type: %d, Result: %d, Id: %u", cport, gb_message_type(msg),
+		msg->header.result, msg->header.operation_id);
+
+	gb_process_msg(msg, cport);
+}
+
 static void gb_pending_message_worker(void *p1, void *p2, void *p3)
 {
 	ARG_UNUSED(p1);
 	ARG_UNUSED(p2);
 	ARG_UNUSED(p3);
 
-	int ret;
 	struct gb_msg_with_cport msg;
 
 	while (1) {
-		ret = k_msgq_get(&gb_rx_msgq, &msg, K_FOREVER);
-		if (ret < 0) {
-			continue;
-		}
+		k_sem_take(&gb_rx_signal, K_FOREVER);
+
+		/* Frames published from interrupt context first, they skipped the queue already */
+		gb_rx_rings_drain();
 
-		LOG_DBG("CPort: %d, Type: %d, Result: %d, Id: %u", msg.cport,
-			gb_message_type(msg.msg), msg.msg->header.result,
-			msg.msg->header.operation_id);
+		while (k_msgq_get(&gb_rx_msgq, &msg, K_NO_WAIT) == 0) {
+			LOG_DBG("CPort: %d, Type: %d, Result: %d, Id: %u", msg.cport,
+				gb_message_type(msg.msg), msg.msg->header.result,
+				msg.msg->header.operation_id);
 
-		gb_process_msg(msg.msg, msg.cport);
+			gb_process_msg(msg.msg, msg.cport);
+		}
 	}
 }
 
 int greybus_rx_handler(uint16_t cport, struct gb_message *msg)
 {
+	const struct gb_cport *cport_ptr;
 	const struct gb_driver *drv;
 	const struct gb_msg_with_cport item = {
 		.cport = cport,
 		.msg = msg,
 	};
 
-	drv = gb_cport_get(cport)->driver;
+#ifdef CONFIG_GREYBUS_AGGREGATION
+	if (cport == GB_AGGREGATE_CPORT) {
+		return gb_aggregate_rx(msg);
+	}
+#endif
+
+	cport_ptr = gb_cport_get(cport);
+	drv = cport_ptr ? cport_ptr->driver : NULL;
 	if (!drv || !drv->op_handler) {
 		LOG_ERR("Cport %u does not have a valid driver registered", cport);
 		gb_message_dealloc(msg);
@@ -147,7 +191,15 @@ int greybus_rx_handler(uint16_t cport, struct gb_message *msg)
 	}
 	// LOG_HEXDUMP_DBG(data, size, "RX: ");
 
-	k_msgq_put(&gb_rx_msgq, &item, K_FOREVER);
+	/* The dispatcher itself queues messages unpacked from envelopes, it must not block */
+	if (k_msgq_put(&gb_rx_msgq, &item,
+		       k_current_get() == &gb_rx_thread ? K_NO_WAIT : K_FOREVER) < 0) {
+		LOG_ERR("RX queue full, dropping message on cport %u", cport);
+		gb_message_dealloc(msg);
+		return -ENOBUFS;
+	}
+
+	gb_rx_wake();
 
 	return 0;
 }
@@ -0,0 +1,306 @@
+/*
+ * Copyright (c) 2026 BeagleBoard.org
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Packs messages for any cports into envelope messages so that small messages share a single
+ * transport frame. Messages wait in an envelope until it is full or the latency budget runs out.
+ */
+
+#include "greybus_transport.h"
+#include <greybus/greybus.h>
+#include <greybus/greybus_protocols.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_REGISTER(greybus_aggregate, CONFIG_GREYBUS_LOG_LEVEL);
+
+#define ENVELOPE_HDR_SIZE sizeof(struct gb_operation_msg_hdr)
+
+/*
+ * One envelope is filled while the other one is being sent. The one being filled is only touched
+ * with the lock held, the one being sent only by the flush holding flush_lock. A sender in ISR
+ * that finds the envelope full seals it instead: the other envelope, if empty, becomes the one
+ * filled and the sealed one is sent first by the next flush.
+ */
+struct gb_envelope {
+	size_t len;
+	uint8_t buf[CONFIG_GREYBUS_AGGREGATION_MAX_SIZE] __aligned(4);
+};
+
+static struct gb_envelope envelopes[2];
+static uint8_t fill_idx;
+/* The envelope not being filled is full and waits for the flush */
+static bool sealed;
+static struct k_spinlock lock;
+static K_MUTEX_DEFINE(flush_lock);
+static atomic_t host_support = ATOMIC_INIT(0);
+static atomic_t tx_dropped = ATOMIC_INIT(0);
+static atomic_t rx_errors = ATOMIC_INIT(0);
+
+static void flush_work_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(flush_work, flush_work_handler);
+
+static size_t envelope_limit(void)
+{
+	struct gb_transport_caps caps;
+
+	gb_transport_get_caps(&caps);
+
+	return MIN(caps.max_message_size, CONFIG_GREYBUS_AGGREGATION_MAX_SIZE);
+}
+
+static bool envelope_append(const struct gb_message *msg, uint16_t cport)
+{
+	const size_t entry_len = sizeof(__le16) + gb_message_len(msg);
+	const size_t limit = envelope_limit();
+	struct gb_envelope *env;
+	k_spinlock_key_t key;
+	bool first;
+
+	key = k_spin_lock(&lock);
+	env = &envelopes[fill_idx];
+
+	if (ENVELOPE_HDR_SIZE + env->len + entry_len > limit) {
+		k_spin_unlock(&lock, key);
+		return false;
+	}
+
+	first = (env->len == 0);
+	sys_put_le16(cport, &env->buf[ENVELOPE_HDR_SIZE + env->len]);
+	memcpy(&env->buf[ENVELOPE_HDR_SIZE + env->len + sizeof(__le16)], msg, gb_message_len(msg));
+	env->len += entry_len;
+	k_spin_unlock(&lock, key);
+
+	/* The latency budget starts with the first message */
+	if (first) {
+		k_work_schedule(&flush_work, K_USEC(CONFIG_GREYBUS_AGGREGATION_LATENCY_US));
+	}
+
+	return true;
+}
+
+/*
+ * Check that no envelope is being filled or sent.
+ */
+static bool envelope_idle(void)
+{
+	k_spinlock_key_t key;
+	bool idle;
+
+	key = k_spin_lock(&lock);
+	idle = (envelopes[0].len == 0 && envelopes[1].len == 0);
+	k_spin_unlock(&lock, key);
+
+	return idle;
+}
+
+/*
+ * Seal the envelope being filled so that a message from ISR can go into the other one. Only
+ * possible while the other one is neither being sent nor sealed already.
+ */
+static bool envelope_seal(void)
+{
+	k_spinlock_key_t key;
+	bool ret = false;
+
+	key = k_spin_lock(&lock);
+	if (!sealed && envelopes[fill_idx].len > 0 && envelopes[fill_idx ^ 1].len == 0) {
+		sealed = true;
+		fill_idx ^= 1;
+		ret = true;
+	}
+	k_spin_unlock(&lock, key);
+
+	return ret;
+}
+
+/*
+ * Take the next envelope to send, the sealed one before the one being filled.
+ */
+static struct gb_envelope *envelope_take(void)
+{
+	struct gb_envelope *env = NULL;
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&lock);
+	if (sealed) {
+		env = &envelopes[fill_idx ^ 1];
+		sealed = false;
+	} else if (envelopes[fill_idx].len > 0) {
+		env = &envelopes[fill_idx];
+		fill_idx ^= 1;
+	}
+	k_spin_unlock(&lock, key);
+
+	return env;
+}
+
+static void envelope_send(struct gb_envelope *env)
+{
+	struct gb_message *msg;
+	k_spinlock_key_t key;
+	int ret;
+
+	msg = (struct gb_message *)env->buf;
+	msg->header.size = sys_cpu_to_le16(ENVELOPE_HDR_SIZE + env->len);
+	msg->header.operation_id = 0;
+	msg->header.type = GB_AGGREGATE_TYPE_ENVELOPE;
+	msg->header.result = 0;
+	msg->header.pad[0] = 0;
+	msg->header.pad[1] = 0;
+
+	ret = gb_transport_get_backend()->send(GB_AGGREGATE_CPORT, msg);
+	if (ret < 0) {
+		LOG_ERR("Failed to send envelope: %d", ret);
+	}
+
+	key = k_spin_lock(&lock);
+	env->len = 0;
+	k_spin_unlock(&lock, key);
+}
+
+/*
+ * Send the sealed envelope and the one being filled, if any. Must be called with flush_lock
+ * held.
+ */
+static void envelope_flush(void)
+{
+	struct gb_envelope *env;
+
+	for (size_t i = 0; i < ARRAY_SIZE(envelopes); i++) {
+		env = envelope_take();
+		if (!env) {
+			return;
+		}
+		envelope_send(env);
+	}
+}
+
+static void flush_work_handler(struct k_work *work)
+{
+	ARG_UNUSED(work);
+
+	k_mutex_lock(&flush_lock, K_FOREVER);
+	envelope_flush();
+	k_mutex_unlock(&flush_lock);
+}
+
+int gb_aggregate_send(const struct gb_message *msg, uint16_t cport)
+{
+	const struct gb_transport_backend *backend = gb_transport_get_backend();
+	int ret;
+
+	if (!atomic_get(&host_support)) {
+		return backend->send(cport, msg);
+	}
+
+	if (envelope_append(msg, cport)) {
+		return 0;
+	}
+
+	/*
+	 * Can't wait for the flush here. Hand the full envelope to the flush and retry with the
+	 * other one. Sending directly is only safe while no envelope is being filled or sent,
+	 * otherwise the message would overtake the ones already in it.
+	 */
+	if (k_is_in_isr()) {
+		if (envelope_seal()) {
+			k_work_reschedule(&flush_work, K_NO_WAIT);
+			if (envelope_append(msg, cport)) {
+				return 0;
+			}
+		}
+		if (envelope_idle()) {
+			return backend->send(cport, msg);
+		}
+		k_work_reschedule(&flush_work, K_NO_WAIT);
+		atomic_inc(&tx_dropped);
+		return -EAGAIN;
+	}
+
+	/* Send what is pending first to keep the order, then retry with an empty envelope */
+	k_mutex_lock(&flush_lock, K_FOREVER);
+	envelope_flush();
+	ret = envelope_append(msg, cport) ? 0 : backend->send(cport, msg);
+	k_mutex_unlock(&flush_lock);
+
+	return ret;
+}
+
+int gb_aggregate_rx(struct gb_message *msg)
+{
+	const size_t len = gb_message_payload_len(msg);
+	const struct gb_aggregate_entry *entry;
+	struct gb_message *entry_msg;
+	size_t entry_len;
+	size_t offset = 0;
+	uint16_t cport;
+	int ret = 0;
+
+	if (gb_message_type(msg) != GB_AGGREGATE_TYPE_ENVELOPE) {
+		LOG_ERR("Invalid envelope type %u", gb_message_type(msg));
+		gb_message_dealloc(msg);
+		return -EINVAL;
+	}
+
+	/* Host understands envelopes, use them in the other direction too */
+	atomic_set(&host_support, 1);
+
+	while (offset < len) {
+		entry = (const struct gb_aggregate_entry *)&msg->payload[offset];
+
+		if (len - offset < sizeof(*entry)) {
+			LOG_ERR("Truncated envelope entry at %zu", offset);
+			ret = -EINVAL;
+			break;
+		}
+
+		entry_len = sizeof(entry->cport) + gb_hdr_message_len(&entry->hdr);
+		cport = sys_le16_to_cpu(entry->cport);
+		if (gb_hdr_message_len(&entry->hdr) < sizeof(entry->hdr) ||
+		    entry_len > len - offset || cport == GB_AGGREGATE_CPORT) {
+			LOG_ERR("Invalid envelope entry at %zu", offset);
+			ret = -EINVAL;
+			break;
+		}
+
+		entry_msg = gb_message_alloc(gb_hdr_payload_len(&entry->hdr), entry->hdr.type,
+					     sys_le16_to_cpu(entry->hdr.operation_id),
+					     entry->hdr.result);
+		if (!entry_msg) {
+			LOG_ERR("Failed to allocate envelope entry at %zu", offset);
+			ret = -ENOMEM;
+			break;
+		}
+
+		memcpy(entry_msg->payload, entry->payload, gb_message_payload_len(entry_msg));
+		if (greybus_rx_handler(cport, entry_msg) < 0) {
+			/* The entry is lost, the rest of the envelope is still good */
+			LOG_ERR("Failed to submit envelope entry for cport %u", cport);
+			atomic_inc(&rx_errors);
+		}
+
+		offset += entry_len;
+	}
+
+	if (ret < 0) {
+		atomic_inc(&rx_errors);
+	}
+
+	gb_message_dealloc(msg);
+
+	return ret;
+}
+
+void gb_aggregate_reset(void)
+{
+	atomic_set(&host_support, 0);
+}
+
+void gb_aggregate_stats_get(struct gb_aggregate_stats *stats)
+{
+	stats->tx_dropped = atomic_get(&tx_dropped);
+	stats->rx_errors = atomic_get(&rx_errors);
+}
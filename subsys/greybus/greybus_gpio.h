@@ -7,15 +7,96 @@
 #ifndef _GREYBUS_GPIO_H_
 #define _GREYBUS_GPIO_H_
 
+#include <zephyr/kernel.h>
 #include <zephyr/drivers/gpio.h>
+#include <greybus/gpio.h>
 
 extern const struct gb_driver gb_gpio_driver;
 
+#ifdef CONFIG_GREYBUS_GPIO_DEBOUNCE
+struct gb_gpio_debounce {
+	struct k_work_delayable work;
+	/* Lines waiting to settle, set from ISR */
+	atomic_t bouncing;
+	/* Uptime in ticks, truncated to 32 bits, at which a bouncing line is settled */
+	uint32_t settle[GPIO_MAX_PINS_PER_PORT];
+	/* Debounce time requested by the host */
+	uint16_t usec[GPIO_MAX_PINS_PER_PORT];
+	/* GB_GPIO_IRQ_TYPE_* of each line */
+	uint8_t type[GPIO_MAX_PINS_PER_PORT];
+	/* Lines with the interrupt unmasked */
+	gpio_port_pins_t enabled;
+	/* Last settled level of each line */
+	gpio_port_value_t level;
+};
+#endif
+
+#ifdef CONFIG_GREYBUS_GPIO_CACHE
+struct gb_gpio_cache {
+	struct k_spinlock lock;
+	/* Lines with known direction, and level for outputs */
+	gpio_port_pins_t valid;
+	gpio_port_pins_t output;
+	gpio_port_value_t value;
+	/* Lines with known interrupt configuration */
+	gpio_port_pins_t irq_valid;
+	gpio_flags_t irq[GPIO_MAX_PINS_PER_PORT];
+};
+#endif
+
+#ifdef CONFIG_GREYBUS_GPIO_CAPTURE
+struct gb_gpio_capture_entry {
+	/* Cycle counter at the edge */
+	uint64_t timestamp;
+	uint8_t which;
+	uint8_t value;
+};
+
+struct gb_gpio_capture {
+	/* IRQ setup the host asked for, applied again once a line is no longer captured */
+	gpio_flags_t irq_flags[GPIO_MAX_PINS_PER_PORT];
+	/* Protects everything below, taken from ISR */
+	struct k_spinlock lock;
+	struct k_work_delayable work;
+	/* Lines captured, 0 while capture is off */
+	gpio_port_pins_t mask;
+	uint32_t latency_us;
+	/* Records per capture event */
+	uint16_t count;
+	uint16_t head;
+	uint16_t queued;
+	/* Overruns not yet reported to the host */
+	uint32_t overruns;
+	struct gb_gpio_capture_stats stats;
+	struct gb_gpio_capture_entry ring[CONFIG_GREYBUS_GPIO_CAPTURE_BUFFER_SIZE];
+};
+#endif
+
 struct gb_gpio_driver_data {
 	struct gpio_callback cb;
 	const struct device *const dev;
 	uint16_t cport;
 	uint8_t ngpios;
+	/* Lines with an IRQ event to send, set from ISR */
+	atomic_t irq_pending;
+	struct k_work_delayable irq_work;
+	/* No batch is sent before, see CONFIG_GREYBUS_GPIO_IRQ_INTERVAL_US */
+	k_timepoint_t irq_holdoff;
+	atomic_t irq_sent;
+	atomic_t irq_merged;
+	atomic_t irq_dropped;
+	/* Queued IRQ events the backend failed to send, see CONFIG_GREYBUS_TX_SCHED */
+	atomic_t irq_failed;
+#ifdef CONFIG_GREYBUS_GPIO_DEBOUNCE
+	atomic_t irq_debounced;
+	struct gb_gpio_debounce debounce;
+#endif
+#ifdef CONFIG_GREYBUS_GPIO_CAPTURE
+	struct gb_gpio_capture capture;
+#endif
+#ifdef CONFIG_GREYBUS_GPIO_CACHE
+	struct gb_gpio_cache cache;
+#endif
 };
 
 #endif // _GREYBUS_GPIO_H_
@@ -29,6 +29,125 @@ int gb_notify(uint16_t cport, enum gb_event event);
 
 uint8_t gb_errno_to_op_result(int err);
 
+/**
+ * Enter an interface read section. Interfaces looked up or reached through connections stay
+ * valid until the section is left, gb_interface_remove() waits for it. Never blocks, can be
+ * nested and used from ISR.
+ *
+ * @return key to pass to gb_interface_read_unlock()
+ */
+int gb_interface_read_lock(void);
+
+/**
+ * Leave an interface read section.
+ */
+void gb_interface_read_unlock(int key);
+
+struct gb_interface;
+
+/**
+ * Keep an interface found in a read section valid after leaving it, e.g. across a write that
+ * can block. gb_interface_remove() waits for the reference to be dropped.
+ */
+void gb_interface_ref(struct gb_interface *intf);
+
+/**
+ * Drop a reference taken with gb_interface_ref().
+ */
+void gb_interface_unref(struct gb_interface *intf);
+
+#ifdef CONFIG_GREYBUS_APBRIDGE_TX_QUEUE
+struct gb_interface;
+
+/**
+ * Allocate the TX queue of an interface.
+ */
+int gb_apbridge_txq_attach(struct gb_interface *intf);
+
+/**
+ * Close the TX queue of an interface, dropping queued messages. Must be called before waiting
+ * for readers on removal.
+ */
+void gb_apbridge_txq_close(struct gb_interface *intf);
+
+/**
+ * Free the TX queue of an interface, closing it first if needed.
+ */
+void gb_apbridge_txq_release(struct gb_interface *intf);
+
+/**
+ * Queue a message for the interface. Takes ownership of the message.
+ *
+ * @return 0 if queued, -ENOBUFS if the queue stayed full
+ */
+int gb_apbridge_txq_write(struct gb_interface *intf, struct gb_message *msg, uint16_t cport);
+#endif
+
+#ifdef CONFIG_GREYBUS_APBRIDGE_CREDITS
+struct gb_interface;
+
+/**
+ * Return the credit of a message handed to the interface write callback, unless the controller
+ * returns it itself.
+ *
+ * @param ret: Result of the write callback
+ */
+void gb_apbridge_write_done(struct gb_interface *intf, uint16_t cport, int ret);
+#endif
+
+#ifdef CONFIG_GREYBUS_TIMESYNC
+/**
+ * Enable TimeSync. The next strobe sets the frame time, it and the following ones are latched.
+ *
+ * @param count: Number of strobes to latch, at most GB_TIMESYNC_MAX_STROBES
+ * @param frame_time: Frame time at the first strobe
+ * @param refclk: Frame time ticks per second
+ *
+ * @return 0 on success, -EINVAL for invalid parameters
+ */
+int gb_timesync_enable(uint8_t count, uint64_t frame_time, uint32_t refclk);
+
+/**
+ * Disable TimeSync. Strobes are ignored, the frame time keeps running.
+ */
+void gb_timesync_disable(void);
+
+/**
+ * Copy the frame times latched since TimeSync was enabled.
+ *
+ * @param frame_time: Room for GB_TIMESYNC_MAX_STROBES frame times
+ *
+ * @return number of latched strobes
+ */
+size_t gb_timesync_get_strobes(uint64_t *frame_time);
+
+/**
+ * Correct the frame time by the mean difference between the authoritative and the latched
+ * frame times of the strobes.
+ *
+ * @param frame_time: Authoritative frame time of each strobe
+ *
+ * @return 0 on success, -EAGAIN if no strobe was latched
+ */
+int gb_timesync_authoritative(const uint64_t *frame_time);
+#endif
+
+/**
+ * Wake the dispatcher thread.
+ */
+void gb_rx_wake(void);
+
+/**
+ * Process a received message on the dispatcher thread. Takes ownership of the message.
+ */
+void gb_rx_dispatch(const struct gb_transport_backend *backend, uint16_t cport,
+		    struct gb_message *msg);
+
+/**
+ * Consume everything published to the registered RX rings. Called from the dispatcher thread.
+ */
+void gb_rx_rings_drain(void);
+
 /**
  * Initialize greybus.
  *
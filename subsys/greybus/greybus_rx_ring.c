@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2026 BeagleBoard.org
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Lock-free single producer, single consumer rings from transport interrupt handlers into the
+ * dispatcher. Records are stored contiguously, prefixed by their 32 bit length. A record that
+ * does not fit before the end of the buffer is placed at its start, with a wrap marker left in
+ * the unused tail.
+ */
+
+#include "greybus_transport.h"
+#include "greybus_internal.h"
+#include <greybus/greybus.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_REGISTER(greybus_rx_ring, CONFIG_GREYBUS_LOG_LEVEL);
+
+#define GB_RX_RING_WRAP UINT32_MAX
+/* One ring per transport backend at most */
+#define GB_RX_RING_MAX  8
+
+static struct gb_rx_ring *rings[GB_RX_RING_MAX];
+static atomic_t ring_count = ATOMIC_INIT(0);
+
+int gb_rx_ring_register(struct gb_rx_ring *ring)
+{
+	const atomic_val_t idx = atomic_get(&ring_count);
+
+	for (atomic_val_t i = 0; i < idx; i++) {
+		if (rings[i] == ring) {
+			return 0;
+		}
+	}
+
+	if (idx >= ARRAY_SIZE(rings)) {
+		return -ENOMEM;
+	}
+
+	rings[idx] = ring;
+	atomic_inc(&ring_count);
+
+	return 0;
+}
+
+void *gb_rx_ring_claim(struct gb_rx_ring *ring, size_t len)
+{
+	const size_t need = GB_RX_RING_RECORD_SIZE(len);
+	const size_t head = atomic_get(&ring->head);
+	const size_t tail = atomic_get(&ring->tail);
+	size_t pos;
+
+	/* head never catches up with tail, head == tail means empty */
+	if (head >= tail) {
+		if (ring->size - head > need || (ring->size - head == need && tail != 0)) {
+			pos = head;
+		} else if (tail > need) {
+			/* Invisible to the consumer until the record is committed */
+			UNALIGNED_PUT(GB_RX_RING_WRAP, (uint32_t *)&ring->buf[head]);
+			pos = 0;
+		} else {
+			return NULL;
+		}
+	} else if (tail - head > need) {
+		pos = head;
+	} else {
+		return NULL;
+	}
+
+	ring->claim = pos;
+
+	return &ring->buf[pos + sizeof(uint32_t)];
+}
+
+void gb_rx_ring_commit(struct gb_rx_ring *ring, size_t len)
+{
+	size_t head = ring->claim + GB_RX_RING_RECORD_SIZE(len);
+
+	if (head == ring->size) {
+		head = 0;
+	}
+
+	UNALIGNED_PUT(len, (uint32_t *)&ring->buf[ring->claim]);
+	/* Publishes the record, atomic_set() is a full barrier */
+	atomic_set(&ring->head, head);
+
+	gb_rx_wake();
+}
+
+static void record_dispatch(const struct gb_rx_ring *ring, const uint8_t *data, size_t len)
+{
+	const struct gb_operation_msg_hdr *hdr;
+	struct gb_message *msg;
+	size_t frame_len;
+	uint16_t cport;
+
+	while (len > 0) {
+		hdr = (const struct gb_operation_msg_hdr *)&data[sizeof(__le16)];
+
+		if (len < sizeof(__le16) + sizeof(*hdr)) {
+			LOG_ERR("Truncated frame, %zu bytes left", len);
+			return;
+		}
+
+		frame_len = sizeof(__le16) + gb_hdr_message_len(hdr);
+		if (gb_hdr_message_len(hdr) < sizeof(*hdr) || frame_len > len) {
+			LOG_ERR("Invalid message size %u", gb_hdr_message_len(hdr));
+			return;
+		}
+
+		cport = sys_get_le16(data);
+		msg = gb_message_alloc(gb_hdr_payload_len(hdr), hdr->type,
+				       sys_le16_to_cpu(hdr->operation_id), hdr->result);
+		if (!msg) {
+			LOG_ERR("Failed to allocate greybus message");
+			return;
+		}
+
+		memcpy(msg->payload, &data[sizeof(__le16) + sizeof(*hdr)],
+		       gb_message_payload_len(msg));
+		gb_rx_dispatch(ring->backend, cport, msg);
+
+		data += frame_len;
+		len -= frame_len;
+	}
+}
+
+static void ring_drain(struct gb_rx_ring *ring)
+{
+	size_t tail = atomic_get(&ring->tail);
+	const size_t head = atomic_get(&ring->head);
+	uint32_t len;
+
+	while (tail != head) {
+		len = UNALIGNED_GET((uint32_t *)&ring->buf[tail]);
+		if (len == GB_RX_RING_WRAP) {
+			tail = 0;
+			continue;
+		}
+
+		record_dispatch(ring, &ring->buf[tail + sizeof(uint32_t)], len);
+
+		tail += GB_RX_RING_RECORD_SIZE(len);
+		if (tail == ring->size) {
+			tail = 0;
+		}
+
+		/* Hands the space back to the producer */
+		atomic_set(&ring->tail, tail);
+	}
+}
+
+void gb_rx_rings_drain(void)
+{
+	const atomic_val_t count = atomic_get(&ring_count);
+
+	for (atomic_val_t i = 0; i < count; i++) {
+		ring_drain(rings[i]);
+	}
+}
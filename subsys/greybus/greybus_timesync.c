@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2026 BeagleBoard.org
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Greybus TimeSync. Frame time counts ticks of the reference clock announced by the AP and is
+ * derived from the kernel cycle counter. Enabling TimeSync announces a number of strobes, the
+ * first one sets the frame time to the value given by the AP. The frame time of every strobe
+ * is latched, the authoritative frame times sent by the AP afterwards correct the local frame
+ * time by the mean difference.
+ */
+
+#include <greybus/timesync.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <greybus/greybus_protocols.h>
+#include "greybus_internal.h"
+
+LOG_MODULE_REGISTER(greybus_timesync, CONFIG_GREYBUS_LOG_LEVEL);
+
+static struct {
+	struct k_spinlock lock;
+	/* Frame time at cycle_base */
+	uint64_t frame_base;
+	uint64_t cycle_base;
+	uint32_t refclk;
+	/* Frame time the first strobe is set to */
+	uint64_t initial;
+	uint64_t strobes[GB_TIMESYNC_MAX_STROBES];
+	uint8_t count;
+	uint8_t latched;
+	bool enabled;
+	uint64_t last_event;
+	bool has_event;
+} ts = {
+	.refclk = CONFIG_GREYBUS_TIMESYNC_REFCLK,
+};
+
+/* Must be called with the lock held */
+static uint64_t frame_time_at(uint64_t cycles)
+{
+	const uint64_t hz = sys_clock_hw_cycles_per_sec();
+	const uint64_t delta = cycles - ts.cycle_base;
+
+	/* Split up so that the multiplication can't overflow */
+	return ts.frame_base + (delta / hz) * ts.refclk + (delta % hz) * ts.refclk / hz;
+}
+
+uint64_t gb_timesync_get_frame_time(void)
+{
+	const k_spinlock_key_t key = k_spin_lock(&ts.lock);
+	const uint64_t frame_time = frame_time_at(k_cycle_get_64());
+
+	k_spin_unlock(&ts.lock, key);
+
+	return frame_time;
+}
+
+void gb_timesync_strobe(void)
+{
+	const uint64_t cycles = k_cycle_get_64();
+	const k_spinlock_key_t key = k_spin_lock(&ts.lock);
+
+	if (!ts.enabled) {
+		goto unlock;
+	}
+
+	if (ts.latched == 0) {
+		ts.frame_base = ts.initial;
+		ts.cycle_base = cycles;
+	}
+
+	ts.last_event = frame_time_at(cycles);
+	ts.has_event = true;
+
+	if (ts.latched < ts.count) {
+		ts.strobes[ts.latched++] = ts.last_event;
+	}
+
+unlock:
+	k_spin_unlock(&ts.lock, key);
+}
+
+int gb_timesync_get_last_event(uint64_t *frame_time)
+{
+	const k_spinlock_key_t key = k_spin_lock(&ts.lock);
+	int ret = 0;
+
+	if (ts.has_event) {
+		*frame_time = ts.last_event;
+	} else {
+		ret = -ENODATA;
+	}
+
+	k_spin_unlock(&ts.lock, key);
+
+	return ret;
+}
+
+int gb_timesync_enable(uint8_t count, uint64_t frame_time, uint32_t refclk)
+{
+	const uint64_t cycles = k_cycle_get_64();
+	k_spinlock_key_t key;
+
+	if (count == 0 || count > GB_TIMESYNC_MAX_STROBES || refclk == 0) {
+		return -EINVAL;
+	}
+
+	key = k_spin_lock(&ts.lock);
+
+	/* Keep the frame time continuous until the first strobe */
+	ts.frame_base = frame_time_at(cycles);
+	ts.cycle_base = cycles;
+	ts.refclk = refclk;
+	ts.initial = frame_time;
+	ts.count = count;
+	ts.latched = 0;
+	ts.has_event = false;
+	ts.enabled = true;
+
+	k_spin_unlock(&ts.lock, key);
+
+	LOG_DBG("Enabled, %u strobes, refclk %u Hz", count, refclk);
+
+	return 0;
+}
+
+void gb_timesync_disable(void)
+{
+	const k_spinlock_key_t key = k_spin_lock(&ts.lock);
+
+	ts.enabled = false;
+
+	k_spin_unlock(&ts.lock, key);
+}
+
+size_t gb_timesync_get_strobes(uint64_t *frame_time)
+{
+	const k_spinlock_key_t key = k_spin_lock(&ts.lock);
+	const size_t latched = ts.latched;
+
+	memcpy(frame_time, ts.strobes, latched * sizeof(frame_time[0]));
+
+	k_spin_unlock(&ts.lock, key);
+
+	return latched;
+}
+
+int gb_timesync_authoritative(const uint64_t *frame_time)
+{
+	k_spinlock_key_t key;
+	int64_t offset = 0;
+	int ret = 0;
+	size_t i;
+
+	key = k_spin_lock(&ts.lock);
+
+	if (!ts.enabled || ts.latched == 0) {
+		ret = -EAGAIN;
+		goto unlock;
+	}
+
+	for (i = 0; i < ts.latched; i++) {
+		offset += (int64_t)(frame_time[i] - ts.strobes[i]);
+	}
+	offset /= (int64_t)ts.latched;
+
+	ts.frame_base += offset;
+	if (ts.has_event) {
+		ts.last_event += offset;
+	}
+	for (i = 0; i < ts.latched; i++) {
+		ts.strobes[i] += offset;
+	}
+
+unlock:
+	k_spin_unlock(&ts.lock, key);
+
+	if (ret == 0) {
+		LOG_DBG("Frame time adjusted by %lld", (long long)offset);
+	}
+
+	return ret;
+}
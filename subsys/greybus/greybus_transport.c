@@ -12,15 +12,428 @@
 
 LOG_MODULE_REGISTER(greybus_transport_common, CONFIG_GREYBUS_LOG_LEVEL);
 
+int gb_transport_message_xmit(const struct gb_message *msg, uint16_t cport)
+{
+#ifdef CONFIG_GREYBUS_AGGREGATION
+	return gb_aggregate_send(msg, cport);
+#else
+	return gb_transport_get_backend()->send(cport, msg);
+#endif
+}
+
+int gb_transport_message_send_tracked(const struct gb_message *msg, uint16_t cport,
+				      atomic_t *failed)
+{
+	int retval;
+
+#ifdef CONFIG_GREYBUS_TX_SCHED
+	retval = gb_tx_sched_enqueue(msg, cport, failed);
+#else
+	ARG_UNUSED(failed);
+	retval = gb_transport_message_xmit(msg, cport);
+#endif
+	if (retval) {
+		LOG_ERR("Greybus backend failed to send: error %d", retval);
+	}
+
+	return retval;
+}
+
 int gb_transport_message_send(const struct gb_message *msg, uint16_t cport)
 {
+	return gb_transport_message_send_tracked(msg, cport, NULL);
+}
+
+int gb_transport_message_send_owned(struct gb_message *msg, uint16_t cport)
+{
+	const struct gb_transport_backend *backend = gb_transport_get_backend();
 	int retval;
-	const struct gb_transport_backend *transport_backend = gb_transport_get_backend();
 
-	retval = transport_backend->send(cport, msg);
+	/* The scheduler and envelopes keep their own copy */
+	if (IS_ENABLED(CONFIG_GREYBUS_TX_SCHED) || IS_ENABLED(CONFIG_GREYBUS_AGGREGATION) ||
+	    !backend->send_owned) {
+		retval = gb_transport_message_send(msg, cport);
+		gb_message_dealloc(msg);
+		return retval;
+	}
+
+	retval = backend->send_owned(cport, msg);
 	if (retval) {
 		LOG_ERR("Greybus backend failed to send: error %d", retval);
 	}
 
 	return retval;
 }
+
+static void backend_get_caps(const struct gb_transport_backend *backend,
+			     struct gb_transport_caps *caps)
+{
+	/* Limited only by the 16 bit size field of the operation header */
+	caps->max_message_size = UINT16_MAX;
+	caps->preferred_message_size = UINT16_MAX;
+	caps->flags = 0;
+
+	if (backend->get_caps) {
+		backend->get_caps(caps);
+	}
+
+	caps->preferred_message_size = MIN(caps->preferred_message_size, caps->max_message_size);
+}
+
+void gb_transport_get_caps(struct gb_transport_caps *caps)
+{
+	backend_get_caps(gb_transport_get_backend(), caps);
+}
+
+size_t gb_transport_chunk_size(size_t overhead, size_t limit)
+{
+	const size_t hdr_len = sizeof(struct gb_operation_msg_hdr) + overhead;
+	struct gb_transport_caps caps;
+
+	gb_transport_get_caps(&caps);
+	if (caps.preferred_message_size <= hdr_len) {
+		return 0;
+	}
+
+	return MIN(caps.preferred_message_size - hdr_len, limit);
+}
+
+#ifdef CONFIG_GREYBUS_XPORT_MULTI
+
+#include <zephyr/kernel.h>
+#include <greybus-utils/manifest.h>
+
+extern const struct gb_transport_backend GB_TRANSPORT_BACKEND(tcpip);
+extern const struct gb_transport_backend GB_TRANSPORT_BACKEND(dummy);
+extern const struct gb_transport_backend GB_TRANSPORT_BACKEND(apbridge);
+extern const struct gb_transport_backend GB_TRANSPORT_BACKEND(i2c);
+extern const struct gb_transport_backend GB_TRANSPORT_BACKEND(uart);
+extern const struct gb_transport_backend GB_TRANSPORT_BACKEND(spi);
+extern const struct gb_transport_backend GB_TRANSPORT_BACKEND(ipc);
+extern const struct gb_transport_backend GB_TRANSPORT_BACKEND(ble);
+
+struct gb_transport_entry {
+	const char *name;
+	const struct gb_transport_backend *backend;
+};
+
+#define GB_TRANSPORT_ENTRY(_name) {.name = #_name, .backend = &GB_TRANSPORT_BACKEND(_name)}
+
+/* Active backend first, followed by standby backends in order of preference */
+static const struct gb_transport_entry backends[] = {
+#if defined(CONFIG_GREYBUS_XPORT_TCPIP)
+	GB_TRANSPORT_ENTRY(tcpip),
+#elif defined(CONFIG_GREYBUS_XPORT_DUMMY)
+	GB_TRANSPORT_ENTRY(dummy),
+#elif defined(CONFIG_GREYBUS_XPORT_APBRIDGE)
+	GB_TRANSPORT_ENTRY(apbridge),
+#elif defined(CONFIG_GREYBUS_XPORT_I2C)
+	GB_TRANSPORT_ENTRY(i2c),
+#elif defined(CONFIG_GREYBUS_XPORT_UART)
+	GB_TRANSPORT_ENTRY(uart),
+#elif defined(CONFIG_GREYBUS_XPORT_SPI)
+	GB_TRANSPORT_ENTRY(spi),
+#elif defined(CONFIG_GREYBUS_XPORT_IPC)
+	GB_TRANSPORT_ENTRY(ipc),
+#elif defined(CONFIG_GREYBUS_XPORT_BLE)
+	GB_TRANSPORT_ENTRY(ble),
+#endif
+#ifdef CONFIG_GREYBUS_XPORT_STANDBY_TCPIP
+	GB_TRANSPORT_ENTRY(tcpip),
+#endif
+#ifdef CONFIG_GREYBUS_XPORT_STANDBY_I2C
+	GB_TRANSPORT_ENTRY(i2c),
+#endif
+#ifdef CONFIG_GREYBUS_XPORT_STANDBY_UART
+	GB_TRANSPORT_ENTRY(uart),
+#endif
+#ifdef CONFIG_GREYBUS_XPORT_STANDBY_SPI
+	GB_TRANSPORT_ENTRY(spi),
+#endif
+#ifdef CONFIG_GREYBUS_XPORT_STANDBY_IPC
+	GB_TRANSPORT_ENTRY(ipc),
+#endif
+#ifdef CONFIG_GREYBUS_XPORT_STANDBY_BLE
+	GB_TRANSPORT_ENTRY(ble),
+#endif
+};
+
+BUILD_ASSERT(ARRAY_SIZE(backends) <= UINT8_MAX, "Too many transport backends");
+
+static struct k_spinlock router_lock;
+static struct gb_transport_stats stats[ARRAY_SIZE(backends)];
+/* Backend index + 1 of the backend that last delivered a message on the cport, 0 if none */
+static uint8_t routes[GREYBUS_CPORT_COUNT];
+
+static int backend_index(const struct gb_transport_backend *backend)
+{
+	size_t i;
+
+	for (i = 0; i < ARRAY_SIZE(backends); i++) {
+		if (backends[i].backend == backend) {
+			return i;
+		}
+	}
+
+	return -ENOENT;
+}
+
+/*
+ * Errors that mean the link itself is gone, as opposed to a problem with the message.
+ */
+static bool is_link_error(int err)
+{
+	switch (err) {
+	case -ENOTCONN:
+	case -ECONNRESET:
+	case -EPIPE:
+	case -EIO:
+	case -ETIMEDOUT:
+	case -ENODEV:
+		return true;
+	default:
+		return false;
+	}
+}
+
+void gb_transport_rx_note(const struct gb_transport_backend *backend, uint16_t cport,
+			  const struct gb_message *msg)
+{
+	const int idx = backend_index(backend);
+	k_spinlock_key_t key;
+
+	if (idx < 0) {
+		return;
+	}
+
+	key = k_spin_lock(&router_lock);
+	stats[idx].rx_messages++;
+	stats[idx].rx_bytes += gb_message_len(msg);
+	stats[idx].up = true;
+	if (cport < ARRAY_SIZE(routes)) {
+		routes[cport] = idx + 1;
+	}
+	k_spin_unlock(&router_lock, key);
+}
+
+int gb_transport_rx(const struct gb_transport_backend *backend, uint16_t cport,
+		    struct gb_message *msg)
+{
+	gb_transport_rx_note(backend, cport, msg);
+
+	return greybus_rx_handler(cport, msg);
+}
+
+/*
+ * Pick the backend for a cport: the routed one if it is up, otherwise the first one that is up.
+ */
+static int router_pick(uint16_t cport)
+{
+	size_t i;
+
+	if (cport < ARRAY_SIZE(routes) && routes[cport] && stats[routes[cport] - 1].up) {
+		return routes[cport] - 1;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(backends); i++) {
+		if (stats[i].up) {
+			return i;
+		}
+	}
+
+	return -ENOTCONN;
+}
+
+static int router_send(uint16_t cport, const struct gb_message *msg)
+{
+	k_spinlock_key_t key;
+	bool failover = false;
+	int idx;
+	int ret;
+
+	while (true) {
+		key = k_spin_lock(&router_lock);
+		idx = router_pick(cport);
+		k_spin_unlock(&router_lock, key);
+
+		if (idx < 0) {
+			return idx;
+		}
+
+		ret = backends[idx].backend->send(cport, msg);
+
+		key = k_spin_lock(&router_lock);
+		if (ret == 0) {
+			stats[idx].tx_messages++;
+			stats[idx].tx_bytes += gb_message_len(msg);
+			if (failover) {
+				stats[idx].failovers++;
+				if (cport < ARRAY_SIZE(routes)) {
+					routes[cport] = idx + 1;
+				}
+			}
+		} else {
+			stats[idx].tx_errors++;
+			if (is_link_error(ret)) {
+				LOG_WRN("Transport %s down: %d", backends[idx].name, ret);
+				stats[idx].up = false;
+				failover = true;
+			}
+		}
+		k_spin_unlock(&router_lock, key);
+
+		if (ret == 0 || !is_link_error(ret)) {
+			return ret;
+		}
+	}
+}
+
+static int router_init(void)
+{
+	size_t i;
+	int ret;
+	int up = 0;
+
+	for (i = 0; i < ARRAY_SIZE(backends); i++) {
+		ret = backends[i].backend->init();
+		if (ret < 0) {
+			LOG_ERR("Failed to init transport %s: %d", backends[i].name, ret);
+			continue;
+		}
+
+		stats[i].up = true;
+		up++;
+	}
+
+	return up ? 0 : -ENODEV;
+}
+
+static void router_exit(void)
+{
+	size_t i;
+
+	for (i = 0; i < ARRAY_SIZE(backends); i++) {
+		if (backends[i].backend->exit) {
+			backends[i].backend->exit();
+		}
+		stats[i].up = false;
+	}
+}
+
+static int router_listen(uint16_t cport)
+{
+	size_t i;
+	int ret = 0;
+	int err;
+
+	for (i = 0; i < ARRAY_SIZE(backends); i++) {
+		if (!backends[i].backend->listen) {
+			continue;
+		}
+
+		err = backends[i].backend->listen(cport);
+		if (err < 0) {
+			ret = err;
+		}
+	}
+
+	return ret;
+}
+
+static int router_stop_listening(uint16_t cport)
+{
+	size_t i;
+	int ret = 0;
+	int err;
+
+	for (i = 0; i < ARRAY_SIZE(backends); i++) {
+		if (!backends[i].backend->stop_listening) {
+			continue;
+		}
+
+		err = backends[i].backend->stop_listening(cport);
+		if (err < 0) {
+			ret = err;
+		}
+	}
+
+	return ret;
+}
+
+/*
+ * Messages can fail over to any backend, so only advertise what all of them support.
+ */
+static void router_get_caps(struct gb_transport_caps *caps)
+{
+	struct gb_transport_caps backend_caps;
+	size_t i;
+
+	caps->flags = UINT32_MAX;
+
+	for (i = 0; i < ARRAY_SIZE(backends); i++) {
+		backend_get_caps(backends[i].backend, &backend_caps);
+
+		caps->max_message_size = MIN(caps->max_message_size, backend_caps.max_message_size);
+		caps->preferred_message_size =
+			MIN(caps->preferred_message_size, backend_caps.preferred_message_size);
+		caps->flags &= backend_caps.flags;
+	}
+}
+
+const struct gb_transport_backend gb_trans_router = {
+	.init = router_init,
+	.exit = router_exit,
+	.listen = router_listen,
+	.stop_listening = router_stop_listening,
+	.send = router_send,
+	.get_caps = router_get_caps,
+};
+
+size_t gb_transport_backend_count(void)
+{
+	return ARRAY_SIZE(backends);
+}
+
+const char *gb_transport_backend_name(size_t idx)
+{
+	return (idx < ARRAY_SIZE(backends)) ? backends[idx].name : NULL;
+}
+
+int gb_transport_backend_stats(size_t idx, struct gb_transport_stats *out)
+{
+	k_spinlock_key_t key;
+
+	if (idx >= ARRAY_SIZE(backends)) {
+		return -EINVAL;
+	}
+
+	key = k_spin_lock(&router_lock);
+	*out = stats[idx];
+	k_spin_unlock(&router_lock, key);
+
+	return 0;
+}
+
+#else
+
+size_t gb_transport_backend_count(void)
+{
+	return 1;
+}
+
+const char *gb_transport_backend_name(size_t idx)
+{
+	ARG_UNUSED(idx);
+
+	return NULL;
+}
+
+int gb_transport_backend_stats(size_t idx, struct gb_transport_stats *out)
+{
+	ARG_UNUSED(idx);
+	ARG_UNUSED(out);
+
+	return -ENOTSUP;
+}
+
+#endif /* CONFIG_GREYBUS_XPORT_MULTI */
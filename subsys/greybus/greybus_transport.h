@@ -7,21 +7,268 @@
 #ifndef _GREYBUS_TRANSPORT_H_
 #define _GREYBUS_TRANSPORT_H_
 
+#include <greybus/greybus.h>
 #include <greybus/greybus_messages.h>
+#include <zephyr/toolchain.h>
+#include <zephyr/sys/atomic.h>
+
+/*
+ * Name of the backend defined by a transport. With CONFIG_GREYBUS_XPORT_MULTI every transport
+ * gets its own symbol and is reached through the router.
+ */
+#ifdef CONFIG_GREYBUS_XPORT_MULTI
+#define GB_TRANSPORT_BACKEND(_name) gb_trans_backend_##_name
+
+extern const struct gb_transport_backend gb_trans_router;
+
+/**
+ * Record the backend a message arrived on, without submitting it.
+ *
+ * @param backend backend the message was received on
+ * @param cport
+ * @param msg
+ */
+void gb_transport_rx_note(const struct gb_transport_backend *backend, uint16_t cport,
+			  const struct gb_message *msg);
+
+/**
+ * Record the backend a message arrived on and submit it for processing.
+ *
+ * @param backend backend the message was received on
+ * @param cport
+ * @param msg
+ */
+int gb_transport_rx(const struct gb_transport_backend *backend, uint16_t cport,
+		    struct gb_message *msg);
+#else
+#define GB_TRANSPORT_BACKEND(_name) gb_trans_backend
 
 extern const struct gb_transport_backend gb_trans_backend;
 
+static inline void gb_transport_rx_note(const struct gb_transport_backend *backend,
+					uint16_t cport, const struct gb_message *msg)
+{
+	ARG_UNUSED(backend);
+	ARG_UNUSED(cport);
+	ARG_UNUSED(msg);
+}
+
+static inline int gb_transport_rx(const struct gb_transport_backend *backend, uint16_t cport,
+				  struct gb_message *msg)
+{
+	ARG_UNUSED(backend);
+
+	return greybus_rx_handler(cport, msg);
+}
+#endif /* CONFIG_GREYBUS_XPORT_MULTI */
+
+/**
+ * Single producer, single consumer ring of received frames. A transport publishes frames straight
+ * from interrupt context and the greybus dispatcher thread consumes them, with no work item or
+ * message queue in between. A record holds one or more frames back to back, each frame being a
+ * le16 cport followed by a complete greybus message.
+ *
+ * Every producer needs its own ring.
+ */
+struct gb_rx_ring {
+	const struct gb_transport_backend *backend;
+	uint8_t *buf;
+	size_t size;
+	/* Only written by the producer */
+	atomic_t head;
+	size_t claim;
+	/* Only written by the consumer */
+	atomic_t tail;
+};
+
+/* Ring space taken by a record of _len bytes */
+#define GB_RX_RING_RECORD_SIZE(_len) (sizeof(uint32_t) + ROUND_UP(_len, sizeof(uint32_t)))
+
+#define GB_RX_RING_DEFINE(_name, _size, _backend)                                                  \
+	static uint8_t _name##_buf[ROUND_UP(_size, sizeof(uint32_t))] __aligned(4);                \
+	static struct gb_rx_ring _name = {                                                         \
+		.backend = _backend,                                                               \
+		.buf = _name##_buf,                                                                \
+		.size = sizeof(_name##_buf),                                                       \
+	}
+
+/**
+ * Hand a ring over to the dispatcher. Must be called before anything is published.
+ *
+ * @return 0 on success, -ENOMEM if too many rings are registered
+ */
+int gb_rx_ring_register(struct gb_rx_ring *ring);
+
+/**
+ * Reserve contiguous space for a record. Producer side, can be called from an ISR.
+ *
+ * @param ring
+ * @param len largest record that will be committed
+ *
+ * @return space to write the record to, NULL if the ring is full
+ */
+void *gb_rx_ring_claim(struct gb_rx_ring *ring, size_t len);
+
+/**
+ * Publish the record written to the claimed space and wake the dispatcher. Producer side, can be
+ * called from an ISR.
+ *
+ * @param ring
+ * @param len record length, at most the claimed length
+ */
+void gb_rx_ring_commit(struct gb_rx_ring *ring, size_t len);
+
 /**
  * Send message to AP.
  *
  * This function does not take ownership over the message. Hence it is the caller's responsibility
  * to cleanup.
  *
+ * With CONFIG_GREYBUS_TX_SCHED the message is only queued, 0 means it was accepted by the
+ * scheduler. A backend failure happens later and is only logged, use
+ * gb_transport_message_send_tracked() to count those.
+ *
  * @param cport
  * @param msg
  */
 int gb_transport_message_send(const struct gb_message *msg, uint16_t cport);
 
+/**
+ * Same as gb_transport_message_send(), additionally counting backend failures that happen after
+ * the message was queued by the TX scheduler.
+ *
+ * @param msg
+ * @param cport
+ * @param failed incremented if the queued message can't be sent, must outlive the message
+ */
+int gb_transport_message_send_tracked(const struct gb_message *msg, uint16_t cport,
+				      atomic_t *failed);
+
+/**
+ * Send message to AP, handing over ownership.
+ *
+ * The message is freed once sent, or on failure. Backends that support it pass the buffer on
+ * without copying.
+ *
+ * @param msg
+ * @param cport
+ */
+int gb_transport_message_send_owned(struct gb_message *msg, uint16_t cport);
+
+/**
+ * Hand a message to the transport right away, bypassing the TX scheduler.
+ *
+ * @param msg
+ * @param cport
+ */
+int gb_transport_message_xmit(const struct gb_message *msg, uint16_t cport);
+
+/**
+ * TX scheduler priority classes, highest priority first.
+ */
+enum gb_tx_class {
+	/* Default class of the cport, control for cport 0 and requests otherwise */
+	GB_TX_CLASS_AUTO = -1,
+	/* Control and SVC traffic */
+	GB_TX_CLASS_CONTROL,
+	/* Unidirectional events, e.g. GPIO interrupts */
+	GB_TX_CLASS_EVENT,
+	/* Operation requests and responses */
+	GB_TX_CLASS_REQUEST,
+	/* Streaming data, e.g. camera frame fragments */
+	GB_TX_CLASS_BULK,
+	GB_TX_CLASS_COUNT,
+};
+
+#ifdef CONFIG_GREYBUS_TX_SCHED
+/**
+ * Queue a message for the TX scheduler. The message is copied.
+ *
+ * @param msg
+ * @param cport
+ * @param failed incremented if the backend fails to send the message, can be NULL
+ *
+ * @return 0 once queued, -ENOBUFS if the queue is full in interrupt context
+ */
+int gb_tx_sched_enqueue(const struct gb_message *msg, uint16_t cport, atomic_t *failed);
+
+/**
+ * Put all messages sent on a cport in a priority class. Messages of a cport are always sent in
+ * the order they were queued, so set the class before the cport carries traffic.
+ *
+ * @param cport
+ * @param class class, or GB_TX_CLASS_AUTO for the default class of the cport
+ */
+void gb_tx_sched_set_class(uint16_t cport, enum gb_tx_class class);
+#endif /* CONFIG_GREYBUS_TX_SCHED */
+
+#ifdef CONFIG_GREYBUS_AGGREGATION
+/**
+ * Aggregation statistics
+ *
+ * @tx_dropped: messages sent from ISR that fit no envelope while earlier ones were pending
+ * @rx_errors: envelope entries received that could not be submitted, an invalid entry ends its
+ *	       envelope and counts once
+ */
+struct gb_aggregate_stats {
+	uint32_t tx_dropped;
+	uint32_t rx_errors;
+};
+
+/**
+ * Send a message, packing it into an envelope if the host supports them.
+ *
+ * From ISR a full envelope is handed to the flush and the message goes into the other one. It
+ * is only refused if that one is still being sent, or the message fits no envelope, while
+ * earlier messages are pending.
+ *
+ * @param msg
+ * @param cport
+ *
+ * @return 0 once the message is sent or queued in an envelope, -EAGAIN if called from ISR and
+ *	   the message is refused, negative error otherwise
+ */
+int gb_aggregate_send(const struct gb_message *msg, uint16_t cport);
+
+/**
+ * Unpack an envelope received from the host and submit its messages for processing. Takes
+ * ownership of the envelope.
+ *
+ * @param msg envelope
+ */
+int gb_aggregate_rx(struct gb_message *msg);
+
+/**
+ * Stop sending envelopes until the host opts in again.
+ */
+void gb_aggregate_reset(void);
+
+/**
+ * Get a snapshot of the aggregation statistics.
+ *
+ * @param stats filled with the statistics
+ */
+void gb_aggregate_stats_get(struct gb_aggregate_stats *stats);
+#endif /* CONFIG_GREYBUS_AGGREGATION */
+
+/**
+ * Get the capabilities of the transport link. With CONFIG_GREYBUS_XPORT_MULTI these are the
+ * capabilities shared by all backends, so that a message fits whichever backend it is routed to.
+ *
+ * @param caps filled with the capabilities
+ */
+void gb_transport_get_caps(struct gb_transport_caps *caps);
+
+/**
+ * Get the amount of data a protocol should put in a single message for bulk transfers.
+ *
+ * @param overhead protocol specific bytes in the payload preceding the data
+ * @param limit upper bound, e.g. the size of the protocol buffers
+ *
+ * @return chunk size, 0 if the link cannot even carry the overhead
+ */
+size_t gb_transport_chunk_size(size_t overhead, size_t limit);
+
 /**
  * Helper to allocate and send success response
  *
@@ -40,11 +287,10 @@ static inline void gb_transport_message_response_success_send(struct gb_message
 	struct gb_message *resp =
 		gb_message_response_alloc_from_req(payload, payload_len, req, GB_OP_SUCCESS);
 	if (resp) {
-		gb_transport_message_send(resp, cport);
+		gb_transport_message_send_owned(resp, cport);
 	}
 
 	gb_message_dealloc(req);
-	gb_message_dealloc(resp);
 }
 
 /**
@@ -91,7 +337,11 @@ static inline void gb_transport_message_empty_response_send(struct gb_message *r
  */
 static inline const struct gb_transport_backend *gb_transport_get_backend(void)
 {
+#ifdef CONFIG_GREYBUS_XPORT_MULTI
+	return &gb_trans_router;
+#else
 	return &gb_trans_backend;
+#endif
 }
 
 #endif // _GREYBUS_TRANSPORT_H_
@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2026 BeagleBoard.org
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Prioritised TX scheduler. Classes are served in strict priority order. Within a class every
+ * cport is a flow and flows share the link by deficit round-robin. A message is picked at a
+ * time, so a higher class preempts a bulk stream between two fragments. The class is picked per
+ * cport, never per message, so messages of a cport keep their order.
+ */
+
+#include "greybus_transport.h"
+#include "greybus_heap.h"
+#include <greybus/greybus.h>
+#include <greybus-utils/manifest.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/slist.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_REGISTER(greybus_tx_sched, CONFIG_GREYBUS_LOG_LEVEL);
+
+/* Flow for messages not sent on a regular cport, e.g. aggregation envelopes */
+#define FLOW_OTHER GREYBUS_CPORT_COUNT
+
+struct gb_tx_item {
+	sys_snode_t node;
+	uint16_t cport;
+	/* Incremented if the backend fails to send the message, can be NULL */
+	atomic_t *failed;
+	/* Copy of the greybus message */
+	uint8_t msg[] __aligned(4);
+};
+
+struct gb_tx_flow {
+	/* Entry in the active list of the class */
+	sys_snode_t node;
+	sys_slist_t queue;
+	uint32_t deficit;
+};
+
+static struct gb_tx_flow flows[GB_TX_CLASS_COUNT][GREYBUS_CPORT_COUNT + 1];
+static sys_slist_t active[GB_TX_CLASS_COUNT];
+/* Class + 1 of every cport, 0 for the default class */
+static uint8_t cport_class[GREYBUS_CPORT_COUNT];
+static struct k_spinlock lock;
+
+static K_SEM_DEFINE(pending_sem, 0, K_SEM_MAX_LIMIT);
+static K_SEM_DEFINE(slots_sem, CONFIG_GREYBUS_TX_SCHED_QUEUE_LEN,
+		    CONFIG_GREYBUS_TX_SCHED_QUEUE_LEN);
+
+static enum gb_tx_class tx_class(uint16_t cport)
+{
+	if (cport >= GREYBUS_CPORT_COUNT) {
+		return GB_TX_CLASS_CONTROL;
+	}
+
+	if (cport_class[cport]) {
+		return cport_class[cport] - 1;
+	}
+
+	return (cport == 0) ? GB_TX_CLASS_CONTROL : GB_TX_CLASS_REQUEST;
+}
+
+/*
+ * Take the next message to send. Must be called with the lock held.
+ */
+static struct gb_tx_item *sched_pick(void)
+{
+	struct gb_tx_flow *flow;
+	struct gb_tx_item *item;
+	sys_snode_t *node;
+	size_t len;
+	int class;
+
+	for (class = 0; class < GB_TX_CLASS_COUNT; class++) {
+		while ((node = sys_slist_peek_head(&active[class]))) {
+			flow = CONTAINER_OF(node, struct gb_tx_flow, node);
+			item = CONTAINER_OF(sys_slist_peek_head(&flow->queue), struct gb_tx_item,
+					    node);
+			len = gb_message_len((const struct gb_message *)item->msg);
+
+			if (flow->deficit >= len) {
+				sys_slist_get(&flow->queue);
+				flow->deficit -= len;
+
+				if (sys_slist_is_empty(&flow->queue)) {
+					sys_slist_get(&active[class]);
+				}
+
+				return item;
+			}
+
+			/* Turn is over, the flow gets its next quantum at the back of the round */
+			flow->deficit += CONFIG_GREYBUS_TX_SCHED_QUANTUM;
+			sys_slist_get(&active[class]);
+			sys_slist_append(&active[class], &flow->node);
+		}
+	}
+
+	return NULL;
+}
+
+static void tx_sched_thread(void *p1, void *p2, void *p3)
+{
+	struct gb_tx_item *item;
+	k_spinlock_key_t key;
+	int ret;
+
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (true) {
+		k_sem_take(&pending_sem, K_FOREVER);
+
+		key = k_spin_lock(&lock);
+		item = sched_pick();
+		k_spin_unlock(&lock, key);
+
+		if (!item) {
+			continue;
+		}
+
+		ret = gb_transport_message_xmit((const struct gb_message *)item->msg, item->cport);
+		if (ret < 0) {
+			LOG_ERR("Failed to send message on cport %u: %d", item->cport, ret);
+			if (item->failed) {
+				atomic_inc(item->failed);
+			}
+		}
+
+		gb_free(item);
+		k_sem_give(&slots_sem);
+	}
+}
+
+K_THREAD_DEFINE(gb_tx_sched_tid, CONFIG_GREYBUS_TX_SCHED_STACK_SIZE, tx_sched_thread, NULL, NULL,
+		NULL, CONFIG_GREYBUS_TX_SCHED_THREAD_PRIORITY, 0, 0);
+
+int gb_tx_sched_enqueue(const struct gb_message *msg, uint16_t cport, atomic_t *failed)
+{
+	const size_t len = gb_message_len(msg);
+	enum gb_tx_class class;
+	struct gb_tx_flow *flow;
+	struct gb_tx_item *item;
+	k_spinlock_key_t key;
+
+	if (k_sem_take(&slots_sem, k_is_in_isr() ? K_NO_WAIT : K_FOREVER) < 0) {
+		return -ENOBUFS;
+	}
+
+	item = gb_alloc(sizeof(*item) + len);
+	if (!item) {
+		k_sem_give(&slots_sem);
+		return -ENOMEM;
+	}
+
+	item->cport = cport;
+	item->failed = failed;
+	memcpy(item->msg, msg, len);
+
+	key = k_spin_lock(&lock);
+	class = tx_class(cport);
+	flow = &flows[class][MIN(cport, FLOW_OTHER)];
+	if (sys_slist_is_empty(&flow->queue)) {
+		/* A flow joining the round starts with a fresh quantum */
+		flow->deficit = CONFIG_GREYBUS_TX_SCHED_QUANTUM;
+		sys_slist_append(&active[class], &flow->node);
+	}
+	sys_slist_append(&flow->queue, &item->node);
+	k_spin_unlock(&lock, key);
+
+	k_sem_give(&pending_sem);
+
+	return 0;
+}
+
+void gb_tx_sched_set_class(uint16_t cport, enum gb_tx_class class)
+{
+	k_spinlock_key_t key;
+
+	if (cport >= GREYBUS_CPORT_COUNT || class >= GB_TX_CLASS_COUNT) {
+		return;
+	}
+
+	key = k_spin_lock(&lock);
+	cport_class[cport] = class + 1;
+	k_spin_unlock(&lock, key);
+}
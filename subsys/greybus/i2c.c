@@ -107,8 +107,8 @@ static void gb_i2c_protocol_transfer(uint16_t cport, struct gb_message *req,
 		}
 	}
 
-	gb_transport_message_send(resp, cport);
-	return gb_message_dealloc(resp);
+	gb_transport_message_send_owned(resp, cport);
+	return gb_message_dealloc(req);
 
 free_msg:
 	gb_message_dealloc(resp);
@@ -1,51 +1,161 @@
 #include <greybus/apbridge.h>
+#include <string.h>
 #include <zephyr/sys/errno_private.h>
 #include "greybus_heap.h"
+#include "greybus_internal.h"
+#include <zephyr/kernel.h>
 #include <zephyr/sys/util.h>
 #include <zephyr/sys/mutex.h>
 
-static struct gb_interface *intfs[AP_MAX_NODES];
+/*
+ * Interfaces are stored in chunks of GB_INTF_CHUNK_SIZE ids, allocated when the first interface
+ * of a chunk is added and freed with the last one. Lookups stay O(1) while memory follows the
+ * number of interfaces actually present.
+ *
+ * Chunks and slots are published with atomic pointers, so lookups never wait. Removal
+ * unpublishes first and only frees once every reader that could still see the old pointer has
+ * left its read section. Readers count themselves in one of two counters picked by the current
+ * epoch, removal flips the epoch twice and waits for each counter to drain, so new readers
+ * cannot hold it back indefinitely.
+ *
+ * Read sections are kept short. Writes, which can block, run outside of them holding a
+ * reference on the interface, removal waits for those too. Neither wait holds intfs_mutex, so a
+ * blocked write can't stall adding or removing other interfaces.
+ */
+#define GB_INTF_CHUNK_SIZE 16
+#define GB_INTF_CHUNKS     DIV_ROUND_UP(AP_MAX_INTERFACES, GB_INTF_CHUNK_SIZE)
+
+struct gb_interface_chunk {
+	atomic_ptr_t intfs[GB_INTF_CHUNK_SIZE];
+	/* Only accessed with intfs_mutex held */
+	uint8_t count;
+};
+
+static atomic_ptr_t chunks[GB_INTF_CHUNKS];
+/* Serializes add and remove */
 K_MUTEX_DEFINE(intfs_mutex);
+/* Serializes waiting for readers, epoch flips of two removals must not interleave */
+static K_MUTEX_DEFINE(readers_mutex);
 
-static int new_interface_id(void)
+static atomic_t epoch;
+static atomic_t readers[2];
+
+int gb_interface_read_lock(void)
 {
-	int ret, i;
+	const int idx = atomic_get(&epoch) & 1;
 
-	ret = k_mutex_lock(&intfs_mutex, K_NO_WAIT);
-	if (ret < 0) {
-		return -EBUSY;
+	atomic_inc(&readers[idx]);
+
+	return idx;
+}
+
+void gb_interface_read_unlock(int key)
+{
+	atomic_dec(&readers[key]);
+}
+
+/* Wait until all read sections that started before the call are done */
+static void wait_for_readers(void)
+{
+	int idx;
+
+	k_mutex_lock(&readers_mutex, K_FOREVER);
+
+	for (size_t i = 0; i < ARRAY_SIZE(readers); i++) {
+		idx = atomic_inc(&epoch) & 1;
+
+		while (atomic_get(&readers[idx]) > 0) {
+			k_sleep(K_TICKS(1));
+		}
 	}
 
-	ret = -EOVERFLOW;
+	k_mutex_unlock(&readers_mutex);
+}
 
-	for (i = INTF_START_ID; i < ARRAY_SIZE(intfs); i++) {
-		if (!intfs[i]) {
-			ret = i;
-			goto unlock;
+void gb_interface_ref(struct gb_interface *intf)
+{
+	atomic_inc(&intf->refs);
+}
+
+void gb_interface_unref(struct gb_interface *intf)
+{
+	atomic_dec(&intf->refs);
+}
+
+/* Wait until writes in progress on an unpublished interface are done */
+static void wait_for_refs(struct gb_interface *intf)
+{
+	while (atomic_get(&intf->refs) > 0) {
+		k_sleep(K_TICKS(1));
+	}
+}
+
+static struct gb_interface_chunk *intf_chunk(uint8_t id)
+{
+	if (id >= AP_MAX_INTERFACES) {
+		return NULL;
+	}
+
+	return atomic_ptr_get(&chunks[id / GB_INTF_CHUNK_SIZE]);
+}
+
+static int new_interface_id(void)
+{
+	struct gb_interface_chunk *chunk;
+	int i;
+
+	for (i = INTF_START_ID; i < AP_MAX_INTERFACES; i++) {
+		chunk = intf_chunk(i);
+		if (!chunk || !atomic_ptr_get(&chunk->intfs[i % GB_INTF_CHUNK_SIZE])) {
+			return i;
 		}
 	}
 
-unlock:
-	k_mutex_unlock(&intfs_mutex);
-	return ret;
+	return -EOVERFLOW;
 }
 
 int gb_interface_add(struct gb_interface *intf)
 {
-	int ret;
+	struct gb_interface_chunk *chunk;
+	int ret = 0;
 
-	ret = k_mutex_lock(&intfs_mutex, K_NO_WAIT);
-	if (ret < 0) {
-		return -EBUSY;
+	if (intf->id >= AP_MAX_INTERFACES) {
+		return -EOVERFLOW;
 	}
 
-	if (intfs[intf->id]) {
+	k_mutex_lock(&intfs_mutex, K_FOREVER);
+
+	chunk = intf_chunk(intf->id);
+	if (chunk && atomic_ptr_get(&chunk->intfs[intf->id % GB_INTF_CHUNK_SIZE])) {
 		ret = -EALREADY;
-	} else {
-		ret = 0;
-		intfs[intf->id] = intf;
+		goto unlock;
 	}
 
+#ifdef CONFIG_GREYBUS_APBRIDGE_TX_QUEUE
+	ret = gb_apbridge_txq_attach(intf);
+	if (ret < 0) {
+		goto unlock;
+	}
+#endif
+
+	if (!chunk) {
+		chunk = gb_alloc(sizeof(*chunk));
+		if (!chunk) {
+#ifdef CONFIG_GREYBUS_APBRIDGE_TX_QUEUE
+			gb_apbridge_txq_release(intf);
+#endif
+			ret = -ENOMEM;
+			goto unlock;
+		}
+
+		memset(chunk, 0, sizeof(*chunk));
+		atomic_ptr_set(&chunks[intf->id / GB_INTF_CHUNK_SIZE], chunk);
+	}
+
+	chunk->count++;
+	atomic_ptr_set(&chunk->intfs[intf->id % GB_INTF_CHUNK_SIZE], intf);
+
+unlock:
 	k_mutex_unlock(&intfs_mutex);
 
 	return ret;
@@ -53,11 +163,45 @@ int gb_interface_add(struct gb_interface *intf)
 
 void gb_interface_remove(uint8_t id)
 {
+	struct gb_interface_chunk *chunk;
+	struct gb_interface *intf;
+
 	k_mutex_lock(&intfs_mutex, K_FOREVER);
 
-	intfs[id] = NULL;
+	chunk = intf_chunk(id);
+	intf = chunk ? atomic_ptr_clear(&chunk->intfs[id % GB_INTF_CHUNK_SIZE]) : NULL;
+	if (!intf) {
+		k_mutex_unlock(&intfs_mutex);
+		return;
+	}
+
+	if (--chunk->count == 0) {
+		atomic_ptr_clear(&chunks[id / GB_INTF_CHUNK_SIZE]);
+	} else {
+		chunk = NULL;
+	}
+
+#ifdef CONFIG_GREYBUS_APBRIDGE_TX_QUEUE
+	/* Workers check it in their read section, so none takes a reference after the wait */
+	gb_apbridge_txq_close(intf);
+#endif
 
 	k_mutex_unlock(&intfs_mutex);
+
+	/*
+	 * Nothing can reach the chunk or the interface from now on. References are only taken in
+	 * read sections, so none is added once the readers are gone.
+	 */
+	wait_for_readers();
+	wait_for_refs(intf);
+
+	if (chunk) {
+		gb_free(chunk);
+	}
+
+#ifdef CONFIG_GREYBUS_APBRIDGE_TX_QUEUE
+	gb_apbridge_txq_release(intf);
+#endif
 }
 
 struct gb_interface *gb_interface_alloc(gb_controller_write_callback_t write_cb,
@@ -68,10 +212,8 @@ struct gb_interface *gb_interface_alloc(gb_controller_write_callback_t write_cb,
 	int ret;
 	struct gb_interface *intf;
 
-	ret = k_mutex_lock(&intfs_mutex, K_NO_WAIT);
-	if (ret < 0) {
-		return NULL;
-	}
+	/* Keeps the id free until the interface is added */
+	k_mutex_lock(&intfs_mutex, K_FOREVER);
 
 	ret = new_interface_id();
 	if (ret < 0) {
@@ -85,13 +227,17 @@ struct gb_interface *gb_interface_alloc(gb_controller_write_callback_t write_cb,
 		return intf;
 	}
 
+	memset(intf, 0, sizeof(*intf));
 	intf->id = ret;
 	intf->create_connection = create_connection_cb;
 	intf->destroy_connection = destroy_connection_cb;
 	intf->write = write_cb;
 	intf->ctrl_data = ctrl_data;
 
-	gb_interface_add(intf);
+	if (gb_interface_add(intf) < 0) {
+		gb_free(intf);
+		intf = NULL;
+	}
 
 	k_mutex_unlock(&intfs_mutex);
 
@@ -106,5 +252,16 @@ void gb_interface_dealloc(struct gb_interface *intf)
 
 struct gb_interface *gb_interface_get(uint8_t id)
 {
-	return intfs[id];
+	struct gb_interface_chunk *chunk;
+	struct gb_interface *intf = NULL;
+	int key;
+
+	key = gb_interface_read_lock();
+	chunk = intf_chunk(id);
+	if (chunk) {
+		intf = atomic_ptr_get(&chunk->intfs[id % GB_INTF_CHUNK_SIZE]);
+	}
+	gb_interface_read_unlock(key);
+
+	return intf;
 }
@@ -38,8 +38,7 @@ void gb_log_send_log(uint16_t len, const char *log)
 	memcpy(req_data->msg, log, len);
 	req_data->msg[len] = '\0';
 
-	gb_transport_message_send(msg, GREYBUS_LOG_CPORT);
-	gb_message_dealloc(msg);
+	gb_transport_message_send_owned(msg, GREYBUS_LOG_CPORT);
 }
 
 const struct gb_driver gb_log_driver = {
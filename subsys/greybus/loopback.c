@@ -40,9 +40,7 @@ static void gb_loopback_transfer_req_cb(struct gb_message *req, uint16_t cport)
 	req->header.type = GB_RESPONSE(GB_LOOPBACK_TYPE_TRANSFER);
 	req->header.result = GB_OP_SUCCESS;
 
-	gb_transport_message_send(req, cport);
-
-	gb_message_dealloc(req);
+	gb_transport_message_send_owned(req, cport);
 }
 
 static void gb_loopback_handler(const void *priv, struct gb_message *msg, uint16_t cport)
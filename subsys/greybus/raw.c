@@ -72,21 +72,37 @@ int greybus_raw_register(greybus_raw_cb_t cb, void *priv)
 	return -ENODEV;
 }
 
+uint32_t greybus_raw_max_send_len(void)
+{
+	struct gb_transport_caps caps;
+	const size_t overhead =
+		sizeof(struct gb_operation_msg_hdr) + sizeof(struct gb_raw_send_request);
+
+	gb_transport_get_caps(&caps);
+
+	return (caps.max_message_size > overhead) ? caps.max_message_size - overhead : 0;
+}
+
 int greybus_raw_send_data(uint16_t id, uint32_t len, const uint8_t *data)
 {
 	int ret;
 	uint16_t cport_id = GREYBUS_RAW_CPORT_START + id;
 	struct gb_raw_send_request *req_data;
-	struct gb_message *msg =
-		gb_message_request_alloc(sizeof(*req_data) + len, GB_RAW_TYPE_SEND, false);
+	struct gb_message *msg;
+
+	if (len > greybus_raw_max_send_len()) {
+		return -EMSGSIZE;
+	}
+
+	msg = gb_message_request_alloc(sizeof(*req_data) + len, GB_RAW_TYPE_SEND, false);
+	if (!msg) {
+		return -ENOMEM;
+	}
 
 	req_data = (struct gb_raw_send_request *)msg->payload;
 
 	req_data->len = sys_cpu_to_le32(len);
 	memcpy(req_data->data, data, len);
 
-	ret = gb_transport_message_send(msg, cport_id);
-	gb_message_dealloc(msg);
-
-	return ret;
+	return gb_transport_message_send_owned(msg, cport_id);
 }
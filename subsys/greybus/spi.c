@@ -209,8 +209,9 @@ static void gb_spi_protocol_transfer(uint16_t cport, struct gb_message *req,
 		k_sleep(K_USEC(desc->delay_usecs));
 	}
 
-	gb_transport_message_send(resp, cport);
+	gb_transport_message_send_owned(resp, cport);
 	gb_message_dealloc(req);
+	return;
 
 free_resp:
 	gb_message_dealloc(resp);
@@ -1,9 +1,15 @@
 #include "greybus/greybus_messages.h"
 #include "greybus/greybus_protocols.h"
 #include <zephyr/kernel.h>
+#include <greybus/greybus.h>
 #include <greybus/svc.h>
 #include <greybus/apbridge.h>
 #include <zephyr/logging/log.h>
+#include "greybus_internal.h"
+
+#ifdef CONFIG_GREYBUS_TIMESYNC
+#include <greybus/timesync.h>
+#endif
 
 LOG_MODULE_REGISTER(greybus_svc, CONFIG_GREYBUS_LOG_LEVEL);
 
@@ -11,9 +17,32 @@ LOG_MODULE_REGISTER(greybus_svc, CONFIG_GREYBUS_LOG_LEVEL);
 #define GB_SVC_VERSION_MAJOR 0x00
 #define GB_SVC_VERSION_MINOR 0x01
 
-#define SVC_INIT_TIMEOUT K_SECONDS(5)
+#define SVC_INIT_TIMEOUT K_MSEC(CONFIG_GREYBUS_SVC_INIT_TIMEOUT_MS)
+
+/*
+ * Messages routed to the SVC are queued and handled on the SVC work queue, never in the context
+ * of the sender. Handlers may call back into the APBridge and interface callbacks, which is not
+ * safe to do from inside a send.
+ */
+K_MSGQ_DEFINE(svc_msgq, sizeof(struct gb_msg_with_cport), CONFIG_GREYBUS_SVC_QUEUE_DEPTH, 4);
+static K_THREAD_STACK_DEFINE(svc_wq_stack, CONFIG_GREYBUS_SVC_STACK_SIZE);
+static struct k_work_q svc_wq;
+static bool svc_wq_started;
+/* Operations dropped because the queue stayed full */
+static atomic_t svc_dropped;
+
+static void svc_work_handler(struct k_work *work);
+static void svc_init_timeout_handler(struct k_work *work);
+
+static K_WORK_DEFINE(svc_work, svc_work_handler);
+static K_WORK_DELAYABLE_DEFINE(svc_init_timeout, svc_init_timeout_handler);
+
+/* Pending init completion, only accessed from the SVC work queue once init started */
+static gb_svc_init_cb_t svc_init_cb;
+static void *svc_init_user_data;
 
 K_SEM_DEFINE(svc_init, 0, 1);
+static int svc_init_status;
 
 /* TODO: Add support for standalone SVC support */
 static int gb_svc_msg_send(struct gb_message *msg)
@@ -184,9 +213,35 @@ static int svc_send_hello(void)
 	return gb_svc_msg_send(req);
 }
 
+static void svc_init_complete(int status)
+{
+	const gb_svc_init_cb_t cb = svc_init_cb;
+
+	if (!cb) {
+		return;
+	}
+
+	svc_init_cb = NULL;
+	k_work_cancel_delayable(&svc_init_timeout);
+	cb(status, svc_init_user_data);
+}
+
+static void svc_init_timeout_handler(struct k_work *work)
+{
+	ARG_UNUSED(work);
+
+	LOG_ERR("Failed to init");
+	svc_init_complete(-ETIMEDOUT);
+}
+
 static void svc_version_response_handler(struct gb_message *msg)
 {
-	svc_send_hello();
+	int ret = svc_send_hello();
+
+	if (ret < 0) {
+		LOG_ERR("Failed to send SVC hello request");
+		svc_init_complete(ret);
+	}
 }
 
 static void svc_module_inserted_response_handler(struct gb_message *msg)
@@ -204,6 +259,94 @@ static void svc_module_removed_response_handler(struct gb_message *msg)
 	}
 }
 
+#ifdef CONFIG_GREYBUS_TIMESYNC
+/*
+ * The SVC is the TimeSync authority. It strobes itself from a timer, there are no wake pins to
+ * drive, boards forward the strobes to the nodes.
+ */
+static atomic_t svc_timesync_strobes;
+
+static void svc_timesync_strobe_handler(struct k_timer *timer)
+{
+	gb_timesync_strobe();
+
+	if (atomic_dec(&svc_timesync_strobes) <= 1) {
+		k_timer_stop(timer);
+	}
+}
+
+static K_TIMER_DEFINE(svc_timesync_timer, svc_timesync_strobe_handler, NULL);
+
+static void svc_timesync_enable_handler(struct gb_message *msg)
+{
+	const struct gb_svc_timesync_enable_request *req =
+		(const struct gb_svc_timesync_enable_request *)msg->payload;
+	k_timeout_t strobe_delay;
+
+	if (gb_message_payload_len(msg) < sizeof(*req)) {
+		LOG_ERR("Invalid TimeSync enable request");
+		goto fail;
+	}
+
+	k_timer_stop(&svc_timesync_timer);
+
+	if (gb_timesync_enable(req->count, sys_le64_to_cpu(req->frame_time),
+			       sys_le32_to_cpu(req->refclk)) < 0) {
+		LOG_ERR("Invalid TimeSync parameters");
+		goto fail;
+	}
+
+	strobe_delay = K_USEC(MAX(sys_le32_to_cpu(req->strobe_delay), 1));
+	atomic_set(&svc_timesync_strobes, req->count);
+	k_timer_start(&svc_timesync_timer, strobe_delay, strobe_delay);
+
+	svc_response_helper(msg, NULL, 0, GB_SVC_OP_SUCCESS);
+	return;
+
+fail:
+	svc_response_helper(msg, NULL, 0, GB_SVC_OP_UNKNOWN_ERROR);
+}
+
+static void svc_timesync_disable_handler(struct gb_message *msg)
+{
+	k_timer_stop(&svc_timesync_timer);
+	gb_timesync_disable();
+
+	svc_response_helper(msg, NULL, 0, GB_SVC_OP_SUCCESS);
+}
+
+static void svc_timesync_authoritative_handler(struct gb_message *msg)
+{
+	struct gb_svc_timesync_authoritative_response resp = {0};
+	uint64_t frame_time[GB_TIMESYNC_MAX_STROBES];
+	size_t count;
+
+	count = gb_timesync_get_strobes(frame_time);
+	for (size_t i = 0; i < count; i++) {
+		resp.frame_time[i] = sys_cpu_to_le64(frame_time[i]);
+	}
+
+	svc_response_helper(msg, &resp, sizeof(resp), GB_SVC_OP_SUCCESS);
+}
+
+static void svc_timesync_ping_handler(struct gb_message *msg)
+{
+	struct gb_svc_timesync_ping_response resp;
+	uint64_t frame_time;
+
+	gb_timesync_strobe();
+
+	if (gb_timesync_get_last_event(&frame_time) < 0) {
+		LOG_ERR("TimeSync not enabled");
+		svc_response_helper(msg, NULL, 0, GB_SVC_OP_UNKNOWN_ERROR);
+		return;
+	}
+
+	resp.frame_time = sys_cpu_to_le64(frame_time);
+	svc_response_helper(msg, &resp, sizeof(resp), GB_SVC_OP_SUCCESS);
+}
+#endif
+
 static void gb_handle_msg(struct gb_message *msg)
 {
 	switch (gb_message_type(msg)) {
@@ -249,11 +392,29 @@ static void gb_handle_msg(struct gb_message *msg)
 	case GB_SVC_TYPE_INTF_RESUME:
 		svc_interface_resume_handler(msg);
 		break;
+#ifdef CONFIG_GREYBUS_TIMESYNC
+	case GB_SVC_TYPE_TIMESYNC_ENABLE:
+		svc_timesync_enable_handler(msg);
+		break;
+	case GB_SVC_TYPE_TIMESYNC_DISABLE:
+		svc_timesync_disable_handler(msg);
+		break;
+	case GB_SVC_TYPE_TIMESYNC_AUTHORITATIVE:
+		svc_timesync_authoritative_handler(msg);
+		break;
+	case GB_SVC_TYPE_TIMESYNC_PING:
+		svc_timesync_ping_handler(msg);
+		break;
+	case GB_SVC_TYPE_TIMESYNC_WAKE_PINS_ACQUIRE:
+	case GB_SVC_TYPE_TIMESYNC_WAKE_PINS_RELEASE:
+		svc_response_helper(msg, NULL, 0, GB_SVC_OP_SUCCESS);
+		break;
+#endif
 	case GB_RESPONSE(GB_SVC_TYPE_PROTOCOL_VERSION):
 		svc_version_response_handler(msg);
 		break;
 	case GB_RESPONSE(GB_SVC_TYPE_SVC_HELLO):
-		k_sem_give(&svc_init);
+		svc_init_complete(gb_message_is_success(msg) ? 0 : -EIO);
 		break;
 	case GB_RESPONSE(GB_SVC_TYPE_MODULE_INSERTED):
 		svc_module_inserted_response_handler(msg);
@@ -266,13 +427,45 @@ static void gb_handle_msg(struct gb_message *msg)
 	}
 }
 
+static void svc_work_handler(struct k_work *work)
+{
+	struct gb_msg_with_cport item;
+
+	ARG_UNUSED(work);
+
+	while (k_msgq_get(&svc_msgq, &item, K_NO_WAIT) == 0) {
+		gb_handle_msg(item.msg);
+		gb_message_dealloc(item.msg);
+#ifdef CONFIG_GREYBUS_APBRIDGE_CREDITS
+		gb_apbridge_credit_return(SVC_INF_ID, item.cport);
+#endif
+	}
+}
+
 static int gb_svc_intf_write(struct gb_interface *intf, struct gb_message *msg, uint16_t cport)
 {
+	const struct gb_msg_with_cport item = {
+		.cport = cport,
+		.msg = msg,
+	};
+
+	/* The work queue itself would only wait for its own timeout */
+	const k_timeout_t timeout =
+		(k_is_in_isr() || k_current_get() == k_work_queue_thread_get(&svc_wq))
+			? K_NO_WAIT
+			: K_MSEC(CONFIG_GREYBUS_SVC_QUEUE_TIMEOUT_MS);
+
 	ARG_UNUSED(intf);
-	ARG_UNUSED(cport);
 
-	gb_handle_msg(msg);
-	gb_message_dealloc(msg);
+	if (k_msgq_put(&svc_msgq, &item, timeout) < 0) {
+		atomic_inc(&svc_dropped);
+		LOG_ERR("SVC queue full, dropping operation %X", msg->header.type);
+		gb_message_dealloc(msg);
+		return -ENOBUFS;
+	}
+
+	k_work_submit_to_queue(&svc_wq, &svc_work);
+
 	return 0;
 }
 
@@ -282,6 +475,10 @@ static struct gb_interface svc_intf = {
 	.create_connection = NULL,
 	.destroy_connection = NULL,
 	.ctrl_data = NULL,
+#ifdef CONFIG_GREYBUS_APBRIDGE_CREDITS
+	/* Returned once the work queue handled the message */
+	.returns_credits = true,
+#endif
 };
 
 static int gb_svc_send_version(void)
@@ -299,36 +496,105 @@ static int gb_svc_send_version(void)
 	return gb_svc_msg_send(req);
 }
 
-int gb_svc_init(void)
+/* Runs on the SVC work queue, which owns the init state */
+static void svc_init_start_handler(struct k_work *work)
 {
 	int ret;
 
-	gb_interface_add(&svc_intf);
+	ARG_UNUSED(work);
 
-	ret = gb_apbridge_connection_create(AP_INF_ID, 0, SVC_INF_ID, 0);
-	if (ret < 0) {
-		LOG_ERR("Failed to create AP SVC connection");
-		return ret;
-	}
+	k_work_schedule_for_queue(&svc_wq, &svc_init_timeout, SVC_INIT_TIMEOUT);
 
 	ret = gb_svc_send_version();
 	if (ret < 0) {
 		LOG_ERR("Failed to send SVC version request");
+		svc_init_complete(ret);
+	}
+}
+
+static K_WORK_DEFINE(svc_init_start, svc_init_start_handler);
+
+int gb_svc_init_async(gb_svc_init_cb_t cb, void *user_data)
+{
+	int ret;
+
+	if (!svc_wq_started) {
+		k_work_queue_start(&svc_wq, svc_wq_stack, K_THREAD_STACK_SIZEOF(svc_wq_stack),
+				   CONFIG_GREYBUS_SVC_THREAD_PRIORITY, NULL);
+		k_thread_name_set(&svc_wq.thread, "greybus_svc");
+		svc_wq_started = true;
+	}
+
+	ret = gb_interface_add(&svc_intf);
+	if (ret < 0) {
+		LOG_ERR("Failed to add SVC interface: %d", ret);
 		return ret;
 	}
 
-	ret = k_sem_take(&svc_init, SVC_INIT_TIMEOUT);
+	ret = gb_apbridge_connection_create(AP_INF_ID, 0, SVC_INF_ID, 0);
 	if (ret < 0) {
-		LOG_ERR("Failed to init");
+		LOG_ERR("Failed to create AP SVC connection");
+		gb_interface_remove(svc_intf.id);
 		return ret;
 	}
 
+	/* Nothing is queued for the SVC before the connection exists */
+	svc_init_cb = cb;
+	svc_init_user_data = user_data;
+	k_work_submit_to_queue(&svc_wq, &svc_init_start);
+
 	return 0;
 }
 
+static void svc_init_sync_cb(int status, void *user_data)
+{
+	ARG_UNUSED(user_data);
+
+	svc_init_status = status;
+	k_sem_give(&svc_init);
+}
+
+int gb_svc_init(void)
+{
+	int ret;
+
+	k_sem_reset(&svc_init);
+
+	ret = gb_svc_init_async(svc_init_sync_cb, NULL);
+	if (ret < 0) {
+		return ret;
+	}
+
+	/* The timeout on the work queue always completes init */
+	k_sem_take(&svc_init, K_FOREVER);
+
+	return svc_init_status;
+}
+
 void gb_svc_deinit(void)
 {
+	struct gb_msg_with_cport item;
+	struct k_work_sync sync;
+
+	gb_apbridge_connection_destroy(AP_INF_ID, 0, SVC_INF_ID, 0);
 	gb_interface_remove(svc_intf.id);
+
+	/* Nothing new is queued once the interface is gone */
+	k_work_cancel_delayable_sync(&svc_init_timeout, &sync);
+	k_work_flush(&svc_work, &sync);
+	svc_init_cb = NULL;
+#ifdef CONFIG_GREYBUS_TIMESYNC
+	k_timer_stop(&svc_timesync_timer);
+#endif
+
+	while (k_msgq_get(&svc_msgq, &item, K_NO_WAIT) == 0) {
+		gb_message_dealloc(item.msg);
+	}
+}
+
+uint32_t gb_svc_dropped(void)
+{
+	return atomic_get(&svc_dropped);
 }
 
 int gb_svc_send_module_inserted(uint8_t primary_intf_id, uint8_t intf_count, uint16_t flags)
@@ -11,9 +11,11 @@
 #include <greybus/svc.h>
 #include <greybus/apbridge.h>
 
+extern const struct gb_transport_backend GB_TRANSPORT_BACKEND(apbridge);
+
 static int gb_intf_send(struct gb_interface *intf, struct gb_message *msg, uint16_t cport)
 {
-	return greybus_rx_handler(cport, msg);
+	return gb_transport_rx(&GB_TRANSPORT_BACKEND(apbridge), cport, msg);
 }
 
 static struct gb_interface intf = {
@@ -34,15 +36,29 @@ static int gb_trans_listen(uint16_t cport)
 	return 0;
 }
 
+/*
+ * The bridge takes ownership of what it routes, only callers that keep their message pay for a
+ * copy.
+ */
 static int gb_trans_send(uint16_t cport, const struct gb_message *msg)
 {
 	struct gb_message *msg_copy = gb_message_copy(msg);
 
+	if (!msg_copy) {
+		return -ENOMEM;
+	}
+
 	return gb_apbridge_send(INTF_START_ID, cport, msg_copy);
 }
 
-const struct gb_transport_backend gb_trans_backend = {
+static int gb_trans_send_owned(uint16_t cport, struct gb_message *msg)
+{
+	return gb_apbridge_send(INTF_START_ID, cport, msg);
+}
+
+const struct gb_transport_backend GB_TRANSPORT_BACKEND(apbridge) = {
 	.init = gb_trans_init,
 	.listen = gb_trans_listen,
 	.send = gb_trans_send,
+	.send_owned = gb_trans_send_owned,
 };
@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) 2026 BeagleBoard.org
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "../greybus_transport.h"
+#include <greybus/greybus.h>
+#include <zephyr/kernel.h>
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/bluetooth/l2cap.h>
+#include <zephyr/net_buf.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_REGISTER(greybus_transport_ble, CONFIG_GREYBUS_LOG_LEVEL);
+
+extern const struct gb_transport_backend GB_TRANSPORT_BACKEND(ble);
+
+/*
+ * Every L2CAP SDU carries exactly one le16 cport followed by one Greybus message. LE credit based
+ * flow control then paces the peer per message: segments of a new message are only accepted
+ * while an RX buffer is free.
+ */
+#define GB_BLE_SDU_MAX_SIZE (sizeof(__le16) + CONFIG_GREYBUS_XPORT_BLE_MAX_MESSAGE_SIZE)
+
+NET_BUF_POOL_FIXED_DEFINE(tx_pool, CONFIG_GREYBUS_XPORT_BLE_TX_BUFS,
+			  BT_L2CAP_SDU_BUF_SIZE(GB_BLE_SDU_MAX_SIZE),
+			  CONFIG_BT_CONN_TX_USER_DATA_SIZE, NULL);
+NET_BUF_POOL_FIXED_DEFINE(rx_pool, CONFIG_GREYBUS_XPORT_BLE_RX_BUFS,
+			  BT_L2CAP_SDU_BUF_SIZE(GB_BLE_SDU_MAX_SIZE), 8, NULL);
+
+static struct bt_l2cap_le_chan le_chan;
+static atomic_t chan_connected = ATOMIC_INIT(0);
+static atomic_t chan_in_use = ATOMIC_INIT(0);
+
+static const struct bt_data ad[] = {
+	BT_DATA_BYTES(BT_DATA_FLAGS, (BT_LE_AD_GENERAL | BT_LE_AD_NO_BREDR)),
+	BT_DATA(BT_DATA_NAME_COMPLETE, CONFIG_BT_DEVICE_NAME, sizeof(CONFIG_BT_DEVICE_NAME) - 1),
+};
+
+static void adv_start_cb(struct k_work *work)
+{
+	int ret;
+
+	ARG_UNUSED(work);
+
+	ret = bt_le_adv_start(BT_LE_ADV_CONN_FAST_1, ad, ARRAY_SIZE(ad), NULL, 0);
+	if (ret < 0 && ret != -EALREADY) {
+		LOG_ERR("Failed to start advertising: %d", ret);
+	}
+}
+
+static K_WORK_DEFINE(adv_start_work, adv_start_cb);
+
+/*
+ * Ask for the largest link layer packets and the 2M PHY. Both are best effort, the channel
+ * works without them.
+ */
+static void link_upgrade(struct bt_conn *conn)
+{
+#ifdef CONFIG_BT_USER_DATA_LEN_UPDATE
+	if (bt_conn_le_data_len_update(conn, BT_LE_DATA_LEN_PARAM_MAX) < 0) {
+		LOG_WRN("Data length update failed");
+	}
+#endif
+
+#ifdef CONFIG_BT_USER_PHY_UPDATE
+	if (bt_conn_le_phy_update(conn, BT_CONN_LE_PHY_PARAM_2M) < 0) {
+		LOG_WRN("PHY update failed");
+	}
+#endif
+
+	ARG_UNUSED(conn);
+}
+
+static void chan_connected_cb(struct bt_l2cap_chan *chan)
+{
+	struct bt_l2cap_le_chan *ch = BT_L2CAP_LE_CHAN(chan);
+
+	LOG_INF("Channel connected, TX MTU %u MPS %u, RX MTU %u MPS %u", ch->tx.mtu, ch->tx.mps,
+		ch->rx.mtu, ch->rx.mps);
+
+	atomic_set(&chan_connected, 1);
+	link_upgrade(chan->conn);
+}
+
+static void chan_disconnected_cb(struct bt_l2cap_chan *chan)
+{
+	ARG_UNUSED(chan);
+
+	LOG_INF("Channel disconnected");
+
+	atomic_set(&chan_connected, 0);
+	atomic_set(&chan_in_use, 0);
+}
+
+static struct net_buf *chan_alloc_buf_cb(struct bt_l2cap_chan *chan)
+{
+	ARG_UNUSED(chan);
+
+	return net_buf_alloc(&rx_pool, K_FOREVER);
+}
+
+static int chan_recv_cb(struct bt_l2cap_chan *chan, struct net_buf *buf)
+{
+	const struct gb_operation_msg_hdr *hdr;
+	struct gb_msg_with_cport msg;
+
+	ARG_UNUSED(chan);
+
+	if (buf->len < sizeof(__le16) + sizeof(*hdr)) {
+		LOG_ERR("SDU too short: %u", buf->len);
+		return 0;
+	}
+
+	msg.cport = net_buf_pull_le16(buf);
+	hdr = (const struct gb_operation_msg_hdr *)buf->data;
+
+	if (gb_hdr_message_len(hdr) != buf->len) {
+		LOG_ERR("Invalid message size %u", buf->len);
+		return 0;
+	}
+
+	msg.msg = gb_message_alloc(gb_hdr_payload_len(hdr), hdr->type, hdr->operation_id,
+				   hdr->result);
+	if (!msg.msg) {
+		/* An error would make the stack disconnect the channel, drop instead */
+		LOG_ERR("Failed to allocate greybus message");
+		return 0;
+	}
+
+	memcpy(msg.msg->payload, buf->data + sizeof(*hdr), gb_message_payload_len(msg.msg));
+
+	if (gb_transport_rx(&GB_TRANSPORT_BACKEND(ble), msg.cport, msg.msg) < 0) {
+		LOG_ERR("Failed to handle greybus message");
+	}
+
+	return 0;
+}
+
+static const struct bt_l2cap_chan_ops chan_ops = {
+	.connected = chan_connected_cb,
+	.disconnected = chan_disconnected_cb,
+	.alloc_buf = chan_alloc_buf_cb,
+	.recv = chan_recv_cb,
+};
+
+static int server_accept_cb(struct bt_conn *conn, struct bt_l2cap_server *server,
+			    struct bt_l2cap_chan **chan)
+{
+	ARG_UNUSED(conn);
+	ARG_UNUSED(server);
+
+	/* Only a single AP is supported */
+	if (!atomic_cas(&chan_in_use, 0, 1)) {
+		return -ENOMEM;
+	}
+
+	memset(&le_chan, 0, sizeof(le_chan));
+	le_chan.chan.ops = &chan_ops;
+	le_chan.rx.mtu = GB_BLE_SDU_MAX_SIZE;
+	*chan = &le_chan.chan;
+
+	return 0;
+}
+
+static struct bt_l2cap_server server = {
+	.psm = CONFIG_GREYBUS_XPORT_BLE_PSM,
+	.accept = server_accept_cb,
+};
+
+static void conn_recycled_cb(void)
+{
+	k_work_submit(&adv_start_work);
+}
+
+BT_CONN_CB_DEFINE(conn_callbacks) = {
+	.recycled = conn_recycled_cb,
+};
+
+static int gb_trans_init(void)
+{
+	int ret;
+
+	if (!bt_is_ready()) {
+		ret = bt_enable(NULL);
+		if (ret < 0) {
+			LOG_ERR("Failed to enable Bluetooth: %d", ret);
+			return ret;
+		}
+	}
+
+	ret = bt_l2cap_server_register(&server);
+	if (ret < 0 && ret != -EADDRINUSE) {
+		LOG_ERR("Failed to register L2CAP server: %d", ret);
+		return ret;
+	}
+
+	k_work_submit(&adv_start_work);
+
+	return 0;
+}
+
+static void gb_trans_exit(void)
+{
+	bt_le_adv_stop();
+
+	if (atomic_get(&chan_connected)) {
+		bt_l2cap_chan_disconnect(&le_chan.chan);
+	}
+}
+
+static int gb_trans_listen(uint16_t cport)
+{
+	ARG_UNUSED(cport);
+
+	return 0;
+}
+
+static int gb_trans_send(uint16_t cport, const struct gb_message *msg)
+{
+	const size_t len = sizeof(__le16) + gb_message_len(msg);
+	struct net_buf *buf;
+	int ret;
+
+	if (!atomic_get(&chan_connected)) {
+		return -ENOTCONN;
+	}
+
+	if (len > MIN(le_chan.tx.mtu, GB_BLE_SDU_MAX_SIZE)) {
+		LOG_ERR("Message too large: %zu", gb_message_len(msg));
+		return -EMSGSIZE;
+	}
+
+	buf = net_buf_alloc(&tx_pool, k_is_in_isr() ? K_NO_WAIT
+						     : K_MSEC(CONFIG_GREYBUS_XPORT_BLE_TX_TIMEOUT_MS));
+	if (!buf) {
+		return -ENOBUFS;
+	}
+
+	net_buf_reserve(buf, BT_L2CAP_SDU_CHAN_SEND_RESERVE);
+	net_buf_add_le16(buf, cport);
+	net_buf_add_mem(buf, msg, gb_message_len(msg));
+
+	ret = bt_l2cap_chan_send(&le_chan.chan, buf);
+	if (ret < 0) {
+		LOG_ERR("Failed to send SDU: %d", ret);
+		net_buf_unref(buf);
+		return ret;
+	}
+
+	return 0;
+}
+
+/*
+ * The peer MTU is only known once the channel is connected, until then assume the largest
+ * message we could send.
+ */
+static void gb_trans_get_caps(struct gb_transport_caps *caps)
+{
+	size_t sdu_size = GB_BLE_SDU_MAX_SIZE;
+
+	if (atomic_get(&chan_connected)) {
+		sdu_size = MIN(le_chan.tx.mtu, sdu_size);
+	}
+
+	caps->max_message_size = sdu_size - sizeof(__le16);
+	caps->preferred_message_size = sdu_size - sizeof(__le16);
+}
+
+const struct gb_transport_backend GB_TRANSPORT_BACKEND(ble) = {
+	.init = gb_trans_init,
+	.exit = gb_trans_exit,
+	.listen = gb_trans_listen,
+	.send = gb_trans_send,
+	.get_caps = gb_trans_get_caps,
+};
@@ -32,7 +32,7 @@ static int trans_send(uint16_t cport, const struct gb_message *msg)
 	return k_msgq_put(&rx_msgq, &msg_copy, K_NO_WAIT);
 }
 
-const struct gb_transport_backend gb_trans_backend = {
+const struct gb_transport_backend GB_TRANSPORT_BACKEND(dummy) = {
 	.init = init,
 	.listen = listen,
 	.send = trans_send,
@@ -14,7 +14,6 @@
 #include <zephyr/sys/crc.h>
 #include <zephyr/sys/ring_buffer.h>
 #include <greybus/greybus_protocols.h>
-#include <assert.h>
 
 #define HDLC_FRAME     0x7E
 #define HDLC_ESC       0x7D
@@ -22,6 +21,21 @@
 #define HDLC_ESC_ESC   0x5D
 #define HDLC_UFRAME    0x03
 
+/*
+ * I-frame control: N(R) << 5 | N(S) << 1
+ * S-frame control: N(R) << 5 | type << 2 | 0x01
+ */
+#define HDLC_CTRL_IS_IFRAME(ctrl) (((ctrl) & 0x01) == 0x00)
+#define HDLC_CTRL_IS_SFRAME(ctrl) (((ctrl) & 0x03) == 0x01)
+#define HDLC_CTRL_NS(ctrl)        (((ctrl) >> 1) & 0x07)
+#define HDLC_CTRL_NR(ctrl)        (((ctrl) >> 5) & 0x07)
+#define HDLC_CTRL_STYPE(ctrl)     (((ctrl) >> 2) & 0x03)
+#define HDLC_IFRAME(ns, nr)       ((uint8_t)(((nr) << 5) | ((ns) << 1)))
+#define HDLC_SFRAME(type, nr)     ((uint8_t)(((nr) << 5) | ((type) << 2) | 0x01))
+#define HDLC_SFRAME_RR            0x00
+#define HDLC_SFRAME_REJ           0x01
+#define HDLC_SEQ(x)               ((uint8_t)((x) & 0x07))
+
 #define HDLC_RX_WORKQUEUE_STACK_SIZE 2048
 #define HDLC_RX_WORKQUEUE_PRIORITY   5
 
@@ -32,6 +46,62 @@ LOG_MODULE_REGISTER(greybus_hdlc, CONFIG_GREYBUS_LOG_LEVEL);
 K_WORK_DEFINE(hdlc_rx_work, hdlc_rx_handler);
 RING_BUF_DECLARE(hdlc_rx_ringbuf, HDLC_MAX_BLOCK_SIZE);
 
+#ifdef CONFIG_GREYBUS_HDLC_RELIABLE
+
+/*
+ * Frames are received, acknowledged and emitted on a work queue of their own. Senders on the
+ * system work queue may block waiting for the window, that must not hold back the ACKs freeing
+ * it. Without the window nothing waits on RX, and it stays on the system work queue.
+ */
+static K_THREAD_STACK_DEFINE(hdlc_wq_stack, HDLC_RX_WORKQUEUE_STACK_SIZE);
+static struct k_work_q hdlc_wq;
+static bool hdlc_wq_started;
+
+#define HDLC_WINDOW_SIZE CONFIG_GREYBUS_HDLC_WINDOW_SIZE
+
+static void hdlc_tx_handler(struct k_work *);
+static void hdlc_retransmit_handler(struct k_work *);
+
+struct hdlc_tx_slot {
+	uint16_t len;
+	uint8_t address;
+	uint8_t buffer[HDLC_MAX_BLOCK_SIZE];
+};
+
+/*
+ * Go-back-N transmit window and receive state.
+ *
+ * All frames are emitted from tx_work, and received frames are processed from hdlc_rx_work, both
+ * on hdlc_wq. A slot is thus never released while it is being transmitted.
+ *
+ * @va: oldest unacknowledged sequence number
+ * @vt: next sequence number to transmit
+ * @vs: next sequence number to queue
+ * @vr: next sequence number expected from peer
+ * @va_slot: slot index of va
+ * @ack_address: address used for supervisory frames
+ * @peer_reliable: an I-frame was received, the peer understands supervisory frames
+ */
+struct hdlc_window {
+	struct hdlc_tx_slot slots[HDLC_WINDOW_SIZE];
+	struct k_spinlock lock;
+	struct k_sem free_slots;
+	struct k_work tx_work;
+	struct k_work_delayable retransmit_work;
+	uint8_t va;
+	uint8_t vt;
+	uint8_t vs;
+	uint8_t vr;
+	uint8_t va_slot;
+	uint8_t ack_address;
+	bool ack_pending;
+	bool rej_pending;
+	bool rej_sent;
+	bool peer_reliable;
+};
+
+#endif /* CONFIG_GREYBUS_HDLC_RELIABLE */
+
 struct hdlc_driver {
 	hdlc_process_frame_callback process_callback_frame_cb;
 	hdlc_send_frame_callback send_frame_cb;
@@ -40,6 +110,11 @@ struct hdlc_driver {
 	uint16_t rx_buffer_len;
 	uint8_t rx_buffer[HDLC_MAX_BLOCK_SIZE];
 	bool next_escaped;
+
+	struct hdlc_stats stats;
+#ifdef CONFIG_GREYBUS_HDLC_RELIABLE
+	struct hdlc_window window;
+#endif
 };
 
 static struct hdlc_driver hdlc_driver;
@@ -57,6 +132,27 @@ static void uart_poll_out_crc(uint8_t byte, uint16_t *crc)
 	hdlc_driver.send_frame_cb(&byte, 1);
 }
 
+static void hdlc_frame_emit(uint8_t address, uint8_t ctrl, const uint8_t *buffer,
+			    size_t buffer_len)
+{
+	uint8_t temp = HDLC_FRAME;
+	uint16_t crc = 0xffff;
+
+	hdlc_driver.send_frame_cb(&temp, 1);
+	uart_poll_out_crc(address, &crc);
+	uart_poll_out_crc(ctrl, &crc);
+
+	for (int i = 0; i < buffer_len; i++) {
+		uart_poll_out_crc(buffer[i], &crc);
+	}
+
+	uint16_t crc_calc = crc ^ 0xffff;
+
+	uart_poll_out_crc(crc_calc, &crc);
+	uart_poll_out_crc(crc_calc >> 8, &crc);
+	hdlc_driver.send_frame_cb(&temp, 1);
+}
+
 static void hdlc_process_complete_frame(struct hdlc_driver *drv)
 {
 	int ret;
@@ -68,17 +164,306 @@ static void hdlc_process_complete_frame(struct hdlc_driver *drv)
 	if (ret < 0) {
 		LOG_ERR("Dropped HDLC addr:%x ctrl:%x", address, drv->rx_buffer[1]);
 		LOG_HEXDUMP_DBG(drv->rx_buffer, drv->rx_buffer_len, "rx_buffer");
+		return;
+	}
+
+	drv->stats.rx_frames++;
+}
+
+#ifdef CONFIG_GREYBUS_HDLC_RELIABLE
+
+static struct hdlc_tx_slot *hdlc_window_slot(struct hdlc_window *win, uint8_t seq)
+{
+	return &win->slots[(win->va_slot + HDLC_SEQ(seq - win->va)) % HDLC_WINDOW_SIZE];
+}
+
+static void hdlc_tx_handler(struct k_work *work)
+{
+	struct hdlc_window *win = CONTAINER_OF(work, struct hdlc_window, tx_work);
+	const struct hdlc_tx_slot *slot;
+	k_spinlock_key_t key;
+	uint8_t ctrl;
+	bool send_rej;
+	bool send_rr;
+
+	while (true) {
+		key = k_spin_lock(&win->lock);
+
+		send_rej = win->rej_pending;
+		win->rej_pending = false;
+
+		if (!send_rej && win->vt != win->vs) {
+			slot = hdlc_window_slot(win, win->vt);
+			ctrl = HDLC_IFRAME(win->vt, win->vr);
+			win->vt = HDLC_SEQ(win->vt + 1);
+			/* N(R) of the I-frame acknowledges everything received so far */
+			win->ack_pending = false;
+			k_spin_unlock(&win->lock, key);
+
+			hdlc_frame_emit(slot->address, ctrl, slot->buffer, slot->len);
+			k_work_schedule_for_queue(
+				&hdlc_wq, &win->retransmit_work,
+				K_MSEC(CONFIG_GREYBUS_HDLC_RETRANSMIT_TIMEOUT_MS));
+			continue;
+		}
+
+		send_rr = !send_rej && win->ack_pending;
+		win->ack_pending = false;
+		ctrl = HDLC_SFRAME(send_rej ? HDLC_SFRAME_REJ : HDLC_SFRAME_RR, win->vr);
+		k_spin_unlock(&win->lock, key);
+
+		if (!send_rej && !send_rr) {
+			return;
+		}
+
+		hdlc_frame_emit(win->ack_address, ctrl, NULL, 0);
+	}
+}
+
+static void hdlc_retransmit(struct hdlc_driver *drv)
+{
+	struct hdlc_window *win = &drv->window;
+	k_spinlock_key_t key = k_spin_lock(&win->lock);
+
+	drv->stats.tx_retransmits += HDLC_SEQ(win->vt - win->va);
+	win->vt = win->va;
+
+	k_spin_unlock(&win->lock, key);
+
+	k_work_submit_to_queue(&hdlc_wq, &win->tx_work);
+}
+
+static void hdlc_retransmit_handler(struct k_work *work)
+{
+	struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+	struct hdlc_window *win = CONTAINER_OF(dwork, struct hdlc_window, retransmit_work);
+
+	if (win->va == win->vs) {
+		return;
+	}
+
+	LOG_DBG("HDLC ack timeout, va:%u vs:%u", win->va, win->vs);
+	hdlc_driver.stats.tx_timeouts++;
+	hdlc_retransmit(&hdlc_driver);
+}
+
+/*
+ * Process a cumulative acknowledgement. All frames before N(R) have been received by the peer.
+ */
+static void hdlc_rx_ack(struct hdlc_driver *drv, uint8_t nr)
+{
+	struct hdlc_window *win = &drv->window;
+	k_spinlock_key_t key;
+	uint8_t acked;
+	bool idle;
+
+	key = k_spin_lock(&win->lock);
+
+	acked = HDLC_SEQ(nr - win->va);
+	if (acked == 0 || acked > HDLC_SEQ(win->vs - win->va)) {
+		k_spin_unlock(&win->lock, key);
+		return;
+	}
+
+	/* A retransmission may still be pending for frames the peer already has */
+	if (HDLC_SEQ(win->vt - win->va) < acked) {
+		win->vt = nr;
+	}
+
+	win->va = nr;
+	win->va_slot = (win->va_slot + acked) % HDLC_WINDOW_SIZE;
+	idle = win->va == win->vs;
+
+	k_spin_unlock(&win->lock, key);
+
+	while (acked--) {
+		k_sem_give(&win->free_slots);
+	}
+
+	if (idle) {
+		k_work_cancel_delayable(&win->retransmit_work);
+	} else {
+		k_work_reschedule_for_queue(&hdlc_wq, &win->retransmit_work,
+					    K_MSEC(CONFIG_GREYBUS_HDLC_RETRANSMIT_TIMEOUT_MS));
 	}
 }
 
+static bool hdlc_peer_reliable(struct hdlc_driver *drv)
+{
+	struct hdlc_window *win = &drv->window;
+	k_spinlock_key_t key = k_spin_lock(&win->lock);
+	const bool reliable = win->peer_reliable;
+
+	k_spin_unlock(&win->lock, key);
+
+	return reliable;
+}
+
+static void hdlc_request_reject(struct hdlc_driver *drv)
+{
+	struct hdlc_window *win = &drv->window;
+	k_spinlock_key_t key = k_spin_lock(&win->lock);
+
+	/* Only one reject per gap, the peer goes back to N(R) anyway. Later frames get an RR. */
+	if (!win->rej_sent) {
+		win->rej_sent = true;
+		win->rej_pending = true;
+		drv->stats.rej_sent++;
+	} else {
+		win->ack_pending = true;
+	}
+
+	k_spin_unlock(&win->lock, key);
+
+	k_work_submit_to_queue(&hdlc_wq, &win->tx_work);
+}
+
+/*
+ * Plain go-back-N: only the frame at V(R) is accepted. Retransmissions of delivered frames can't
+ * be told apart from frames after a gap with 3-bit sequence numbers, both are rejected. The reject
+ * points the peer at V(R), which also acknowledges the duplicate.
+ */
+static void hdlc_rx_iframe(struct hdlc_driver *drv, uint8_t ctrl)
+{
+	struct hdlc_window *win = &drv->window;
+	uint8_t ns = HDLC_CTRL_NS(ctrl);
+	k_spinlock_key_t key;
+	bool in_sequence;
+
+	hdlc_rx_ack(drv, HDLC_CTRL_NR(ctrl));
+
+	key = k_spin_lock(&win->lock);
+
+	win->ack_address = drv->rx_buffer[0];
+	win->peer_reliable = true;
+	in_sequence = ns == win->vr;
+
+	if (in_sequence) {
+		win->vr = HDLC_SEQ(win->vr + 1);
+		win->rej_sent = false;
+		win->ack_pending = true;
+	}
+
+	k_spin_unlock(&win->lock, key);
+
+	if (in_sequence) {
+		hdlc_process_complete_frame(drv);
+		k_work_submit_to_queue(&hdlc_wq, &win->tx_work);
+	} else {
+		drv->stats.rx_out_of_seq++;
+		hdlc_request_reject(drv);
+	}
+}
+
+static void hdlc_rx_sframe(struct hdlc_driver *drv, uint8_t ctrl)
+{
+	hdlc_rx_ack(drv, HDLC_CTRL_NR(ctrl));
+
+	if (HDLC_CTRL_STYPE(ctrl) == HDLC_SFRAME_REJ) {
+		drv->stats.rej_received++;
+		hdlc_retransmit(drv);
+	}
+}
+
+static int hdlc_window_queue(const uint8_t *buffer, size_t buffer_len, uint8_t address)
+{
+	struct hdlc_window *win = &hdlc_driver.window;
+	struct hdlc_tx_slot *slot;
+	k_timeout_t timeout = K_MSEC(CONFIG_GREYBUS_HDLC_SEND_TIMEOUT_MS);
+	k_spinlock_key_t key;
+	int ret;
+
+	if (buffer_len > HDLC_MAX_BLOCK_SIZE) {
+		return -EMSGSIZE;
+	}
+
+	/* Waiting on hdlc_wq would block the ACKs that free a slot */
+	if (k_is_in_isr() || k_current_get() == k_work_queue_thread_get(&hdlc_wq)) {
+		timeout = K_NO_WAIT;
+	}
+
+	ret = k_sem_take(&win->free_slots, timeout);
+	if (ret < 0) {
+		LOG_WRN("HDLC window full");
+		return -EAGAIN;
+	}
+
+	key = k_spin_lock(&win->lock);
+
+	slot = hdlc_window_slot(win, win->vs);
+	memcpy(slot->buffer, buffer, buffer_len);
+	slot->len = buffer_len;
+	slot->address = address;
+	win->vs = HDLC_SEQ(win->vs + 1);
+	hdlc_driver.stats.tx_frames++;
+
+	k_spin_unlock(&win->lock, key);
+
+	k_work_submit_to_queue(&hdlc_wq, &win->tx_work);
+
+	return 0;
+}
+
+static void hdlc_window_init(struct hdlc_window *win)
+{
+	win->va = 0;
+	win->vt = 0;
+	win->vs = 0;
+	win->vr = 0;
+	win->va_slot = 0;
+	win->ack_address = 0;
+	win->ack_pending = false;
+	win->rej_pending = false;
+	win->rej_sent = false;
+	win->peer_reliable = false;
+
+	k_sem_init(&win->free_slots, HDLC_WINDOW_SIZE, HDLC_WINDOW_SIZE);
+	k_work_init(&win->tx_work, hdlc_tx_handler);
+	k_work_init_delayable(&win->retransmit_work, hdlc_retransmit_handler);
+}
+
+#endif /* CONFIG_GREYBUS_HDLC_RELIABLE */
+
+static void hdlc_dispatch_frame(struct hdlc_driver *drv)
+{
+	uint8_t ctrl = drv->rx_buffer[1];
+
+	if (ctrl == HDLC_UFRAME) {
+		hdlc_process_complete_frame(drv);
+		return;
+	}
+
+#ifdef CONFIG_GREYBUS_HDLC_RELIABLE
+	if (HDLC_CTRL_IS_IFRAME(ctrl)) {
+		hdlc_rx_iframe(drv, ctrl);
+		return;
+	}
+
+	if (HDLC_CTRL_IS_SFRAME(ctrl)) {
+		hdlc_rx_sframe(drv, ctrl);
+		return;
+	}
+#endif /* CONFIG_GREYBUS_HDLC_RELIABLE */
+
+	LOG_ERR("Dropped HDLC unsupported ctrl:%x", ctrl);
+}
+
 static void hdlc_process_frame(struct hdlc_driver *drv)
 {
 	if (drv->rx_buffer_len > 3 && drv->crc == 0xf0b8) {
-		uint8_t ctrl = drv->rx_buffer[1];
-                assert(ctrl == HDLC_UFRAME);
-		hdlc_process_complete_frame(drv);
+		hdlc_dispatch_frame(drv);
 	} else {
 		LOG_ERR("Dropped HDLC crc:%04x len:%d", drv->crc, drv->rx_buffer_len);
+		drv->stats.rx_crc_errors++;
+#ifdef CONFIG_GREYBUS_HDLC_RELIABLE
+		/*
+		 * Do not wait for the ack timeout if a whole frame got corrupted. A peer only sending
+		 * U-frames can't parse the reject.
+		 */
+		if (drv->rx_buffer_len > 3 && hdlc_peer_reliable(drv)) {
+			hdlc_request_reject(drv);
+		}
+#endif
 	}
 
 	drv->crc = 0xffff;
@@ -89,6 +474,7 @@ static int hdlc_save_byte(struct hdlc_driver *drv, uint8_t byte)
 {
 	if (drv->rx_buffer_len >= HDLC_MAX_BLOCK_SIZE) {
 		LOG_ERR("HDLC RX Buffer Overflow");
+		drv->stats.rx_overflows++;
 		drv->crc = 0xffff;
 		drv->rx_buffer_len = 0;
 	}
@@ -148,24 +534,14 @@ static void hdlc_rx_handler(struct k_work *work)
 
 int hdlc_block_send_sync(const uint8_t *buffer, size_t buffer_len, uint8_t address)
 {
-	uint8_t temp = HDLC_FRAME;
-	uint16_t crc = 0xffff;
-
-	hdlc_driver.send_frame_cb(&temp, 1);
-	uart_poll_out_crc(address, &crc);
-	uart_poll_out_crc(HDLC_UFRAME, &crc);
-
-	for (int i = 0; i < buffer_len; i++) {
-		uart_poll_out_crc(buffer[i], &crc);
-	}
-
-	uint16_t crc_calc = crc ^ 0xffff;
-
-	uart_poll_out_crc(crc_calc, &crc);
-	uart_poll_out_crc(crc_calc >> 8, &crc);
-	hdlc_driver.send_frame_cb(&temp, 1);
+#ifdef CONFIG_GREYBUS_HDLC_RELIABLE
+	return hdlc_window_queue(buffer, buffer_len, address);
+#else
+	hdlc_frame_emit(address, HDLC_UFRAME, buffer, buffer_len);
+	hdlc_driver.stats.tx_frames++;
 
 	return 0;
+#endif
 }
 
 int hdlc_init(hdlc_process_frame_callback process_cb, hdlc_send_frame_callback send_cb)
@@ -173,10 +549,22 @@ int hdlc_init(hdlc_process_frame_callback process_cb, hdlc_send_frame_callback s
 	hdlc_driver.crc = 0xffff;
 	hdlc_driver.next_escaped = false;
 	hdlc_driver.rx_buffer_len = 0;
+	memset(&hdlc_driver.stats, 0, sizeof(hdlc_driver.stats));
 
 	hdlc_driver.process_callback_frame_cb = process_cb;
 	hdlc_driver.send_frame_cb = send_cb;
 
+#ifdef CONFIG_GREYBUS_HDLC_RELIABLE
+	if (!hdlc_wq_started) {
+		k_work_queue_start(&hdlc_wq, hdlc_wq_stack, K_THREAD_STACK_SIZEOF(hdlc_wq_stack),
+				   HDLC_RX_WORKQUEUE_PRIORITY, NULL);
+		k_thread_name_set(&hdlc_wq.thread, "greybus_hdlc");
+		hdlc_wq_started = true;
+	}
+
+	hdlc_window_init(&hdlc_driver.window);
+#endif
+
 	return 0;
 }
 
@@ -190,7 +578,16 @@ int hdlc_rx_finish(uint32_t written)
 	int ret;
 
 	ret = ring_buf_put_finish(&hdlc_rx_ringbuf, written);
+#ifdef CONFIG_GREYBUS_HDLC_RELIABLE
+	k_work_submit_to_queue(&hdlc_wq, &hdlc_rx_work);
+#else
 	k_work_submit(&hdlc_rx_work);
+#endif
 
 	return ret;
 }
+
+void hdlc_stats_get(struct hdlc_stats *stats)
+{
+	memcpy(stats, &hdlc_driver.stats, sizeof(*stats));
+}
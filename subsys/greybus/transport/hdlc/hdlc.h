@@ -12,6 +12,31 @@
 
 #define HDLC_MAX_BLOCK_SIZE 512
 
+/*
+ * HDLC link statistics
+ *
+ * @rx_frames: frames delivered to the process callback
+ * @rx_crc_errors: frames dropped due to bad CRC or short length
+ * @rx_overflows: frames dropped due to RX buffer overflow
+ * @rx_out_of_seq: I-frames dropped because of unexpected sequence number, including duplicates
+ * @tx_frames: I-frames or U-frames queued for transmission
+ * @tx_retransmits: I-frames retransmitted
+ * @tx_timeouts: acknowledgement timer expiries
+ * @rej_sent: reject frames sent to the peer
+ * @rej_received: reject frames received from the peer
+ */
+struct hdlc_stats {
+	uint32_t rx_frames;
+	uint32_t rx_crc_errors;
+	uint32_t rx_overflows;
+	uint32_t rx_out_of_seq;
+	uint32_t tx_frames;
+	uint32_t tx_retransmits;
+	uint32_t tx_timeouts;
+	uint32_t rej_sent;
+	uint32_t rej_received;
+};
+
 /*
  * Calback to process a received HDLC frame
  *
@@ -43,6 +68,10 @@ int hdlc_init(hdlc_process_frame_callback process_cb, hdlc_send_frame_callback s
 /*
  * Submit an HDLC Block synchronously
  *
+ * With CONFIG_GREYBUS_HDLC_RELIABLE, the block is copied into the transmit window and this
+ * returns once the block is queued. It blocks while the window is full, unless called from ISR
+ * or from the HDLC work queue.
+ *
  * @param buffer
  * @param buffer_length
  * @param address
@@ -69,4 +98,11 @@ uint32_t hdlc_rx_start(uint8_t **buffer);
  */
 int hdlc_rx_finish(uint32_t written);
 
+/*
+ * Get a snapshot of HDLC link statistics
+ *
+ * @param stats: destination
+ */
+void hdlc_stats_get(struct hdlc_stats *stats);
+
 #endif
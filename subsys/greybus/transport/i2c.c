@@ -9,127 +9,308 @@
 #include <zephyr/kernel.h>
 #include <greybus-utils/manifest.h>
 #include <zephyr/drivers/i2c.h>
+#include <zephyr/drivers/gpio.h>
 #include <zephyr/logging/log.h>
-#include "../greybus_heap.h"
-#include <assert.h>
 
-#define PIPE_LEN 256
+/* Every message on the wire is prefixed by its cport */
+#define GB_I2C_FRAME_MAX_SIZE (sizeof(__le16) + CONFIG_GREYBUS_XPORT_I2C_MAX_MESSAGE_SIZE)
+#define GB_I2C_BUF_LEN        (GB_I2C_FRAME_MAX_SIZE * CONFIG_GREYBUS_XPORT_I2C_BUFFERED_MESSAGES)
 
 LOG_MODULE_REGISTER(greybus_transport_i2c, CONFIG_GREYBUS_LOG_LEVEL);
 
-static uint8_t ring_buf_data[PIPE_LEN];
-static struct ring_buf rx_buf;
+extern const struct gb_transport_backend GB_TRANSPORT_BACKEND(i2c);
 
-static uint8_t tx_pipe_data[PIPE_LEN];
+/*
+ * Received frames are published straight from the target callbacks. A write transaction carries
+ * one or more whole frames and becomes a single ring record. One spare record keeps the ring from
+ * filling up on fragmentation.
+ */
+GB_RX_RING_DEFINE(rx_ring,
+		  (CONFIG_GREYBUS_XPORT_I2C_BUFFERED_MESSAGES + 1) *
+			  GB_RX_RING_RECORD_SIZE(GB_I2C_FRAME_MAX_SIZE),
+		  &GB_TRANSPORT_BACKEND(i2c));
+
+static uint8_t tx_pipe_data[GB_I2C_BUF_LEN];
 static struct k_pipe tx_pipe;
+/* Keeps the cport and message of a frame together in tx_pipe */
+static K_MUTEX_DEFINE(tx_lock);
 
-static const struct device *bus = DEVICE_DT_GET(DT_ALIAS(greybus_transport));
+/*
+ * Register selected by a single byte write. Reading GB_I2C_REG_LEN returns the le16 length of
+ * the next frame (cport + message) so the controller can read exactly one frame per transaction.
+ * Register selection is reset to GB_I2C_REG_DATA after every read.
+ */
+#define GB_I2C_REG_DATA 0x00
+#define GB_I2C_REG_LEN  0x01
+
+/* Staging buffer for the message currently being read by the controller */
+static uint8_t tx_frame[GB_I2C_FRAME_MAX_SIZE];
+static size_t tx_frame_len;
+static size_t tx_frame_pos;
+/* Number of messages in tx_pipe */
+static atomic_t tx_pending = ATOMIC_INIT(0);
+
+static uint8_t reg = GB_I2C_REG_DATA;
+static uint8_t len_reg[sizeof(__le16)];
+static uint8_t len_reg_pos;
+static uint8_t wr_first;
+static size_t wr_count;
+/* Ring space claimed for the current write transaction, NULL while dropping it */
+static uint8_t *wr_buf;
+static bool rd_active;
 
-static void gb_msg_process_cb(struct k_work *work);
-static K_WORK_DEFINE(gb_msg_process_work, gb_msg_process_cb);
+static const struct device *bus = DEVICE_DT_GET(DT_ALIAS(greybus_transport));
 
-/**
- * Format for greybus message header in ring buffer. This will optionally be followed by payload.
+/*
+ * Optional line asserted while the node has messages for the host. Specified as:
+ *
+ *	zephyr,user {
+ *		greybus-int-gpios = <&gpio0 5 GPIO_ACTIVE_HIGH>;
+ *	};
  */
-struct rx_ring_data_header {
-	__le16 cport;
-	struct gb_operation_msg_hdr hdr;
-} __packed;
+static const struct gpio_dt_spec data_ready =
+	GPIO_DT_SPEC_GET_OR(DT_PATH(zephyr_user), greybus_int_gpios, {0});
 
-static int gb_msg_rx_take(struct gb_msg_with_cport *msg)
+/*
+ * Stage the next queued message for the controller to read.
+ *
+ * @return 0 if a message is staged, -ENODATA otherwise.
+ */
+static int tx_frame_stage(void)
 {
+	const size_t hdr_len = sizeof(__le16) + sizeof(struct gb_operation_msg_hdr);
+	const struct gb_operation_msg_hdr *hdr =
+		(const struct gb_operation_msg_hdr *)&tx_frame[sizeof(__le16)];
+	size_t payload_len;
 	int ret;
-	uint16_t data_len;
-	struct rx_ring_data_header hdr;
 
-	if (ring_buf_size_get(&rx_buf) < sizeof(hdr)) {
-		return -ENODATA;
+	if (tx_frame_pos < tx_frame_len) {
+		return 0;
 	}
 
-	ret = ring_buf_peek(&rx_buf, (uint8_t *)&hdr, sizeof(hdr));
-	if (ret < sizeof(hdr)) {
+	tx_frame_pos = 0;
+	tx_frame_len = 0;
+
+	if (atomic_get(&tx_pending) == 0) {
 		return -ENODATA;
 	}
 
-	data_len = gb_hdr_message_len(&hdr.hdr);
-	if (ring_buf_size_get(&rx_buf) < sizeof(uint16_t) + data_len) {
+	ret = k_pipe_read(&tx_pipe, tx_frame, hdr_len, K_NO_WAIT);
+	if (ret != hdr_len) {
 		return -ENODATA;
 	}
 
-	msg->msg = gb_alloc(data_len);
-	if (!msg->msg) {
-		LOG_ERR("Failed to allocate message");
-		return -ENOMEM;
+	payload_len = MIN(gb_hdr_payload_len(hdr), sizeof(tx_frame) - hdr_len);
+	if (payload_len > 0) {
+		ret = k_pipe_read(&tx_pipe, &tx_frame[hdr_len], payload_len, K_NO_WAIT);
+		if (ret != payload_len) {
+			return -ENODATA;
+		}
 	}
 
-	msg->cport = sys_le16_to_cpu(hdr.cport);
+	atomic_dec(&tx_pending);
+	tx_frame_len = hdr_len + payload_len;
+
+	return 0;
+}
 
-	ret = ring_buf_get(&rx_buf, NULL, sizeof(uint16_t));
-	__ASSERT(ret == sizeof(scratch), "Failed to get cport");
+/*
+ * Keep the data ready line asserted while anything is left to read.
+ */
+static void data_ready_update(void)
+{
+	if (!data_ready.port) {
+		return;
+	}
 
-	ret = ring_buf_get(&rx_buf, (uint8_t *)msg->msg, data_len);
-	__ASSERT(ret == data_len, "Failed to get greybus message");
+	gpio_pin_set_dt(&data_ready, tx_frame_pos < tx_frame_len || atomic_get(&tx_pending) > 0);
+}
 
-	return 0;
+static void len_reg_latch(void)
+{
+	tx_frame_stage();
+	sys_put_le16(tx_frame_len - tx_frame_pos, len_reg);
 }
 
-static void gb_msg_process_cb(struct k_work *work)
+static void reg_select(uint8_t val)
 {
-	struct gb_msg_with_cport msg;
+	if (val == GB_I2C_REG_LEN) {
+		reg = GB_I2C_REG_LEN;
+		len_reg_pos = 0;
+	} else {
+		reg = GB_I2C_REG_DATA;
+	}
+}
 
-        ARG_UNUSED(work);
+/*
+ * Complete a write transfer. Called on stop and on repeated start.
+ */
+static void write_finish(void)
+{
+	if (wr_count == 1) {
+		reg_select(wr_first);
+	} else if (wr_count > 1 && wr_buf) {
+		gb_rx_ring_commit(&rx_ring, wr_count);
+	}
 
-	while (gb_msg_rx_take(&msg) == 0) {
-		if (greybus_rx_handler(msg.cport, msg.msg) < 0) {
-			LOG_ERR("Failed to handle greybus message");
-		}
+	wr_count = 0;
+	wr_buf = NULL;
+}
+
+/*
+ * Complete a read transfer. Called on stop and on repeated start.
+ */
+static void read_finish(void)
+{
+	if (rd_active) {
+		rd_active = false;
+		reg = GB_I2C_REG_DATA;
+		data_ready_update();
 	}
 }
 
 static int i2c_target_write_requested_cb(struct i2c_target_config *config)
 {
+	ARG_UNUSED(config);
+
+	read_finish();
+	write_finish();
+
 	return 0;
 }
 
 static int i2c_target_write_received_cb(struct i2c_target_config *config, uint8_t val)
 {
-	int ret;
+	ARG_UNUSED(config);
+
+	/* Hold back the first byte, a single byte write is a register select */
+	if (wr_count++ == 0) {
+		wr_first = val;
+		return 0;
+	}
+
+	if (wr_count == 2) {
+		wr_buf = gb_rx_ring_claim(&rx_ring, GB_I2C_FRAME_MAX_SIZE);
+		if (wr_buf) {
+			wr_buf[0] = wr_first;
+		}
+	}
 
-	ret = ring_buf_put(&rx_buf, &val, sizeof(val));
-	if (ret != sizeof(val)) {
+	if (!wr_buf || wr_count > GB_I2C_FRAME_MAX_SIZE) {
 		LOG_DBG("Dropping data");
+		wr_buf = NULL;
 		return -ENOMEM;
 	}
 
+	wr_buf[wr_count - 1] = val;
+
 	return 0;
 }
 
 static int i2c_target_stop_cb(struct i2c_target_config *config)
 {
-	k_work_submit(&gb_msg_process_work);
+	ARG_UNUSED(config);
+
+	read_finish();
+	write_finish();
 
 	return 0;
 }
 
 static int i2c_target_read_cb(struct i2c_target_config *config, uint8_t *val)
 {
-	int ret;
+	ARG_UNUSED(config);
 
-	ret = k_pipe_read(&tx_pipe, val, sizeof(*val), K_NO_WAIT);
-	if (ret != sizeof(*val)) {
+	if (!rd_active) {
+		write_finish();
+		rd_active = true;
+		if (reg == GB_I2C_REG_LEN) {
+			len_reg_latch();
+		}
+	}
+
+	if (reg == GB_I2C_REG_LEN) {
+		*val = (len_reg_pos < sizeof(len_reg)) ? len_reg[len_reg_pos++] : 0;
+		return 0;
+	}
+
+	if (tx_frame_stage() < 0) {
 		LOG_DBG("Failed to read data");
 		return -ENODATA;
 	}
 
+	*val = tx_frame[tx_frame_pos++];
+
 	return 0;
 }
 
+#ifdef CONFIG_I2C_TARGET_BUFFER_MODE
+static void i2c_target_buf_write_received_cb(struct i2c_target_config *config, uint8_t *ptr,
+					     uint32_t len)
+{
+	uint8_t *buf;
+
+	ARG_UNUSED(config);
+
+	read_finish();
+
+	if (len == 1) {
+		reg_select(ptr[0]);
+		return;
+	}
+
+	buf = gb_rx_ring_claim(&rx_ring, len);
+	if (!buf) {
+		LOG_DBG("Dropping data");
+		return;
+	}
+
+	memcpy(buf, ptr, len);
+	gb_rx_ring_commit(&rx_ring, len);
+}
+
+/*
+ * Hand out exactly one queued message per read transaction.
+ */
+static int i2c_target_buf_read_requested_cb(struct i2c_target_config *config, uint8_t **ptr,
+					    uint32_t *len)
+{
+	ARG_UNUSED(config);
+
+	read_finish();
+	rd_active = true;
+
+	if (reg == GB_I2C_REG_LEN) {
+		len_reg_latch();
+		*ptr = len_reg;
+		*len = sizeof(len_reg);
+		return 0;
+	}
+
+	if (tx_frame_stage() < 0) {
+		LOG_DBG("Failed to read data");
+		return -ENODATA;
+	}
+
+	*ptr = &tx_frame[tx_frame_pos];
+	*len = tx_frame_len - tx_frame_pos;
+	tx_frame_pos = tx_frame_len;
+	data_ready_update();
+
+	return 0;
+}
+#endif /* CONFIG_I2C_TARGET_BUFFER_MODE */
+
 static const struct i2c_target_callbacks target_cbs = {
 	.read_requested = i2c_target_read_cb,
 	.read_processed = i2c_target_read_cb,
 	.write_requested = i2c_target_write_requested_cb,
 	.write_received = i2c_target_write_received_cb,
 	.stop = i2c_target_stop_cb,
+#ifdef CONFIG_I2C_TARGET_BUFFER_MODE
+	.buf_write_received = i2c_target_buf_write_received_cb,
+	.buf_read_requested = i2c_target_buf_read_requested_cb,
+#endif
 };
 
 static struct i2c_target_config target_cfg = {
@@ -146,8 +327,29 @@ static int gb_trans_init()
 		return -ENODEV;
 	}
 
+	if (data_ready.port) {
+		if (!gpio_is_ready_dt(&data_ready)) {
+			LOG_ERR("Data ready GPIO not ready");
+			return -ENODEV;
+		}
+
+		ret = gpio_pin_configure_dt(&data_ready, GPIO_OUTPUT_INACTIVE);
+		if (ret < 0) {
+			LOG_ERR("Failed to configure data ready GPIO: %d", ret);
+			return ret;
+		}
+	}
+
+	ret = gb_rx_ring_register(&rx_ring);
+	if (ret < 0) {
+		LOG_ERR("Failed to register RX ring: %d", ret);
+		return ret;
+	}
+
 	k_pipe_init(&tx_pipe, tx_pipe_data, sizeof(tx_pipe_data));
-	ring_buf_init(&rx_buf, ARRAY_SIZE(ring_buf_data), ring_buf_data);
+	atomic_set(&tx_pending, 0);
+	tx_frame_len = 0;
+	tx_frame_pos = 0;
 
 	ret = i2c_target_register(bus, &target_cfg);
 	if (ret < 0) {
@@ -161,7 +363,6 @@ static int gb_trans_init()
 static void gb_trans_exit(void)
 {
 	k_pipe_close(&tx_pipe);
-	ring_buf_reset(&rx_buf);
 
 	if (i2c_target_unregister(bus, &target_cfg) < 0) {
 		LOG_ERR("Failed to unregister target\n");
@@ -180,22 +381,45 @@ static int gb_trans_send(uint16_t cport, const struct gb_message *msg)
 	const __le16 cport_le = sys_cpu_to_le16(cport);
 	int ret;
 
+	if (gb_message_len(msg) > CONFIG_GREYBUS_XPORT_I2C_MAX_MESSAGE_SIZE) {
+		LOG_ERR("Message too large: %zu", gb_message_len(msg));
+		return -EMSGSIZE;
+	}
+
+	k_mutex_lock(&tx_lock, K_FOREVER);
+
 	ret = k_pipe_write(&tx_pipe, (const uint8_t *)&cport_le, sizeof(cport_le), K_FOREVER);
 	if (ret != sizeof(cport_le)) {
-		return -EIO;
+		ret = -EIO;
+		goto unlock;
 	}
 
 	ret = k_pipe_write(&tx_pipe, (const uint8_t *)msg, gb_message_len(msg), K_FOREVER);
 	if (ret != gb_message_len(msg)) {
-		return -EIO;
+		ret = -EIO;
+		goto unlock;
 	}
 
-	return 0;
+	atomic_inc(&tx_pending);
+	data_ready_update();
+	ret = 0;
+
+unlock:
+	k_mutex_unlock(&tx_lock);
+
+	return ret;
+}
+
+static void gb_trans_get_caps(struct gb_transport_caps *caps)
+{
+	caps->max_message_size = CONFIG_GREYBUS_XPORT_I2C_MAX_MESSAGE_SIZE;
+	caps->preferred_message_size = CONFIG_GREYBUS_XPORT_I2C_MAX_MESSAGE_SIZE;
 }
 
-const struct gb_transport_backend gb_trans_backend = {
+const struct gb_transport_backend GB_TRANSPORT_BACKEND(i2c) = {
 	.init = gb_trans_init,
 	.exit = gb_trans_exit,
 	.listen = gb_trans_listen,
 	.send = gb_trans_send,
+	.get_caps = gb_trans_get_caps,
 };
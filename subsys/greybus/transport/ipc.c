@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2026 BeagleBoard.org
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "../greybus_transport.h"
+#include "../greybus_heap.h"
+#include <greybus/greybus.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ipc/ipc_service.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_REGISTER(greybus_transport_ipc, CONFIG_GREYBUS_LOG_LEVEL);
+
+extern const struct gb_transport_backend GB_TRANSPORT_BACKEND(ipc);
+
+/**
+ * struct gb_ipc_frame - Format of every IPC service message
+ *
+ * @cport: cport id
+ * @hdr: greybus operation header
+ * @payload: greybus message payload
+ */
+struct gb_ipc_frame {
+	__le16 cport;
+	struct gb_operation_msg_hdr hdr;
+	uint8_t payload[];
+} __packed;
+
+static const struct device *instance = DEVICE_DT_GET(DT_ALIAS(greybus_transport_ipc));
+
+static struct ipc_ept ept;
+static atomic_t bound = ATOMIC_INIT(0);
+
+/*
+ * Largest frame the backend can hand out a shared memory TX buffer for, or 0 if the backend does
+ * not support the no-copy API.
+ */
+static int tx_buffer_size;
+
+static void ept_bound_cb(void *priv)
+{
+	ARG_UNUSED(priv);
+
+	tx_buffer_size = MAX(ipc_service_get_tx_buffer_size(&ept), 0);
+	atomic_set(&bound, 1);
+
+	LOG_INF("Endpoint bound, %s TX", tx_buffer_size ? "shared buffer" : "buffered");
+}
+
+static void ept_unbound_cb(void *priv)
+{
+	ARG_UNUSED(priv);
+
+	atomic_set(&bound, 0);
+}
+
+static void ept_received_cb(const void *data, size_t len, void *priv)
+{
+	const struct gb_ipc_frame *frame = data;
+	struct gb_msg_with_cport msg;
+
+	ARG_UNUSED(priv);
+
+	if (len < sizeof(*frame) || gb_hdr_message_len(&frame->hdr) != len - sizeof(frame->cport)) {
+		LOG_ERR("Invalid frame size %zu", len);
+		return;
+	}
+
+	/* Payload is copied out once, the shared buffer is released on return */
+	msg.cport = sys_le16_to_cpu(frame->cport);
+	msg.msg = gb_message_alloc(gb_hdr_payload_len(&frame->hdr), frame->hdr.type,
+				   frame->hdr.operation_id, frame->hdr.result);
+	if (!msg.msg) {
+		LOG_ERR("Failed to allocate greybus message");
+		return;
+	}
+
+	memcpy(msg.msg->payload, frame->payload, gb_message_payload_len(msg.msg));
+
+	if (gb_transport_rx(&GB_TRANSPORT_BACKEND(ipc), msg.cport, msg.msg) < 0) {
+		LOG_ERR("Failed to handle greybus message");
+	}
+}
+
+static struct ipc_ept_cfg ept_cfg = {
+	.name = CONFIG_GREYBUS_XPORT_IPC_ENDPOINT_NAME,
+	.cb = {
+		.bound = ept_bound_cb,
+		.unbound = ept_unbound_cb,
+		.received = ept_received_cb,
+	},
+};
+
+static int gb_trans_init(void)
+{
+	int ret;
+
+	if (!device_is_ready(instance)) {
+		LOG_ERR("IPC instance not ready");
+		return -ENODEV;
+	}
+
+	ret = ipc_service_open_instance(instance);
+	if (ret < 0 && ret != -EALREADY) {
+		LOG_ERR("Failed to open IPC instance: %d", ret);
+		return ret;
+	}
+
+	ret = ipc_service_register_endpoint(instance, &ept, &ept_cfg);
+	if (ret < 0) {
+		LOG_ERR("Failed to register endpoint: %d", ret);
+		return ret;
+	}
+
+	return 0;
+}
+
+static void gb_trans_exit(void)
+{
+	atomic_set(&bound, 0);
+	ipc_service_deregister_endpoint(&ept);
+}
+
+static int gb_trans_listen(uint16_t cport)
+{
+	ARG_UNUSED(cport);
+
+	return 0;
+}
+
+/*
+ * Build the frame directly in a shared memory buffer. Messages live on the greybus heap, so this
+ * is still one copy, but no intermediate frame is built and copied again by the backend.
+ */
+static int gb_trans_send_shared(uint16_t cport, const struct gb_message *msg, size_t len)
+{
+	struct gb_ipc_frame *frame;
+	uint32_t size = len;
+	int ret;
+
+	ret = ipc_service_get_tx_buffer(&ept, (void **)&frame, &size,
+					k_is_in_isr() ? K_NO_WAIT
+						      : K_MSEC(CONFIG_GREYBUS_XPORT_IPC_TX_TIMEOUT_MS));
+	if (ret < 0) {
+		return ret;
+	}
+
+	frame->cport = sys_cpu_to_le16(cport);
+	memcpy(&frame->hdr, msg, gb_message_len(msg));
+
+	ret = ipc_service_send_nocopy(&ept, frame, len);
+	if (ret < 0) {
+		ipc_service_drop_tx_buffer(&ept, frame);
+		return ret;
+	}
+
+	return 0;
+}
+
+static int gb_trans_send_copy(uint16_t cport, const struct gb_message *msg, size_t len)
+{
+	struct gb_ipc_frame *frame = gb_alloc(len);
+	int ret;
+
+	if (!frame) {
+		return -ENOMEM;
+	}
+
+	frame->cport = sys_cpu_to_le16(cport);
+	memcpy(&frame->hdr, msg, gb_message_len(msg));
+
+	ret = ipc_service_send(&ept, frame, len);
+	gb_free(frame);
+
+	return ret;
+}
+
+static int gb_trans_send(uint16_t cport, const struct gb_message *msg)
+{
+	const size_t len = sizeof(__le16) + gb_message_len(msg);
+	int ret;
+
+	if (!atomic_get(&bound)) {
+		return -ENOTCONN;
+	}
+
+	if (tx_buffer_size > 0) {
+		if (len > tx_buffer_size) {
+			LOG_ERR("Message too large: %zu", gb_message_len(msg));
+			return -EMSGSIZE;
+		}
+
+		ret = gb_trans_send_shared(cport, msg, len);
+	} else {
+		ret = gb_trans_send_copy(cport, msg, len);
+	}
+
+	return (ret < 0) ? ret : 0;
+}
+
+/*
+ * Only the shared buffer path has a known limit, ipc_service_send() does not report one.
+ */
+static void gb_trans_get_caps(struct gb_transport_caps *caps)
+{
+	const int size = tx_buffer_size;
+
+	if (!atomic_get(&bound) || size <= (int)sizeof(__le16)) {
+		return;
+	}
+
+	caps->max_message_size = size - sizeof(__le16);
+	caps->preferred_message_size = size - sizeof(__le16);
+	caps->flags |= GB_TRANSPORT_CAP_ZERO_COPY;
+}
+
+const struct gb_transport_backend GB_TRANSPORT_BACKEND(ipc) = {
+	.init = gb_trans_init,
+	.exit = gb_trans_exit,
+	.listen = gb_trans_listen,
+	.send = gb_trans_send,
+	.get_caps = gb_trans_get_caps,
+};
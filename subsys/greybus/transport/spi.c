@@ -0,0 +1,299 @@
+/*
+ * Copyright (c) 2026 BeagleBoard.org
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "../greybus_transport.h"
+#include <greybus/greybus.h>
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/spi.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_REGISTER(greybus_transport_spi, CONFIG_GREYBUS_LOG_LEVEL);
+
+extern const struct gb_transport_backend GB_TRANSPORT_BACKEND(spi);
+
+#define GB_TRANS_SPI_STACK_SIZE     1024
+#define GB_TRANS_SPI_STACK_PRIORITY 6
+
+/**
+ * struct gb_spi_frame_hdr - Header at the start of every SPI frame
+ *
+ * Each transaction exchanges exactly one fixed size frame in both directions. A frame with zero
+ * length carries no message and only updates credits.
+ *
+ * @cport: cport id of the message
+ * @len: length of the greybus message following the header
+ * @credits: number of message frames the sender of this frame can currently accept
+ * @pad: reserved, must be zero
+ */
+struct gb_spi_frame_hdr {
+	__le16 cport;
+	__le16 len;
+	uint8_t credits;
+	uint8_t pad;
+} __packed;
+
+#define GB_SPI_FRAME_SIZE                                                                          \
+	(sizeof(struct gb_spi_frame_hdr) + CONFIG_GREYBUS_XPORT_SPI_MAX_MESSAGE_SIZE)
+
+K_THREAD_STACK_DEFINE(gb_trans_spi_stack, GB_TRANS_SPI_STACK_SIZE);
+static struct k_thread spi_thread;
+
+static K_MSGQ_DEFINE(tx_msgq, sizeof(struct gb_msg_with_cport),
+		     CONFIG_GREYBUS_XPORT_SPI_TX_QUEUE_SIZE, 4);
+static K_MSGQ_DEFINE(rx_msgq, sizeof(struct gb_msg_with_cport),
+		     CONFIG_GREYBUS_XPORT_SPI_RX_CREDITS, 4);
+
+/* Frame buffers are handed to the SPI driver as single contiguous transfers, suitable for DMA */
+static uint8_t tx_frame[GB_SPI_FRAME_SIZE] __aligned(4);
+static uint8_t rx_frame[GB_SPI_FRAME_SIZE] __aligned(4);
+
+/* Number of message frames the controller can currently accept */
+static uint8_t host_credits;
+
+static const struct device *bus = DEVICE_DT_GET(DT_ALIAS(greybus_transport_spi));
+
+static const struct spi_config spi_cfg = {
+	.operation = SPI_OP_MODE_SLAVE | SPI_WORD_SET(8) | SPI_TRANSFER_MSB,
+};
+
+/*
+ * Optional line asserted while the node has messages for the host. Specified as:
+ *
+ *	zephyr,user {
+ *		greybus-int-gpios = <&gpio0 5 GPIO_ACTIVE_HIGH>;
+ *	};
+ */
+static const struct gpio_dt_spec data_ready =
+	GPIO_DT_SPEC_GET_OR(DT_PATH(zephyr_user), greybus_int_gpios, {0});
+
+static void gb_msg_process_cb(struct k_work *work)
+{
+	struct gb_msg_with_cport msg;
+
+	ARG_UNUSED(work);
+
+	while (k_msgq_get(&rx_msgq, &msg, K_NO_WAIT) == 0) {
+		if (gb_transport_rx(&GB_TRANSPORT_BACKEND(spi), msg.cport, msg.msg) < 0) {
+			LOG_ERR("Failed to handle greybus message");
+		}
+	}
+}
+
+static K_WORK_DEFINE(gb_msg_process_work, gb_msg_process_cb);
+
+static void data_ready_set(bool pending)
+{
+	if (data_ready.port) {
+		gpio_pin_set_dt(&data_ready, pending);
+	}
+}
+
+/*
+ * Fill the next outgoing frame. A message is only placed in the frame if the controller has
+ * credits left.
+ *
+ * @return true if the frame carries a message.
+ */
+static bool tx_frame_prepare(void)
+{
+	struct gb_spi_frame_hdr *hdr = (struct gb_spi_frame_hdr *)tx_frame;
+	struct gb_msg_with_cport msg;
+	bool has_msg = false;
+
+	if (host_credits > 0 && k_msgq_get(&tx_msgq, &msg, K_NO_WAIT) == 0) {
+		hdr->cport = sys_cpu_to_le16(msg.cport);
+		hdr->len = sys_cpu_to_le16(gb_message_len(msg.msg));
+		memcpy(&tx_frame[sizeof(*hdr)], msg.msg, gb_message_len(msg.msg));
+		gb_message_dealloc(msg.msg);
+		has_msg = true;
+	} else {
+		hdr->cport = 0;
+		hdr->len = 0;
+	}
+
+	hdr->credits = MIN(k_msgq_num_free_get(&rx_msgq), UINT8_MAX);
+	hdr->pad = 0;
+
+	return has_msg;
+}
+
+static void rx_frame_process(void)
+{
+	const struct gb_spi_frame_hdr *hdr = (const struct gb_spi_frame_hdr *)rx_frame;
+	const struct gb_operation_msg_hdr *msg_hdr =
+		(const struct gb_operation_msg_hdr *)&rx_frame[sizeof(*hdr)];
+	const uint16_t len = sys_le16_to_cpu(hdr->len);
+	struct gb_msg_with_cport msg;
+
+	host_credits = hdr->credits;
+
+	if (len == 0) {
+		return;
+	}
+
+	if (len < sizeof(*msg_hdr) || len > CONFIG_GREYBUS_XPORT_SPI_MAX_MESSAGE_SIZE ||
+	    gb_hdr_message_len(msg_hdr) != len) {
+		LOG_ERR("Invalid message size %u", len);
+		return;
+	}
+
+	msg.cport = sys_le16_to_cpu(hdr->cport);
+	msg.msg = gb_message_alloc(gb_hdr_payload_len(msg_hdr), msg_hdr->type,
+				   msg_hdr->operation_id, msg_hdr->result);
+	if (!msg.msg) {
+		LOG_ERR("Failed to allocate greybus message");
+		return;
+	}
+
+	memcpy(msg.msg->payload, &rx_frame[sizeof(*hdr) + sizeof(*msg_hdr)],
+	       gb_message_payload_len(msg.msg));
+
+	if (k_msgq_put(&rx_msgq, &msg, K_NO_WAIT) < 0) {
+		LOG_ERR("No credits left, dropping message");
+		gb_message_dealloc(msg.msg);
+		return;
+	}
+
+	k_work_submit(&gb_msg_process_work);
+}
+
+/*
+ * Handler function for the SPI thread. The driver blocks until the controller clocks a frame.
+ */
+static void gb_trans_spi_thread_handler(void *p1, void *p2, void *p3)
+{
+	const struct spi_buf tx_buf = {.buf = tx_frame, .len = sizeof(tx_frame)};
+	const struct spi_buf rx_buf = {.buf = rx_frame, .len = sizeof(rx_frame)};
+	const struct spi_buf_set tx = {.buffers = &tx_buf, .count = 1};
+	const struct spi_buf_set rx = {.buffers = &rx_buf, .count = 1};
+	bool staged = false;
+	int ret;
+
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (true) {
+		/* A message that failed to go out is retried as is */
+		if (!staged) {
+			staged = tx_frame_prepare();
+		} else {
+			((struct gb_spi_frame_hdr *)tx_frame)->credits =
+				MIN(k_msgq_num_free_get(&rx_msgq), UINT8_MAX);
+		}
+
+		data_ready_set(staged || k_msgq_num_used_get(&tx_msgq) > 0);
+
+		ret = spi_transceive(bus, &spi_cfg, &tx, &rx);
+		if (ret < 0) {
+			LOG_ERR("SPI transfer failed: %d", ret);
+			continue;
+		}
+
+		rx_frame_process();
+
+		/* Credits from the controller do not account for the frame it just received */
+		if (staged) {
+			host_credits = (host_credits > 0) ? host_credits - 1 : 0;
+			staged = false;
+		}
+	}
+}
+
+static int gb_trans_init(void)
+{
+	int ret;
+
+	if (!device_is_ready(bus)) {
+		LOG_ERR("SPI bus not ready");
+		return -ENODEV;
+	}
+
+	if (data_ready.port) {
+		if (!gpio_is_ready_dt(&data_ready)) {
+			LOG_ERR("Data ready GPIO not ready");
+			return -ENODEV;
+		}
+
+		ret = gpio_pin_configure_dt(&data_ready, GPIO_OUTPUT_INACTIVE);
+		if (ret < 0) {
+			LOG_ERR("Failed to configure data ready GPIO: %d", ret);
+			return ret;
+		}
+	}
+
+	host_credits = 0;
+
+	k_thread_create(&spi_thread, gb_trans_spi_stack, K_THREAD_STACK_SIZEOF(gb_trans_spi_stack),
+			gb_trans_spi_thread_handler, NULL, NULL, NULL, GB_TRANS_SPI_STACK_PRIORITY, 0,
+			K_NO_WAIT);
+
+	return 0;
+}
+
+static void gb_trans_exit(void)
+{
+	struct gb_msg_with_cport msg;
+
+	k_thread_abort(&spi_thread);
+
+	while (k_msgq_get(&tx_msgq, &msg, K_NO_WAIT) == 0) {
+		gb_message_dealloc(msg.msg);
+	}
+
+	data_ready_set(false);
+}
+
+static int gb_trans_listen(uint16_t cport)
+{
+	ARG_UNUSED(cport);
+
+	return 0;
+}
+
+static int gb_trans_send(uint16_t cport, const struct gb_message *msg)
+{
+	struct gb_msg_with_cport item = {
+		.cport = cport,
+	};
+	int ret;
+
+	if (gb_message_len(msg) > CONFIG_GREYBUS_XPORT_SPI_MAX_MESSAGE_SIZE) {
+		LOG_ERR("Message too large: %zu", gb_message_len(msg));
+		return -EMSGSIZE;
+	}
+
+	item.msg = gb_message_copy(msg);
+	if (!item.msg) {
+		return -ENOMEM;
+	}
+
+	ret = k_msgq_put(&tx_msgq, &item, k_is_in_isr() ? K_NO_WAIT : K_FOREVER);
+	if (ret < 0) {
+		gb_message_dealloc(item.msg);
+		return ret;
+	}
+
+	data_ready_set(true);
+
+	return 0;
+}
+
+static void gb_trans_get_caps(struct gb_transport_caps *caps)
+{
+	caps->max_message_size = CONFIG_GREYBUS_XPORT_SPI_MAX_MESSAGE_SIZE;
+	caps->preferred_message_size = CONFIG_GREYBUS_XPORT_SPI_MAX_MESSAGE_SIZE;
+}
+
+const struct gb_transport_backend GB_TRANSPORT_BACKEND(spi) = {
+	.init = gb_trans_init,
+	.exit = gb_trans_exit,
+	.listen = gb_trans_listen,
+	.send = gb_trans_send,
+	.get_caps = gb_trans_get_caps,
+};
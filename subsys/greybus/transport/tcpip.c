@@ -13,9 +13,12 @@
 #include <greybus/greybus_messages.h>
 #include "../greybus_internal.h"
 #include <zephyr/logging/log.h>
+#include "../greybus_transport.h"
 
 LOG_MODULE_REGISTER(greybus_transport_tcpip, CONFIG_GREYBUS_LOG_LEVEL);
 
+extern const struct gb_transport_backend GB_TRANSPORT_BACKEND(tcpip);
+
 #define GB_TRANSPORT_TCPIP_BASE_PORT 4242
 
 #ifndef CONFIG_GREYBUS_ENABLE_TLS
@@ -332,7 +335,7 @@ static void gb_trans_rx(struct gb_trans_ctx *ctx)
 			return;
 		}
 
-		ret = greybus_rx_handler(msg.cport, msg.msg);
+		ret = gb_transport_rx(&GB_TRANSPORT_BACKEND(tcpip), msg.cport, msg.msg);
 		if (ret < 0) {
 			LOG_ERR("Failed to receive greybus message");
 			gb_message_dealloc(msg.msg);
@@ -378,7 +381,7 @@ static void gb_trans_exit(void)
 	zsock_close(ctx.client_sock);
 }
 
-const struct gb_transport_backend gb_trans_backend = {
+const struct gb_transport_backend GB_TRANSPORT_BACKEND(tcpip) = {
 	.init = gb_trans_init,
 	.exit = gb_trans_exit,
 	.listen = gb_trans_listen_start,
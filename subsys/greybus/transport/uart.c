@@ -4,11 +4,14 @@
 #include <greybus/greybus.h>
 #include <zephyr/drivers/uart.h>
 #include <zephyr/logging/log.h>
+#include "../greybus_transport.h"
 
 #define ADDRESS_GREYBUS 0x01
 
 LOG_MODULE_REGISTER(greybus_transport_uart, CONFIG_GREYBUS_LOG_LEVEL);
 
+extern const struct gb_transport_backend GB_TRANSPORT_BACKEND(uart);
+
 static const struct device *uart_dev = DEVICE_DT_GET(DT_ALIAS(greybus_transport_uart));
 
 /**
@@ -24,10 +27,28 @@ struct hdlc_greybus_frame {
 	uint8_t payload[];
 } __packed;
 
+#define GB_UART_MAX_MESSAGE_SIZE (HDLC_MAX_BLOCK_SIZE - sizeof(uint16_t))
+
+/* Decoded frames the dispatcher can fall behind by */
+#define GB_UART_RX_RING_FRAMES 2
+
+/*
+ * Decoded frames are published straight from the HDLC RX work, the only producer. One spare
+ * record keeps the ring from filling up on fragmentation.
+ */
+GB_RX_RING_DEFINE(rx_ring,
+		  (GB_UART_RX_RING_FRAMES + 1) * GB_RX_RING_RECORD_SIZE(HDLC_MAX_BLOCK_SIZE),
+		  &GB_TRANSPORT_BACKEND(uart));
+
 static int gb_message_hdlc_send(const struct gb_message *msg, uint16_t cport)
 {
 	char buffer[HDLC_MAX_BLOCK_SIZE];
 
+	if (gb_message_len(msg) > GB_UART_MAX_MESSAGE_SIZE) {
+		LOG_ERR("Message too large: %zu", gb_message_len(msg));
+		return -EMSGSIZE;
+	}
+
 	memcpy(buffer, &sys_cpu_to_le16(cport), sizeof(cport));
 	memcpy(&buffer[sizeof(cport)], &msg->header, sizeof(struct gb_operation_msg_hdr));
 	memcpy(&buffer[sizeof(struct gb_operation_msg_hdr) + sizeof(cport)], msg->payload,
@@ -38,31 +59,33 @@ static int gb_message_hdlc_send(const struct gb_message *msg, uint16_t cport)
 
 static int hdlc_process_frame_cb(const void *buffer, size_t buffer_len, uint8_t address)
 {
-	struct gb_msg_with_cport msg;
-	int ret;
 	const struct hdlc_greybus_frame *gb_frame = (const struct hdlc_greybus_frame *)buffer;
-	size_t msg_len = buffer_len - sizeof(uint16_t);
+	size_t frame_len;
+	void *buf;
 
-	if (gb_hdr_message_len(&gb_frame->hdr) > msg_len) {
-		LOG_ERR("Greybus Message size is greater than received buffer.");
-		return -1;
+	ARG_UNUSED(address);
+
+	if (buffer_len < sizeof(*gb_frame)) {
+		LOG_ERR("Greybus frame too short: %zu", buffer_len);
+		return -EINVAL;
 	}
 
-	msg.cport = sys_le16_to_cpu(gb_frame->cport);
-	msg.msg = gb_message_alloc(gb_hdr_payload_len(&gb_frame->hdr), gb_frame->hdr.type,
-				    gb_frame->hdr.operation_id, gb_frame->hdr.result);
-	if (!msg.msg) {
-		LOG_ERR("Failed to allocate greybus message");
-		return -1;
+	frame_len = sizeof(gb_frame->cport) + gb_hdr_message_len(&gb_frame->hdr);
+	if (frame_len > buffer_len) {
+		LOG_ERR("Greybus Message size is greater than received buffer.");
+		return -EINVAL;
 	}
 
-	memcpy(msg.msg->payload, gb_frame->payload, gb_message_payload_len(msg.msg));
-        ret = greybus_rx_handler(msg.cport, msg.msg);
-	if (ret < 0) {
-		LOG_ERR("Failed to process greybus message");
-		return ret;
+	/* Not in ISR, wait for the dispatcher to make room rather than lose the frame */
+	buf = gb_rx_ring_claim(&rx_ring, frame_len);
+	while (!buf) {
+		k_sleep(K_TICKS(1));
+		buf = gb_rx_ring_claim(&rx_ring, frame_len);
 	}
 
+	memcpy(buf, buffer, frame_len);
+	gb_rx_ring_commit(&rx_ring, frame_len);
+
 	return 0;
 }
 
@@ -121,6 +144,12 @@ static int init()
 		return -ENODEV;
 	}
 
+	ret = gb_rx_ring_register(&rx_ring);
+	if (ret < 0) {
+		LOG_ERR("Failed to register RX ring: %d", ret);
+		return ret;
+	}
+
 	ret = hdlc_init(hdlc_process_frame_cb, hdlc_send_frame_cb);
 	if (ret < 0) {
 		return ret;
@@ -153,8 +182,15 @@ static int trans_send(uint16_t cport, const struct gb_message *msg)
 	return gb_message_hdlc_send(msg, cport);
 }
 
-const struct gb_transport_backend gb_trans_backend = {
+static void trans_get_caps(struct gb_transport_caps *caps)
+{
+	caps->max_message_size = GB_UART_MAX_MESSAGE_SIZE;
+	caps->preferred_message_size = GB_UART_MAX_MESSAGE_SIZE;
+}
+
+const struct gb_transport_backend GB_TRANSPORT_BACKEND(uart) = {
 	.init = init,
 	.listen = listen,
 	.send = trans_send,
+	.get_caps = trans_get_caps,
 };
@@ -34,13 +34,16 @@
 
 LOG_MODULE_REGISTER(greybus_uart, CONFIG_GREYBUS_LOG_LEVEL);
 
-/* Reserved buffer for rx data. */
+/* Upper bound of the buffer reserved for rx data, the transport link can impose a smaller one. */
 #define MAX_RX_BUF_SIZE 64
 
 /* The id of error in protocol operating. */
 #define GB_UART_EVENT_PROTOCOL_ERROR 1
 #define GB_UART_EVENT_DEVICE_ERROR   2
 
+/* Rx data per message, set on connect from what the transport link can carry */
+static size_t rx_size;
+
 static void gb_uart_receive_credits(uint16_t cport, uint16_t count)
 {
 	struct gb_uart_receive_credits_request *req_data;
@@ -51,8 +54,7 @@ static void gb_uart_receive_credits(uint16_t cport, uint16_t count)
 
 	req_data->count = sys_cpu_to_le16(count);
 
-	gb_transport_message_send(msg, cport);
-	gb_message_dealloc(msg);
+	gb_transport_message_send_owned(msg, cport);
 }
 
 /**
@@ -201,14 +203,15 @@ static void uart_irq_cb(const struct device *dev, void *user_data)
       return;
   }
 
-	req = gb_message_request_alloc(MAX_RX_BUF_SIZE, GB_UART_TYPE_RECEIVE_DATA, true);
+	req = gb_message_request_alloc(sizeof(*req_data) + rx_size, GB_UART_TYPE_RECEIVE_DATA,
+				       true);
 	if (!req) {
 		LOG_ERR("Failed to allocate message");
 		return;
 	}
 	req_data = (struct gb_uart_recv_data_request *)req->payload;
 
-	ret = uart_fifo_read(dev, req_data->data, MAX_RX_BUF_SIZE);
+	ret = uart_fifo_read(dev, req_data->data, rx_size);
 	if (ret < 0) {
 		LOG_ERR("Failed to read from UART");
 		goto free_msg;
@@ -220,7 +223,8 @@ static void uart_irq_cb(const struct device *dev, void *user_data)
 		ret + sizeof(struct gb_message) + sizeof(struct gb_uart_recv_data_request);
 
 	if (ret) {
-		gb_transport_message_send(req, cport);
+		gb_transport_message_send_owned(req, cport);
+		return;
 	}
 
 free_msg:
@@ -253,6 +257,16 @@ static void gb_uart_connected(const void *priv, uint16_t cport)
 {
 	const struct device *dev = priv;
 
+	/* The link limits every cport alike, no need to ask from the interrupt */
+	rx_size = gb_transport_chunk_size(sizeof(struct gb_uart_recv_data_request),
+					  MAX_RX_BUF_SIZE);
+	if (rx_size == 0) {
+		/* Reads of 0 bytes would never drain the RX FIFO */
+		LOG_ERR("Transport cannot carry UART data, RX disabled");
+		uart_irq_rx_disable(dev);
+		return;
+	}
+
 	uart_irq_callback_user_data_set(dev, uart_irq_cb, UINT_TO_POINTER(cport));
 	uart_irq_rx_enable(dev);
 }
@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2026 BeagleBoard.org
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/irq_offload.h>
+#include <greybus/greybus.h>
+#include <greybus-utils/manifest.h>
+#include "greybus_transport.h"
+
+#define LOOPBACK_CPORT 1
+#define PING_COUNT     3
+
+struct gb_msg_with_cport gb_transport_get_message(void);
+
+struct isr_send {
+	struct gb_message *msg;
+	int ret;
+};
+
+static void isr_send_handler(const void *param)
+{
+	struct isr_send *send = (struct isr_send *)param;
+
+	send->ret = gb_aggregate_send(send->msg, LOOPBACK_CPORT);
+}
+
+static struct gb_message *large_alloc(void)
+{
+	return gb_message_request_alloc(CONFIG_GREYBUS_AGGREGATION_MAX_SIZE,
+					GB_LOOPBACK_TYPE_TRANSFER, true);
+}
+
+static struct gb_message *envelope_alloc(size_t count)
+{
+	const size_t entry_len = sizeof(struct gb_aggregate_entry);
+	struct gb_message *env = gb_message_request_alloc(count * entry_len,
+							   GB_AGGREGATE_TYPE_ENVELOPE, true);
+	struct gb_aggregate_entry *entry;
+	struct gb_message *req;
+	size_t i;
+
+	for (i = 0; i < count; i++) {
+		req = gb_message_request_alloc(0, GB_LOOPBACK_TYPE_PING, false);
+		entry = (struct gb_aggregate_entry *)&env->payload[i * entry_len];
+		entry->cport = sys_cpu_to_le16(LOOPBACK_CPORT);
+		memcpy(&entry->hdr, req, gb_message_len(req));
+		gb_message_dealloc(req);
+	}
+
+	return env;
+}
+
+static void aggregation_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	gb_aggregate_reset();
+}
+
+ZTEST_SUITE(greybus_aggregation_tests, NULL, NULL, aggregation_before, NULL, NULL);
+
+ZTEST(greybus_aggregation_tests, test_no_host_support)
+{
+	struct gb_message *req = gb_message_request_alloc(0, GB_LOOPBACK_TYPE_PING, false);
+	struct gb_msg_with_cport resp;
+
+	greybus_rx_handler(LOOPBACK_CPORT, req);
+	resp = gb_transport_get_message();
+
+	zassert_equal(resp.cport, LOOPBACK_CPORT, "Response should not be aggregated");
+	zassert_equal(gb_message_type(resp.msg), GB_RESPONSE(GB_LOOPBACK_TYPE_PING),
+		      "Invalid response type");
+	gb_message_dealloc(resp.msg);
+}
+
+ZTEST(greybus_aggregation_tests, test_envelope)
+{
+	const struct gb_aggregate_entry *entry;
+	struct gb_msg_with_cport resp;
+	size_t offset = 0;
+	size_t count = 0;
+
+	greybus_rx_handler(GB_AGGREGATE_CPORT, envelope_alloc(PING_COUNT));
+	resp = gb_transport_get_message();
+
+	zassert_equal(resp.cport, GB_AGGREGATE_CPORT, "Responses should be aggregated");
+	zassert_equal(gb_message_type(resp.msg), GB_AGGREGATE_TYPE_ENVELOPE,
+		      "Invalid envelope type");
+
+	while (offset < gb_message_payload_len(resp.msg)) {
+		entry = (const struct gb_aggregate_entry *)&resp.msg->payload[offset];
+		zassert_equal(sys_le16_to_cpu(entry->cport), LOOPBACK_CPORT, "Invalid cport");
+		zassert_equal(entry->hdr.type, GB_RESPONSE(GB_LOOPBACK_TYPE_PING),
+			      "Invalid response type");
+		zassert_equal(entry->hdr.result, GB_OP_SUCCESS, "Greybus loopback ping failed");
+
+		offset += sizeof(entry->cport) + gb_hdr_message_len(&entry->hdr);
+		count++;
+	}
+
+	zassert_equal(offset, gb_message_payload_len(resp.msg), "Trailing envelope data");
+	zassert_equal(count, PING_COUNT, "All responses should share one envelope");
+	gb_message_dealloc(resp.msg);
+}
+
+ZTEST(greybus_aggregation_tests, test_too_large_for_envelope)
+{
+	const size_t len = CONFIG_GREYBUS_AGGREGATION_MAX_SIZE;
+	struct gb_loopback_transfer_request *req_data;
+	struct gb_msg_with_cport resp;
+	struct gb_message *req;
+
+	req = gb_message_request_alloc(sizeof(*req_data) + len, GB_LOOPBACK_TYPE_TRANSFER, false);
+	req_data = (struct gb_loopback_transfer_request *)req->payload;
+	req_data->len = sys_cpu_to_le32(len);
+
+	/* Opt in with an empty envelope */
+	greybus_rx_handler(GB_AGGREGATE_CPORT, envelope_alloc(0));
+	greybus_rx_handler(LOOPBACK_CPORT, req);
+	resp = gb_transport_get_message();
+
+	zassert_equal(resp.cport, LOOPBACK_CPORT, "Large response should be sent as is");
+	zassert_equal(gb_message_type(resp.msg), GB_RESPONSE(GB_LOOPBACK_TYPE_TRANSFER),
+		      "Invalid response type");
+	gb_message_dealloc(resp.msg);
+}
+
+ZTEST(greybus_aggregation_tests, test_isr_keeps_order)
+{
+	struct gb_message *small = gb_message_request_alloc(0, GB_LOOPBACK_TYPE_PING, true);
+	struct isr_send send = {.msg = large_alloc()};
+	struct gb_aggregate_stats before, after;
+	struct gb_msg_with_cport resp;
+
+	greybus_rx_handler(GB_AGGREGATE_CPORT, envelope_alloc(0));
+	gb_aggregate_stats_get(&before);
+
+	/* An envelope is pending, a large message from ISR must not overtake it */
+	zassert_ok(gb_aggregate_send(small, LOOPBACK_CPORT), "Failed to queue message");
+	irq_offload(isr_send_handler, &send);
+	zassert_equal(send.ret, -EAGAIN, "ISR send should be refused while envelope is pending");
+	gb_aggregate_stats_get(&after);
+	zassert_equal(after.tx_dropped, before.tx_dropped + 1, "Refused message not counted");
+
+	resp = gb_transport_get_message();
+	zassert_equal(resp.cport, GB_AGGREGATE_CPORT, "Pending envelope should be sent first");
+	gb_message_dealloc(resp.msg);
+
+	/* Nothing pending, the message can go out directly */
+	irq_offload(isr_send_handler, &send);
+	zassert_ok(send.ret, "ISR send should succeed without pending envelope");
+
+	resp = gb_transport_get_message();
+	zassert_equal(resp.cport, LOOPBACK_CPORT, "Large message should be sent as is");
+	zassert_equal(gb_message_type(resp.msg), GB_LOOPBACK_TYPE_TRANSFER, "Invalid type");
+	gb_message_dealloc(resp.msg);
+
+	gb_message_dealloc(small);
+	gb_message_dealloc(send.msg);
+}
+
+ZTEST(greybus_aggregation_tests, test_isr_seals_full_envelope)
+{
+	const size_t len = CONFIG_GREYBUS_AGGREGATION_MAX_SIZE / 2;
+	struct gb_message *first = gb_message_request_alloc(len, GB_LOOPBACK_TYPE_TRANSFER, true);
+	struct isr_send send = {
+		.msg = gb_message_request_alloc(len, GB_LOOPBACK_TYPE_TRANSFER, true),
+	};
+	struct gb_aggregate_stats before, after;
+	const struct gb_aggregate_entry *entry;
+	struct gb_msg_with_cport resp;
+	size_t i;
+
+	greybus_rx_handler(GB_AGGREGATE_CPORT, envelope_alloc(0));
+	gb_aggregate_stats_get(&before);
+
+	/* Each message takes more than half an envelope */
+	first->header.operation_id = sys_cpu_to_le16(1);
+	send.msg->header.operation_id = sys_cpu_to_le16(2);
+	zassert_ok(gb_aggregate_send(first, LOOPBACK_CPORT), "Failed to queue message");
+	irq_offload(isr_send_handler, &send);
+	zassert_ok(send.ret, "ISR send should go into the other envelope");
+
+	/* The sealed envelope goes out first, without waiting for the latency */
+	for (i = 1; i <= 2; i++) {
+		resp = gb_transport_get_message();
+		zassert_equal(resp.cport, GB_AGGREGATE_CPORT, "Message should be aggregated");
+		entry = (const struct gb_aggregate_entry *)resp.msg->payload;
+		zassert_equal(gb_message_payload_len(resp.msg),
+			      sizeof(entry->cport) + sizeof(entry->hdr) + len,
+			      "One message per envelope");
+		zassert_equal(sys_le16_to_cpu(entry->hdr.operation_id), i, "Envelopes out of order");
+		gb_message_dealloc(resp.msg);
+	}
+
+	gb_aggregate_stats_get(&after);
+	zassert_equal(after.tx_dropped, before.tx_dropped, "No message should be dropped");
+
+	gb_message_dealloc(first);
+	gb_message_dealloc(send.msg);
+}
+
+ZTEST(greybus_aggregation_tests, test_rx_entry_error)
+{
+	struct gb_aggregate_stats before, after;
+	struct gb_message *env = envelope_alloc(1);
+	struct gb_aggregate_entry *entry = (struct gb_aggregate_entry *)env->payload;
+
+	gb_aggregate_stats_get(&before);
+
+	/* Claims more payload than the envelope holds */
+	entry->hdr.size = sys_cpu_to_le16(sizeof(entry->hdr) + 1);
+	greybus_rx_handler(GB_AGGREGATE_CPORT, env);
+
+	gb_aggregate_stats_get(&after);
+	zassert_equal(after.rx_errors, before.rx_errors + 1, "Invalid entry not counted");
+}
@@ -36,10 +36,10 @@ ZTEST(greybus_apbridge_tests, test_intf_free)
 ZTEST(greybus_apbridge_tests, test_intf_overflow)
 {
 	int i;
-	struct gb_interface *intfs[CONFIG_GREYBUS_APBRIDGE_CPORTS];
+	struct gb_interface *intfs[AP_MAX_INTERFACES];
 	struct gb_interface *intf;
 
-	for (i = 2; i < CONFIG_GREYBUS_APBRIDGE_CPORTS; i++) {
+	for (i = 2; i < AP_MAX_INTERFACES; i++) {
 		intfs[i] = gb_interface_alloc(NULL, NULL, NULL, NULL);
 
 		zassert_not_null(intfs[i], "Failed to allocate greybus interface");
@@ -49,7 +49,7 @@ ZTEST(greybus_apbridge_tests, test_intf_overflow)
 	intf = gb_interface_alloc(NULL, NULL, NULL, NULL);
 	zassert_is_null(intf, "Should overflow");
 
-	for (i = 2; i < CONFIG_GREYBUS_APBRIDGE_CPORTS; i++) {
+	for (i = 2; i < AP_MAX_INTERFACES; i++) {
 		gb_interface_dealloc(intfs[i]);
 	}
 }
@@ -80,7 +80,7 @@ static int write_cb(struct gb_interface *intf, struct gb_message *msg, uint16_t
 ZTEST(greybus_apbridge_tests, test_message_send)
 {
 	int ret;
-	struct gb_message msg;
+	struct gb_message *msg;
 	struct gb_interface ap_intf = {
 		.id = AP_INF_ID,
 		.write = write_cb,
@@ -105,13 +105,18 @@ ZTEST(greybus_apbridge_tests, test_message_send)
 	ret = gb_apbridge_connection_create(AP_INF_ID, 0, 0, 0);
 	zassert_equal(ret, 0, "Failed to create connection");
 
-	ret = gb_apbridge_send(AP_INF_ID, 0, &msg);
+	/* The bridge passes ownership on to the write callback */
+	msg = gb_message_request_alloc(0, 0x02, false);
+	ret = gb_apbridge_send(AP_INF_ID, 0, msg);
 	zassert_equal(ret, 0, "Failed to send message");
-	zassert_equal_ptr(&msg, svc_intf.ctrl_data, "Should point to the same message");
+	zassert_equal_ptr(msg, svc_intf.ctrl_data, "Should point to the same message");
+	gb_message_dealloc(msg);
 
-	ret = gb_apbridge_send(0, 0, &msg);
+	msg = gb_message_request_alloc(0, 0x02, false);
+	ret = gb_apbridge_send(0, 0, msg);
 	zassert_equal(ret, 0, "Failed to send message");
-	zassert_equal_ptr(&msg, ap_intf.ctrl_data, "Should point to the same message");
+	zassert_equal_ptr(msg, ap_intf.ctrl_data, "Should point to the same message");
+	gb_message_dealloc(msg);
 
 	ret = gb_apbridge_connection_destroy(AP_INF_ID, 0, 0, 0);
 	zassert_equal(ret, 0, "Failed to create connection");
@@ -119,3 +124,327 @@ ZTEST(greybus_apbridge_tests, test_message_send)
 	gb_interface_remove(AP_INF_ID);
 	gb_interface_remove(0);
 }
+
+static uint16_t last_write_cport;
+
+static int write_cport_cb(struct gb_interface *intf, struct gb_message *msg, uint16_t cport)
+{
+	ARG_UNUSED(intf);
+
+	last_write_cport = cport;
+	gb_message_dealloc(msg);
+
+	return 0;
+}
+
+#define LOOKUP_NODES 2
+/* Spread over the whole cport space, 127 is coprime with the number of cport ids */
+#define LOOKUP_AP_CPORT(i)    (((i) * 127) % (GB_APBRIDGE_CPORT_ID_MAX + 1))
+#define LOOKUP_NODE_CPORT(i)  ((i) * 7)
+#define LOOKUP_NODE_ID(i)     (INTF_START_ID + (i) % LOOKUP_NODES)
+
+static struct gb_interface lookup_ap = {
+	.id = AP_INF_ID,
+	.write = write_cport_cb,
+};
+static struct gb_interface lookup_nodes[LOOKUP_NODES] = {
+	{.id = INTF_START_ID, .write = write_cport_cb},
+	{.id = INTF_START_ID + 1, .write = write_cport_cb},
+};
+
+static struct gb_message *lookup_msg(void)
+{
+	struct gb_message *msg = gb_message_request_alloc(0, 0x02, false);
+
+	zassert_not_null(msg, "Failed to allocate message");
+
+	return msg;
+}
+
+static void lookup_setup(void)
+{
+	zassert_ok(gb_interface_add(&lookup_ap), "Failed to add AP");
+	for (size_t i = 0; i < LOOKUP_NODES; i++) {
+		zassert_ok(gb_interface_add(&lookup_nodes[i]), "Failed to add node");
+	}
+
+	for (size_t i = 0; i < AP_MAX_NODES; i++) {
+		zassert_ok(gb_apbridge_connection_create(AP_INF_ID, LOOKUP_AP_CPORT(i),
+							 LOOKUP_NODE_ID(i), LOOKUP_NODE_CPORT(i)),
+			   "Failed to create connection");
+	}
+}
+
+static void lookup_teardown(void)
+{
+	gb_apbridge_deinit();
+
+	gb_interface_remove(AP_INF_ID);
+	for (size_t i = 0; i < LOOKUP_NODES; i++) {
+		gb_interface_remove(lookup_nodes[i].id);
+	}
+}
+
+ZTEST(greybus_apbridge_tests, test_node_to_ap_lookup)
+{
+	size_t i;
+	int ret;
+
+	lookup_setup();
+
+	zassert_equal(gb_apbridge_connection_create(AP_INF_ID, GB_APBRIDGE_CPORT_ID_MAX + 1,
+						    INTF_START_ID, 1),
+		      -EOVERFLOW, "AP cport out of range");
+	zassert_equal(gb_apbridge_connection_create(AP_INF_ID, LOOKUP_AP_CPORT(AP_MAX_NODES),
+						    INTF_START_ID, 1),
+		      -ENOMEM, "Connection table should be full");
+	zassert_equal(gb_apbridge_connection_create(AP_INF_ID, LOOKUP_AP_CPORT(0), INTF_START_ID, 1),
+		      -EALREADY, "AP cport already connected");
+
+	/* Remove every third connection, the others have to stay reachable */
+	for (i = 0; i < AP_MAX_NODES; i += 3) {
+		zassert_ok(gb_apbridge_connection_destroy(LOOKUP_NODE_ID(i), LOOKUP_NODE_CPORT(i),
+							  AP_INF_ID, LOOKUP_AP_CPORT(i)),
+			   "Failed to destroy connection");
+	}
+
+	for (i = 0; i < AP_MAX_NODES; i++) {
+		if (i % 3 == 0) {
+			/* Unroutable messages are freed by the bridge */
+			ret = gb_apbridge_send(LOOKUP_NODE_ID(i), LOOKUP_NODE_CPORT(i), lookup_msg());
+			zassert_equal(ret, -EINVAL, "Destroyed connection should not route");
+			ret = gb_apbridge_send(AP_INF_ID, LOOKUP_AP_CPORT(i), lookup_msg());
+			zassert_equal(ret, -EINVAL, "Destroyed connection should not route");
+			continue;
+		}
+
+		ret = gb_apbridge_send(LOOKUP_NODE_ID(i), LOOKUP_NODE_CPORT(i), lookup_msg());
+		zassert_ok(ret, "Failed to send message");
+		zassert_equal(last_write_cport, LOOKUP_AP_CPORT(i), "Routed to the wrong AP cport");
+
+		zassert_ok(gb_apbridge_send(AP_INF_ID, LOOKUP_AP_CPORT(i), lookup_msg()),
+			   "Failed to send message");
+		zassert_equal(last_write_cport, LOOKUP_NODE_CPORT(i), "Routed to the wrong node cport");
+	}
+
+	/* Same node cport on another interface is a different connection */
+	zassert_equal(gb_apbridge_send(LOOKUP_NODE_ID(2), LOOKUP_NODE_CPORT(1), lookup_msg()),
+		      -EINVAL, "Lookup should include the interface id");
+
+	lookup_teardown();
+}
+
+ZTEST(greybus_apbridge_tests, test_node_to_ap_lookup_time)
+{
+	const size_t last = AP_MAX_NODES - 1;
+	struct gb_message *msg;
+	uint32_t start, cycles = 0;
+
+	lookup_setup();
+
+	/* Last connection is the worst case of the linear scan, allocation is not timed */
+	for (size_t i = 0; i < 1000; i++) {
+		msg = lookup_msg();
+		start = k_cycle_get_32();
+		gb_apbridge_send(LOOKUP_NODE_ID(last), LOOKUP_NODE_CPORT(last), msg);
+		cycles += k_cycle_get_32() - start;
+	}
+
+	TC_PRINT("%u node to AP sends: %u cycles (%s lookup)\n", 1000, cycles,
+		 IS_ENABLED(CONFIG_GREYBUS_APBRIDGE_LINEAR_LOOKUP) ? "linear" : "indexed");
+	zassert_equal(last_write_cport, LOOKUP_AP_CPORT(last), "Routed to the wrong AP cport");
+
+	lookup_teardown();
+}
+
+ZTEST(greybus_apbridge_tests, test_sparse_interfaces)
+{
+	struct gb_interface intf = {
+		.id = AP_MAX_INTERFACES - 1,
+	};
+	struct gb_interface out_of_range = {
+		.id = AP_MAX_INTERFACES,
+	};
+
+	zassert_ok(gb_interface_add(&intf), "Failed to add last interface");
+	zassert_equal_ptr(gb_interface_get(intf.id), &intf, "Interface not found");
+	zassert_is_null(gb_interface_get(intf.id - 1), "Interface should not exist");
+
+	gb_interface_remove(intf.id);
+	zassert_is_null(gb_interface_get(intf.id), "Interface should be removed");
+
+	zassert_equal(gb_interface_add(&out_of_range), -EOVERFLOW, "Interface id out of range");
+}
+
+#define N2N_NODE1  INTF_START_ID
+#define N2N_NODE2  (INTF_START_ID + 1)
+#define N2N_CPORT1 5
+#define N2N_CPORT2 9
+
+static uint8_t last_write_intf;
+static size_t n2n_connected[2];
+static int n2n_create_ret[2];
+
+static int n2n_write_cb(struct gb_interface *intf, struct gb_message *msg, uint16_t cport)
+{
+	last_write_intf = intf->id;
+	last_write_cport = cport;
+	gb_message_dealloc(msg);
+
+	return 0;
+}
+
+static int n2n_create_cb(struct gb_interface *intf, uint16_t cport)
+{
+	ARG_UNUSED(cport);
+
+	if (n2n_create_ret[intf->id - N2N_NODE1] == 0) {
+		n2n_connected[intf->id - N2N_NODE1]++;
+	}
+
+	return n2n_create_ret[intf->id - N2N_NODE1];
+}
+
+static void n2n_destroy_cb(struct gb_interface *intf, uint16_t cport)
+{
+	ARG_UNUSED(cport);
+
+	n2n_connected[intf->id - N2N_NODE1]--;
+}
+
+ZTEST(greybus_apbridge_tests, test_node_to_node)
+{
+	struct gb_interface nodes[] = {
+		{
+			.id = N2N_NODE1,
+			.write = n2n_write_cb,
+			.create_connection = n2n_create_cb,
+			.destroy_connection = n2n_destroy_cb,
+		},
+		{
+			.id = N2N_NODE2,
+			.write = n2n_write_cb,
+			.create_connection = n2n_create_cb,
+			.destroy_connection = n2n_destroy_cb,
+		},
+	};
+
+	zassert_ok(gb_interface_add(&nodes[0]), "Failed to add node");
+	zassert_ok(gb_interface_add(&nodes[1]), "Failed to add node");
+
+	zassert_ok(gb_apbridge_connection_create(N2N_NODE1, N2N_CPORT1, N2N_NODE2, N2N_CPORT2),
+		   "Failed to create node to node connection");
+	zassert_equal(n2n_connected[0], 1, "Node 1 hook not called");
+	zassert_equal(n2n_connected[1], 1, "Node 2 hook not called");
+
+	zassert_ok(gb_apbridge_send(N2N_NODE1, N2N_CPORT1, lookup_msg()));
+	zassert_equal(last_write_intf, N2N_NODE2, "Should be routed to node 2");
+	zassert_equal(last_write_cport, N2N_CPORT2, "Invalid target cport");
+
+	zassert_ok(gb_apbridge_send(N2N_NODE2, N2N_CPORT2, lookup_msg()));
+	zassert_equal(last_write_intf, N2N_NODE1, "Should be routed to node 1");
+	zassert_equal(last_write_cport, N2N_CPORT1, "Invalid target cport");
+
+	/* Either end is in use */
+	zassert_equal(gb_apbridge_connection_create(AP_INF_ID, 1, N2N_NODE2, N2N_CPORT2), -EALREADY,
+		      "Node cport already connected");
+	zassert_equal(n2n_connected[1], 1, "Failed connection should be undone");
+	zassert_equal(gb_apbridge_connection_create(AP_INF_ID, 1, AP_INF_ID, 2), -EINVAL,
+		      "AP to AP is not supported");
+
+	zassert_ok(gb_apbridge_connection_destroy(N2N_NODE2, N2N_CPORT2, N2N_NODE1, N2N_CPORT1));
+	zassert_equal(n2n_connected[0], 0, "Node 1 hook not called");
+	zassert_equal(n2n_connected[1], 0, "Node 2 hook not called");
+	zassert_equal(gb_apbridge_send(N2N_NODE1, N2N_CPORT1, lookup_msg()), -EINVAL,
+		      "Destroyed connection should not route");
+
+	/* A failing peer hook undoes the node side */
+	n2n_create_ret[1] = -EIO;
+	zassert_equal(gb_apbridge_connection_create(N2N_NODE1, N2N_CPORT1, N2N_NODE2, N2N_CPORT2),
+		      -EIO, "Peer hook failure should fail the connection");
+	zassert_equal(n2n_connected[0], 0, "Node 1 connection not undone");
+	n2n_create_ret[1] = 0;
+
+	gb_interface_remove(N2N_NODE1);
+	gb_interface_remove(N2N_NODE2);
+}
+
+ZTEST(greybus_apbridge_tests, test_removed_node)
+{
+	struct gb_interface ap = {.id = AP_INF_ID, .write = write_cport_cb};
+	struct gb_interface node = {.id = N2N_NODE1, .write = write_cport_cb};
+
+	zassert_ok(gb_interface_add(&ap), "Failed to add AP");
+	zassert_ok(gb_interface_add(&node), "Failed to add node");
+	zassert_ok(gb_apbridge_connection_create(AP_INF_ID, 1, N2N_NODE1, N2N_CPORT1),
+		   "Failed to create connection");
+
+	/* The connection outlives the node, messages to it must not reach the old interface */
+	gb_interface_remove(N2N_NODE1);
+	zassert_equal(gb_apbridge_send(AP_INF_ID, 1, lookup_msg()), -ENODEV,
+		      "Removed node should not route");
+
+	zassert_ok(gb_apbridge_connection_destroy(AP_INF_ID, 1, N2N_NODE1, N2N_CPORT1),
+		   "Failed to destroy connection");
+	gb_interface_remove(AP_INF_ID);
+}
+
+#define CHURN_ROUNDS 50
+/* In a chunk of its own, which is freed and allocated again every round */
+#define CHURN_INTF_ID (INTF_START_ID + 16)
+
+static struct gb_interface churn_stable = {.id = INTF_START_ID};
+static struct gb_interface churn_intf = {.id = CHURN_INTF_ID};
+static atomic_t churn_done;
+static atomic_t churn_errors;
+
+static void churn_reader(void *p1, void *p2, void *p3)
+{
+	struct gb_interface *intf;
+
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (!atomic_get(&churn_done)) {
+		/* Hot-plugging another interface must never hide this one */
+		if (gb_interface_get(churn_stable.id) != &churn_stable) {
+			atomic_inc(&churn_errors);
+		}
+
+		intf = gb_interface_get(churn_intf.id);
+		if (intf && intf != &churn_intf) {
+			atomic_inc(&churn_errors);
+		}
+
+		k_yield();
+	}
+}
+
+K_THREAD_STACK_DEFINE(churn_stack, 1024);
+static struct k_thread churn_thread;
+
+ZTEST(greybus_apbridge_tests, test_lookup_during_churn)
+{
+	zassert_ok(gb_interface_add(&churn_stable), "Failed to add interface");
+
+	atomic_set(&churn_done, 0);
+	atomic_set(&churn_errors, 0);
+	k_thread_create(&churn_thread, churn_stack, K_THREAD_STACK_SIZEOF(churn_stack), churn_reader,
+			NULL, NULL, NULL, k_thread_priority_get(k_current_get()), 0, K_NO_WAIT);
+
+	for (int i = 0; i < CHURN_ROUNDS; i++) {
+		/* Adds wait for each other instead of failing */
+		zassert_ok(gb_interface_add(&churn_intf), "Failed to add interface");
+		k_yield();
+		gb_interface_remove(churn_intf.id);
+		zassert_is_null(gb_interface_get(churn_intf.id), "Interface should be removed");
+	}
+
+	atomic_set(&churn_done, 1);
+	k_thread_join(&churn_thread, K_FOREVER);
+
+	zassert_equal(atomic_get(&churn_errors), 0, "Lookup returned a wrong interface");
+
+	gb_interface_remove(churn_stable.id);
+}
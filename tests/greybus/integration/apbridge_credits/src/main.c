@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2026 BeagleBoard.org
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <greybus/apbridge.h>
+#include <zephyr/ztest.h>
+#include <zephyr/irq_offload.h>
+
+#define NODE_INTF_ID 2
+#define NODE_CPORT   0
+#define AP_CPORT     5
+#define TO_NODE      CONFIG_GREYBUS_APBRIDGE_CREDITS_TO_NODE
+#define TO_AP        CONFIG_GREYBUS_APBRIDGE_CREDITS_TO_AP
+
+static K_SEM_DEFINE(written, 0, K_SEM_MAX_LIMIT);
+
+static int write_cb(struct gb_interface *intf, struct gb_message *msg, uint16_t cport)
+{
+	ARG_UNUSED(intf);
+	ARG_UNUSED(cport);
+
+	gb_message_dealloc(msg);
+	k_sem_give(&written);
+
+	return 0;
+}
+
+static struct gb_interface ap_intf = {
+	.id = AP_INF_ID,
+	.write = write_cb,
+};
+
+/* Returns credits itself, once the test says the message was consumed */
+static struct gb_interface node_intf = {
+	.id = NODE_INTF_ID,
+	.write = write_cb,
+	.returns_credits = true,
+};
+
+static struct gb_message *test_msg(void)
+{
+	struct gb_message *msg = gb_message_request_alloc(0, 1, false);
+
+	zassert_not_null(msg, "Failed to allocate message");
+
+	return msg;
+}
+
+static void isr_send(const void *param)
+{
+	int *ret = (int *)param;
+
+	*ret = gb_apbridge_send(AP_INF_ID, AP_CPORT, test_msg());
+}
+
+static void credit_return_work_fn(struct k_work *work)
+{
+	ARG_UNUSED(work);
+
+	gb_apbridge_credit_return(NODE_INTF_ID, NODE_CPORT);
+}
+
+static K_WORK_DELAYABLE_DEFINE(credit_return_work, credit_return_work_fn);
+
+static void *apbridge_credits_setup(void)
+{
+	zassert_ok(gb_interface_add(&ap_intf), "Failed to add AP");
+	zassert_ok(gb_interface_add(&node_intf), "Failed to add node");
+
+	return NULL;
+}
+
+static void apbridge_credits_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	zassert_ok(gb_apbridge_connection_create(AP_INF_ID, AP_CPORT, NODE_INTF_ID, NODE_CPORT));
+	k_sem_reset(&written);
+}
+
+static void apbridge_credits_after(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	gb_apbridge_connection_destroy(AP_INF_ID, AP_CPORT, NODE_INTF_ID, NODE_CPORT);
+}
+
+ZTEST_SUITE(greybus_apbridge_credits_tests, NULL, apbridge_credits_setup, apbridge_credits_before,
+	    apbridge_credits_after, NULL);
+
+ZTEST(greybus_apbridge_credits_tests, test_windows)
+{
+	zassert_equal(gb_apbridge_credits(AP_INF_ID, AP_CPORT), TO_NODE, "Invalid AP window");
+	zassert_equal(gb_apbridge_credits(NODE_INTF_ID, NODE_CPORT), TO_AP, "Invalid node window");
+	zassert_true(gb_apbridge_credits(AP_INF_ID, AP_CPORT + 1) < 0, "No connection");
+}
+
+ZTEST(greybus_apbridge_credits_tests, test_window_exhausted)
+{
+	int i;
+
+	for (i = 0; i < TO_NODE; i++) {
+		zassert_ok(gb_apbridge_send(AP_INF_ID, AP_CPORT, test_msg()));
+		zassert_ok(k_sem_take(&written, K_MSEC(100)), "Message not written");
+	}
+
+	zassert_equal(gb_apbridge_credits(AP_INF_ID, AP_CPORT), 0, "Window should be used up");
+	zassert_equal(gb_apbridge_send(AP_INF_ID, AP_CPORT, test_msg()), -EAGAIN,
+		      "Send without credits should time out");
+
+	/* The other direction has its own window */
+	zassert_ok(gb_apbridge_send(NODE_INTF_ID, NODE_CPORT, test_msg()));
+	zassert_ok(k_sem_take(&written, K_MSEC(100)), "Message not written");
+
+	zassert_ok(gb_apbridge_credit_return(NODE_INTF_ID, NODE_CPORT));
+	zassert_equal(gb_apbridge_credits(AP_INF_ID, AP_CPORT), 1, "Credit not returned");
+	zassert_ok(gb_apbridge_send(AP_INF_ID, AP_CPORT, test_msg()));
+}
+
+ZTEST(greybus_apbridge_credits_tests, test_sender_waits)
+{
+	int i;
+
+	for (i = 0; i < TO_NODE; i++) {
+		zassert_ok(gb_apbridge_send(AP_INF_ID, AP_CPORT, test_msg()));
+	}
+
+	/* Blocks until the node consumes a message */
+	k_work_schedule(&credit_return_work, K_MSEC(20));
+	zassert_ok(gb_apbridge_send(AP_INF_ID, AP_CPORT, test_msg()), "Send should wait for credit");
+}
+
+ZTEST(greybus_apbridge_credits_tests, test_isr_no_credit)
+{
+	int ret, i;
+
+	for (i = 0; i < TO_NODE; i++) {
+		zassert_ok(gb_apbridge_send(AP_INF_ID, AP_CPORT, test_msg()));
+		zassert_ok(k_sem_take(&written, K_MSEC(100)), "Message not written");
+	}
+
+	/* Can't wait in ISR, the send has to fail instead of bypassing the window */
+	irq_offload(isr_send, &ret);
+	zassert_equal(ret, -EAGAIN, "ISR send without credits should fail");
+	zassert_equal(k_sem_take(&written, K_MSEC(10)), -EAGAIN, "Message should not be written");
+
+	zassert_ok(gb_apbridge_credit_return(NODE_INTF_ID, NODE_CPORT));
+	irq_offload(isr_send, &ret);
+	zassert_ok(ret, "ISR send with a credit should succeed");
+	zassert_ok(k_sem_take(&written, K_MSEC(100)), "Message not written");
+	zassert_equal(gb_apbridge_credits(AP_INF_ID, AP_CPORT), 0, "Credit should be taken");
+}
+
+ZTEST(greybus_apbridge_credits_tests, test_auto_return)
+{
+	int i;
+
+	/* The AP does not return credits itself, they come back once written */
+	for (i = 0; i < 2 * TO_AP; i++) {
+		zassert_ok(gb_apbridge_send(NODE_INTF_ID, NODE_CPORT, test_msg()));
+		zassert_ok(k_sem_take(&written, K_MSEC(100)), "Message not written");
+	}
+
+	k_msleep(10);
+	zassert_equal(gb_apbridge_credits(NODE_INTF_ID, NODE_CPORT), TO_AP,
+		      "Credits should be back");
+}
+
+ZTEST(greybus_apbridge_credits_tests, test_saturate)
+{
+	zassert_ok(gb_apbridge_credit_return(NODE_INTF_ID, NODE_CPORT));
+	zassert_equal(gb_apbridge_credits(AP_INF_ID, AP_CPORT), TO_NODE,
+		      "Credits should not exceed the window");
+}
@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2026 BeagleBoard.org
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <greybus/apbridge.h>
+#include <zephyr/ztest.h>
+
+#define SLOW_INTF_ID  2
+#define FAST_INTF_ID  3
+#define GONE_INTF_ID  4
+#define SPARE_INTF_ID 5
+#define TXQ_DEPTH     CONFIG_GREYBUS_APBRIDGE_TX_QUEUE_DEPTH
+
+static K_SEM_DEFINE(slow_unblock, 0, K_SEM_MAX_LIMIT);
+static K_SEM_DEFINE(slow_written, 0, K_SEM_MAX_LIMIT);
+static K_SEM_DEFINE(fast_written, 0, K_SEM_MAX_LIMIT);
+
+/* Stalls until the test lets it go */
+static int slow_write(struct gb_interface *intf, struct gb_message *msg, uint16_t cport)
+{
+	ARG_UNUSED(intf);
+	ARG_UNUSED(cport);
+
+	k_sem_take(&slow_unblock, K_FOREVER);
+	gb_message_dealloc(msg);
+	k_sem_give(&slow_written);
+
+	return 0;
+}
+
+static K_SEM_DEFINE(gone_unblock, 0, K_SEM_MAX_LIMIT);
+static K_SEM_DEFINE(gone_removed, 0, 1);
+static atomic_t gone_writes;
+
+static int gone_write(struct gb_interface *intf, struct gb_message *msg, uint16_t cport)
+{
+	ARG_UNUSED(intf);
+	ARG_UNUSED(cport);
+
+	k_sem_take(&gone_unblock, K_FOREVER);
+	gb_message_dealloc(msg);
+	atomic_inc(&gone_writes);
+
+	return 0;
+}
+
+static int fast_write(struct gb_interface *intf, struct gb_message *msg, uint16_t cport)
+{
+	ARG_UNUSED(intf);
+	ARG_UNUSED(cport);
+
+	gb_message_dealloc(msg);
+	k_sem_give(&fast_written);
+
+	return 0;
+}
+
+static struct gb_interface ap_intf = {
+	.id = AP_INF_ID,
+	.write = fast_write,
+};
+
+static struct gb_interface slow_intf = {
+	.id = SLOW_INTF_ID,
+	.write = slow_write,
+};
+
+static struct gb_interface fast_intf = {
+	.id = FAST_INTF_ID,
+	.write = fast_write,
+};
+
+static struct gb_interface gone_intf = {
+	.id = GONE_INTF_ID,
+	.write = gone_write,
+};
+
+static struct gb_interface spare_intf = {
+	.id = SPARE_INTF_ID,
+	.write = fast_write,
+};
+
+static struct gb_message *test_msg(void)
+{
+	struct gb_message *msg = gb_message_request_alloc(0, 1, false);
+
+	zassert_not_null(msg, "Failed to allocate message");
+
+	return msg;
+}
+
+static void *apbridge_txq_setup(void)
+{
+	zassert_ok(gb_interface_add(&ap_intf), "Failed to add AP");
+	zassert_ok(gb_interface_add(&slow_intf), "Failed to add slow interface");
+	zassert_ok(gb_interface_add(&fast_intf), "Failed to add fast interface");
+
+	zassert_ok(gb_apbridge_connection_create(AP_INF_ID, 1, SLOW_INTF_ID, 0));
+	zassert_ok(gb_apbridge_connection_create(AP_INF_ID, 2, FAST_INTF_ID, 0));
+
+	return NULL;
+}
+
+ZTEST_SUITE(greybus_apbridge_txq_tests, NULL, apbridge_txq_setup, NULL, NULL, NULL);
+
+ZTEST(greybus_apbridge_txq_tests, test_stalled_interface)
+{
+	struct gb_apbridge_tx_stats stats;
+	int i;
+
+	/* One message held by the worker, the queue full behind it */
+	zassert_ok(gb_apbridge_send(AP_INF_ID, 1, test_msg()));
+	k_msleep(10);
+	for (i = 0; i < TXQ_DEPTH; i++) {
+		zassert_ok(gb_apbridge_send(AP_INF_ID, 1, test_msg()));
+	}
+
+	zassert_equal(gb_apbridge_send(AP_INF_ID, 1, test_msg()), -ENOBUFS,
+		      "Full queue should drop");
+
+	zassert_ok(gb_apbridge_tx_stats(SLOW_INTF_ID, &stats));
+	zassert_equal(stats.queued, TXQ_DEPTH, "Invalid queue depth");
+	zassert_equal(stats.max_queued, TXQ_DEPTH, "Invalid queue high water mark");
+	zassert_equal(stats.dropped, 1, "Drop not counted");
+
+	/* The other interface keeps going */
+	for (i = 0; i < 2 * TXQ_DEPTH; i++) {
+		zassert_ok(gb_apbridge_send(AP_INF_ID, 2, test_msg()));
+		zassert_ok(k_sem_take(&fast_written, K_MSEC(100)),
+			   "Stalled interface blocked another one");
+	}
+
+	for (i = 0; i < TXQ_DEPTH + 1; i++) {
+		k_sem_give(&slow_unblock);
+		zassert_ok(k_sem_take(&slow_written, K_MSEC(100)), "Queued message not written");
+	}
+
+	zassert_ok(gb_apbridge_tx_stats(SLOW_INTF_ID, &stats));
+	zassert_equal(stats.queued, 0, "Queue should be empty");
+	zassert_equal(stats.sent, TXQ_DEPTH + 1, "Invalid sent count");
+
+	zassert_ok(gb_apbridge_tx_stats(FAST_INTF_ID, &stats));
+	zassert_equal(stats.sent, 2 * TXQ_DEPTH, "Invalid sent count");
+	zassert_equal(stats.dropped, 0, "Nothing should be dropped");
+}
+
+ZTEST(greybus_apbridge_txq_tests, test_stats_missing)
+{
+	struct gb_apbridge_tx_stats stats;
+
+	zassert_equal(gb_apbridge_tx_stats(AP_MAX_INTERFACES - 1, &stats), -ENOENT,
+		      "No interface, no stats");
+}
+
+static void gone_remover(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	gb_interface_remove(GONE_INTF_ID);
+	k_sem_give(&gone_removed);
+}
+
+K_THREAD_STACK_DEFINE(gone_stack, 1024);
+static struct k_thread gone_thread;
+
+ZTEST(greybus_apbridge_txq_tests, test_remove_while_writing)
+{
+	int i;
+
+	zassert_ok(gb_interface_add(&gone_intf), "Failed to add interface");
+	zassert_ok(gb_apbridge_connection_create(AP_INF_ID, 3, GONE_INTF_ID, 0));
+
+	/* One message held by the worker, the queue full behind it */
+	zassert_ok(gb_apbridge_send(AP_INF_ID, 3, test_msg()));
+	k_msleep(10);
+	for (i = 0; i < TXQ_DEPTH; i++) {
+		zassert_ok(gb_apbridge_send(AP_INF_ID, 3, test_msg()));
+	}
+
+	k_thread_create(&gone_thread, gone_stack, K_THREAD_STACK_SIZEOF(gone_stack), gone_remover,
+			NULL, NULL, NULL, k_thread_priority_get(k_current_get()), 0, K_NO_WAIT);
+
+	zassert_equal(k_sem_take(&gone_removed, K_MSEC(50)), -EAGAIN,
+		      "Removal should wait for the write in progress");
+
+	/* Other interfaces can come and go meanwhile */
+	zassert_ok(gb_interface_add(&spare_intf), "Add blocked by a pending removal");
+	gb_interface_remove(SPARE_INTF_ID);
+	zassert_equal(k_sem_take(&gone_removed, K_NO_WAIT), -EBUSY, "Removal should still wait");
+
+	k_sem_give(&gone_unblock);
+	zassert_ok(k_sem_take(&gone_removed, K_MSEC(100)), "Removal did not complete");
+	k_thread_join(&gone_thread, K_FOREVER);
+
+	/* Queued messages are dropped, never written to the removed interface */
+	k_sem_give(&gone_unblock);
+	k_msleep(10);
+	zassert_equal(atomic_get(&gone_writes), 1, "Only the message in progress is written");
+	zassert_is_null(gb_interface_get(GONE_INTF_ID), "Interface should be removed");
+}
@@ -12,12 +12,33 @@
 #include <zephyr/device.h>
 #include <zephyr/drivers/gpio.h>
 #include <zephyr/drivers/gpio/gpio_emul.h>
+#include <greybus/gpio.h>
 
 static const struct device *dev = DEVICE_DT_GET(DT_NODELABEL(gpio0));
 
 struct gb_msg_with_cport gb_transport_get_message(void);
 
-ZTEST_SUITE(greybus_gpio_tests, NULL, NULL, NULL, NULL, NULL);
+static void *gpio_setup(void)
+{
+	struct gb_msg_with_cport resp;
+	struct gb_control_connected_request *req_data;
+	struct gb_message *msg =
+		gb_message_request_alloc(sizeof(*req_data), GB_CONTROL_TYPE_CONNECTED, false);
+
+	/* Registers the interrupt callback of the port */
+	req_data = (struct gb_control_connected_request *)msg->payload;
+	req_data->cport_id = sys_cpu_to_le16(1);
+
+	greybus_rx_handler(0, msg);
+	resp = gb_transport_get_message();
+	zassert_equal(resp.cport, 0, "Invalid cport");
+	zassert(gb_message_is_success(resp.msg), "Connected request failed");
+	gb_message_dealloc(resp.msg);
+
+	return NULL;
+}
+
+ZTEST_SUITE(greybus_gpio_tests, NULL, gpio_setup, NULL, NULL, NULL);
 
 ZTEST(greybus_gpio_tests, test_cport_count)
 {
@@ -198,3 +219,313 @@ ZTEST(greybus_gpio_tests, test_invalid_pin_index)
 		      "Driver should have rejected invalid pin index 255");
 	gb_message_dealloc(msg);
 }
+
+ZTEST(greybus_gpio_tests, test_port_direction)
+{
+	struct gb_msg_with_cport resp;
+	struct gb_gpio_port_direction_request *req_data;
+	struct gb_message *msg =
+		gb_message_request_alloc(sizeof(*req_data), GB_GPIO_TYPE_PORT_DIRECTION, false);
+
+	req_data = (struct gb_gpio_port_direction_request *)msg->payload;
+	req_data->mask = sys_cpu_to_le32(BIT(1) | BIT(2) | BIT(3));
+	req_data->output = sys_cpu_to_le32(BIT(1) | BIT(2));
+	req_data->value = sys_cpu_to_le32(BIT(2));
+
+	greybus_rx_handler(1, msg);
+	resp = get_first_non_event_checked(GB_RESPONSE(GB_GPIO_TYPE_PORT_DIRECTION), 0);
+	gb_message_dealloc(resp.msg);
+
+	zassert_false(gpio_pin_is_input(dev, 1), "Pin 1 was not configured as output");
+	zassert_false(gpio_pin_is_input(dev, 2), "Pin 2 was not configured as output");
+	zassert_true(gpio_pin_is_input(dev, 3), "Pin 3 was not configured as input");
+	zassert_equal(gpio_emul_output_get(dev, 1), 0, "Pin 1 should start low");
+	zassert_equal(gpio_emul_output_get(dev, 2), 1, "Pin 2 should start high");
+}
+
+ZTEST(greybus_gpio_tests, test_port_set)
+{
+	struct gb_msg_with_cport resp;
+	struct gb_gpio_port_set_request *req_data;
+	struct gb_message *msg =
+		gb_message_request_alloc(sizeof(*req_data), GB_GPIO_TYPE_PORT_SET, false);
+
+	gpio_pin_configure(dev, 4, GPIO_OUTPUT_LOW);
+	gpio_pin_configure(dev, 5, GPIO_OUTPUT_LOW);
+	gpio_pin_configure(dev, 6, GPIO_OUTPUT_HIGH);
+
+	/* Pin 6 is left alone */
+	req_data = (struct gb_gpio_port_set_request *)msg->payload;
+	req_data->mask = sys_cpu_to_le32(BIT(4) | BIT(5));
+	req_data->value = sys_cpu_to_le32(BIT(5) | BIT(6));
+
+	greybus_rx_handler(1, msg);
+	resp = get_first_non_event_checked(GB_RESPONSE(GB_GPIO_TYPE_PORT_SET), 0);
+	gb_message_dealloc(resp.msg);
+
+	zassert_equal(gpio_emul_output_get(dev, 4), 0, "Pin 4 should be low");
+	zassert_equal(gpio_emul_output_get(dev, 5), 1, "Pin 5 should be high");
+	zassert_equal(gpio_emul_output_get(dev, 6), 1, "Pin 6 should not change");
+}
+
+ZTEST(greybus_gpio_tests, test_port_get)
+{
+	struct gb_msg_with_cport resp;
+	const struct gb_gpio_port_get_response *resp_data;
+	struct gb_message *msg = gb_message_request_alloc(0, GB_GPIO_TYPE_PORT_GET, false);
+	uint32_t value;
+
+	gpio_pin_configure(dev, 7, GPIO_INPUT);
+	gpio_pin_configure(dev, 8, GPIO_INPUT);
+	gpio_emul_input_set(dev, 7, 1);
+	gpio_emul_input_set(dev, 8, 0);
+
+	greybus_rx_handler(1, msg);
+	resp = get_first_non_event_checked(GB_RESPONSE(GB_GPIO_TYPE_PORT_GET), sizeof(*resp_data));
+	resp_data = (const struct gb_gpio_port_get_response *)resp.msg->payload;
+	value = sys_le32_to_cpu(resp_data->value);
+	gb_message_dealloc(resp.msg);
+
+	zassert_true(value & BIT(7), "Pin 7 should be high");
+	zassert_false(value & BIT(8), "Pin 8 should be low");
+}
+
+ZTEST(greybus_gpio_tests, test_irq_coalesced)
+{
+	struct gb_msg_with_cport event;
+	const struct gb_gpio_irq_event_request *event_data;
+	struct gb_gpio_irq_stats before, after;
+
+	gpio_pin_configure(dev, 10, GPIO_INPUT);
+	gpio_emul_input_set(dev, 10, 0);
+	gpio_pin_interrupt_configure(dev, 10, GPIO_INT_EDGE_BOTH);
+	zassert_ok(gb_gpio_irq_stats(1, &before), "Failed to get IRQ stats");
+
+	/* All edges happen before the work queue gets to send */
+	k_sched_lock();
+	gpio_emul_input_set(dev, 10, 1);
+	gpio_emul_input_set(dev, 10, 0);
+	gpio_emul_input_set(dev, 10, 1);
+	k_sched_unlock();
+
+	event = gb_transport_get_message();
+	zassert_equal(event.cport, 1, "Invalid cport");
+	zassert_equal(gb_message_type(event.msg), GB_GPIO_TYPE_IRQ_EVENT, "Invalid event type");
+	event_data = (const struct gb_gpio_irq_event_request *)event.msg->payload;
+	zassert_equal(event_data->which, 10, "Invalid event line");
+	gb_message_dealloc(event.msg);
+
+	k_msleep(10);
+	gpio_pin_interrupt_configure(dev, 10, GPIO_INT_DISABLE);
+
+	zassert_ok(gb_gpio_irq_stats(1, &after), "Failed to get IRQ stats");
+	zassert_equal(after.sent, before.sent + 1, "Edges should be sent as one event");
+	zassert_equal(after.merged, before.merged + 2, "Merged edges not counted");
+	zassert_equal(after.dropped, before.dropped, "No event should be dropped");
+
+	zassert_equal(gb_gpio_irq_stats(0, &after), -ENOENT, "Control cport is not a GPIO port");
+}
+
+static void gpio_request_checked(uint8_t type, const void *payload, size_t len)
+{
+	struct gb_msg_with_cport resp;
+	struct gb_message *msg = gb_message_request_alloc(len, type, false);
+
+	memcpy(msg->payload, payload, len);
+
+	greybus_rx_handler(1, msg);
+	resp = get_first_non_event_checked(GB_RESPONSE(type), 0);
+	gb_message_dealloc(resp.msg);
+}
+
+ZTEST(greybus_gpio_tests, test_debounce)
+{
+	const struct gb_gpio_irq_type_request irq_type = {
+		.which = 12,
+		.type = GB_GPIO_IRQ_TYPE_EDGE_BOTH,
+	};
+	const struct gb_gpio_set_debounce_request debounce = {
+		.which = 12,
+		.usec = sys_cpu_to_le16(5000),
+	};
+	const struct gb_gpio_irq_mask_request mask = {
+		.which = 12,
+	};
+	struct gb_msg_with_cport event;
+	const struct gb_gpio_irq_event_request *event_data;
+	struct gb_gpio_irq_stats before, after;
+
+	gpio_pin_configure(dev, 12, GPIO_INPUT);
+	gpio_emul_input_set(dev, 12, 0);
+	gpio_request_checked(GB_GPIO_TYPE_IRQ_TYPE, &irq_type, sizeof(irq_type));
+	gpio_request_checked(GB_GPIO_TYPE_SET_DEBOUNCE, &debounce, sizeof(debounce));
+	zassert_ok(gb_gpio_irq_stats(1, &before), "Failed to get IRQ stats");
+
+	/* Bouncing press, only the settled level is reported */
+	k_sched_lock();
+	gpio_emul_input_set(dev, 12, 1);
+	gpio_emul_input_set(dev, 12, 0);
+	gpio_emul_input_set(dev, 12, 1);
+	gpio_emul_input_set(dev, 12, 0);
+	gpio_emul_input_set(dev, 12, 1);
+	k_sched_unlock();
+
+	event = gb_transport_get_message();
+	zassert_equal(event.cport, 1, "Invalid cport");
+	zassert_equal(gb_message_type(event.msg), GB_GPIO_TYPE_IRQ_EVENT, "Invalid event type");
+	event_data = (const struct gb_gpio_irq_event_request *)event.msg->payload;
+	zassert_equal(event_data->which, 12, "Invalid event line");
+	gb_message_dealloc(event.msg);
+
+	/* Glitch shorter than the debounce time */
+	k_msleep(20);
+	gpio_emul_input_set(dev, 12, 0);
+	gpio_emul_input_set(dev, 12, 1);
+	k_msleep(20);
+
+	gpio_request_checked(GB_GPIO_TYPE_IRQ_MASK, &mask, sizeof(mask));
+
+	zassert_ok(gb_gpio_irq_stats(1, &after), "Failed to get IRQ stats");
+	zassert_equal(after.sent, before.sent + 1, "Only the settled edge should be sent");
+	zassert_equal(after.debounced, before.debounced + 5, "Bounces not counted");
+}
+
+static const struct gb_gpio_capture_event_request *
+get_capture_event_checked(struct gb_message **msg, uint16_t count)
+{
+	struct gb_msg_with_cport event = gb_transport_get_message();
+	const struct gb_gpio_capture_event_request *event_data =
+		(const struct gb_gpio_capture_event_request *)event.msg->payload;
+
+	zassert_equal(event.cport, 1, "Invalid cport");
+	zassert_equal(gb_message_type(event.msg), GB_GPIO_TYPE_CAPTURE_EVENT, "Invalid event type");
+	zassert_equal(gb_message_payload_len(event.msg),
+		      sizeof(*event_data) + count * sizeof(event_data->records[0]),
+		      "Invalid event size");
+	zassert_equal(sys_le16_to_cpu(event_data->count), count, "Invalid record count");
+
+	*msg = event.msg;
+	return event_data;
+}
+
+ZTEST(greybus_gpio_tests, test_capture)
+{
+	const struct gb_gpio_capture_enable_request enable = {
+		.mask = sys_cpu_to_le32(BIT(16)),
+		.count = sys_cpu_to_le16(4),
+	};
+	const struct gb_gpio_capture_event_request *event_data;
+	const struct gb_gpio_capture_enable_response *resp_data;
+	struct gb_gpio_capture_stats before, after;
+	struct gb_msg_with_cport resp;
+	struct gb_message *msg;
+	uint64_t timestamp = 0;
+	size_t i, j;
+
+	gpio_pin_configure(dev, 16, GPIO_INPUT);
+	gpio_emul_input_set(dev, 16, 0);
+	zassert_ok(gb_gpio_capture_stats(1, &before), "Failed to get capture stats");
+
+	msg = gb_message_request_alloc(sizeof(enable), GB_GPIO_TYPE_CAPTURE_ENABLE, false);
+	memcpy(msg->payload, &enable, sizeof(enable));
+	greybus_rx_handler(1, msg);
+	resp = get_first_non_event_checked(GB_RESPONSE(GB_GPIO_TYPE_CAPTURE_ENABLE),
+					   sizeof(*resp_data));
+	resp_data = (const struct gb_gpio_capture_enable_response *)resp.msg->payload;
+	zassert_equal(sys_le32_to_cpu(resp_data->clock_hz), sys_clock_hw_cycles_per_sec(),
+		      "Invalid timestamp clock");
+	gb_message_dealloc(resp.msg);
+
+	/* Two more edges than the buffer holds before the work queue can run */
+	k_sched_lock();
+	for (i = 0; i < 10; i++) {
+		gpio_emul_input_set(dev, 16, (i + 1) % 2);
+	}
+	k_sched_unlock();
+
+	for (i = 0; i < 2; i++) {
+		event_data = get_capture_event_checked(&msg, 4);
+		zassert_equal(sys_le32_to_cpu(event_data->overruns), i == 0 ? 2 : 0,
+			      "Overruns not reported with the first event");
+		for (j = 0; j < 4; j++) {
+			zassert_equal(event_data->records[j].which, 16, "Invalid record line");
+			zassert_equal(event_data->records[j].value, (j + 1) % 2, "Invalid level");
+			zassert_true(sys_le64_to_cpu(event_data->records[j].timestamp) >= timestamp,
+				     "Timestamps out of order");
+			timestamp = sys_le64_to_cpu(event_data->records[j].timestamp);
+		}
+		gb_message_dealloc(msg);
+	}
+
+	/* Less than count records go out after the latency */
+	gpio_emul_input_set(dev, 16, 1);
+	event_data = get_capture_event_checked(&msg, 1);
+	zassert_equal(event_data->records[0].value, 1, "Invalid level");
+	gb_message_dealloc(msg);
+
+	msg = gb_message_request_alloc(0, GB_GPIO_TYPE_CAPTURE_DISABLE, false);
+	greybus_rx_handler(1, msg);
+	resp = get_first_non_event_checked(GB_RESPONSE(GB_GPIO_TYPE_CAPTURE_DISABLE), 0);
+	gb_message_dealloc(resp.msg);
+
+	zassert_ok(gb_gpio_capture_stats(1, &after), "Failed to get capture stats");
+	zassert_equal(after.captured, before.captured + 9, "Captured edges not counted");
+	zassert_equal(after.overruns, before.overruns + 2, "Overruns not counted");
+	zassert_equal(after.sent, before.sent + 3, "Capture events not counted");
+	zassert_equal(after.dropped, before.dropped, "No record should be dropped");
+}
+
+ZTEST(greybus_gpio_tests, test_capture_restores_irq)
+{
+	const struct gb_gpio_irq_type_request irq_type = {
+		.which = 18,
+		.type = GB_GPIO_IRQ_TYPE_EDGE_RISING,
+	};
+	const struct gb_gpio_capture_enable_request enable = {
+		.mask = sys_cpu_to_le32(BIT(18)),
+		.count = sys_cpu_to_le16(1),
+	};
+	const struct gb_gpio_irq_mask_request mask = {
+		.which = 18,
+	};
+	const struct gb_gpio_irq_event_request *irq_data;
+	const struct gb_gpio_capture_event_request *event_data;
+	struct gb_msg_with_cport resp, event;
+	struct gb_message *msg;
+
+	gpio_pin_configure(dev, 18, GPIO_INPUT);
+	gpio_emul_input_set(dev, 18, 0);
+	gpio_request_checked(GB_GPIO_TYPE_IRQ_TYPE, &irq_type, sizeof(irq_type));
+
+	msg = gb_message_request_alloc(sizeof(enable), GB_GPIO_TYPE_CAPTURE_ENABLE, false);
+	memcpy(msg->payload, &enable, sizeof(enable));
+	greybus_rx_handler(1, msg);
+	resp = get_first_non_event_checked(GB_RESPONSE(GB_GPIO_TYPE_CAPTURE_ENABLE),
+					   sizeof(struct gb_gpio_capture_enable_response));
+	gb_message_dealloc(resp.msg);
+
+	/* The host's IRQ setup is kept while capturing, not applied over capture */
+	gpio_request_checked(GB_GPIO_TYPE_IRQ_TYPE, &irq_type, sizeof(irq_type));
+	gpio_emul_input_set(dev, 18, 1);
+	event_data = get_capture_event_checked(&msg, 1);
+	zassert_equal(event_data->records[0].which, 18, "Invalid record line");
+	gb_message_dealloc(msg);
+
+	msg = gb_message_request_alloc(0, GB_GPIO_TYPE_CAPTURE_DISABLE, false);
+	greybus_rx_handler(1, msg);
+	resp = get_first_non_event_checked(GB_RESPONSE(GB_GPIO_TYPE_CAPTURE_DISABLE), 0);
+	gb_message_dealloc(resp.msg);
+
+	/* Rising edges raise IRQ events again once capture stops */
+	gpio_emul_input_set(dev, 18, 0);
+	gpio_emul_input_set(dev, 18, 1);
+
+	event = gb_transport_get_message();
+	zassert_equal(event.cport, 1, "Invalid cport");
+	zassert_equal(gb_message_type(event.msg), GB_GPIO_TYPE_IRQ_EVENT, "Invalid event type");
+	irq_data = (const struct gb_gpio_irq_event_request *)event.msg->payload;
+	zassert_equal(irq_data->which, 18, "Invalid event line");
+	gb_message_dealloc(event.msg);
+
+	gpio_request_checked(GB_GPIO_TYPE_IRQ_MASK, &mask, sizeof(mask));
+}
@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2026 BeagleBoard.org
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "greybus/greybus_messages.h"
+#include "greybus/greybus_protocols.h"
+#include <zephyr/ztest.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/gpio/gpio_emul.h>
+#include <greybus/greybus.h>
+#include <greybus/gpio.h>
+
+#define GPIO_CPORT 1
+
+static const struct device *dev = DEVICE_DT_GET(DT_NODELABEL(gpio0));
+
+struct gb_msg_with_cport gb_transport_get_message(void);
+
+static struct gb_message *gpio_request(uint8_t type, const void *payload, size_t len)
+{
+	struct gb_message *req = gb_message_request_alloc(len, type, false);
+	struct gb_msg_with_cport resp;
+
+	zassert_not_null(req, "Failed to allocate request");
+	memcpy(req->payload, payload, len);
+	zassert_ok(greybus_rx_handler(GPIO_CPORT, req), "Failed to handle request");
+
+	resp = gb_transport_get_message();
+	zassert_not_null(resp.msg, "No response received");
+	zassert_equal(resp.cport, GPIO_CPORT, "Response received on wrong cport");
+	zassert_equal(gb_message_type(resp.msg), GB_RESPONSE(type), "Wrong response type");
+	zassert_true(gb_message_is_success(resp.msg), "Request failed");
+
+	return resp.msg;
+}
+
+static void gpio_request_empty(uint8_t type, const void *payload, size_t len)
+{
+	gb_message_dealloc(gpio_request(type, payload, len));
+}
+
+static uint8_t get_direction(uint8_t which)
+{
+	const struct gb_gpio_get_direction_request req = {
+		.which = which,
+	};
+	struct gb_message *resp = gpio_request(GB_GPIO_TYPE_GET_DIRECTION, &req, sizeof(req));
+	const uint8_t direction =
+		((const struct gb_gpio_get_direction_response *)resp->payload)->direction;
+
+	gb_message_dealloc(resp);
+
+	return direction;
+}
+
+static uint8_t get_value(uint8_t which)
+{
+	const struct gb_gpio_get_value_request req = {
+		.which = which,
+	};
+	struct gb_message *resp = gpio_request(GB_GPIO_TYPE_GET_VALUE, &req, sizeof(req));
+	const uint8_t value = ((const struct gb_gpio_get_value_response *)resp->payload)->value;
+
+	gb_message_dealloc(resp);
+
+	return value;
+}
+
+static void cache_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	zassert_ok(gb_gpio_cache_invalidate(GPIO_CPORT), "Failed to invalidate cache");
+}
+
+ZTEST_SUITE(greybus_gpio_cache_tests, NULL, NULL, cache_before, NULL, NULL);
+
+ZTEST(greybus_gpio_cache_tests, test_invalidate_invalid_cport)
+{
+	zassert_equal(gb_gpio_cache_invalidate(0), -ENOENT, "Control cport is not a GPIO port");
+}
+
+ZTEST(greybus_gpio_cache_tests, test_direction)
+{
+	const struct gb_gpio_direction_in_request req = {
+		.which = 0,
+	};
+
+	gpio_request_empty(GB_GPIO_TYPE_DIRECTION_IN, &req, sizeof(req));
+	zassert_equal(get_direction(0), 1, "Pin should be input");
+
+	/* Changed behind the back of Greybus, the cache still answers */
+	gpio_pin_configure(dev, 0, GPIO_OUTPUT_LOW);
+	zassert_equal(get_direction(0), 1, "Direction not answered from cache");
+
+	zassert_ok(gb_gpio_cache_invalidate(GPIO_CPORT), "Failed to invalidate cache");
+	zassert_equal(get_direction(0), 0, "Direction not read after invalidate");
+
+	/* Redundant direction in is not skipped once the cache was invalidated */
+	gpio_request_empty(GB_GPIO_TYPE_DIRECTION_IN, &req, sizeof(req));
+	zassert_true(gpio_pin_is_input(dev, 0), "Pin was not configured as input");
+}
+
+ZTEST(greybus_gpio_cache_tests, test_output_value)
+{
+	const struct gb_gpio_direction_out_request out = {
+		.which = 2,
+		.value = 1,
+	};
+	const struct gb_gpio_set_value_request set = {
+		.which = 2,
+		.value = 1,
+	};
+
+	gpio_request_empty(GB_GPIO_TYPE_DIRECTION_OUT, &out, sizeof(out));
+	zassert_equal(gpio_emul_output_get(dev, 2), 1, "Output not driven high");
+	zassert_equal(get_direction(2), 0, "Pin should be output");
+	zassert_equal(get_value(2), 1, "Output level not cached");
+
+	/* Setting the level the output already has is not written */
+	gpio_pin_set_raw(dev, 2, 0);
+	gpio_request_empty(GB_GPIO_TYPE_SET_VALUE, &set, sizeof(set));
+	zassert_equal(gpio_emul_output_get(dev, 2), 0, "Redundant write not skipped");
+
+	zassert_ok(gb_gpio_cache_invalidate(GPIO_CPORT), "Failed to invalidate cache");
+	gpio_request_empty(GB_GPIO_TYPE_SET_VALUE, &set, sizeof(set));
+	zassert_equal(gpio_emul_output_get(dev, 2), 1, "Value not written after invalidate");
+}
+
+ZTEST(greybus_gpio_cache_tests, test_port_set)
+{
+	const struct gb_gpio_port_direction_request dir = {
+		.mask = sys_cpu_to_le32(BIT(4) | BIT(5)),
+		.output = sys_cpu_to_le32(BIT(4) | BIT(5)),
+		.value = sys_cpu_to_le32(BIT(5)),
+	};
+	const struct gb_gpio_port_set_request set = {
+		.mask = sys_cpu_to_le32(BIT(4) | BIT(5)),
+		.value = sys_cpu_to_le32(BIT(4) | BIT(5)),
+	};
+
+	gpio_request_empty(GB_GPIO_TYPE_PORT_DIRECTION, &dir, sizeof(dir));
+
+	/* Only the lines changing level are written */
+	gpio_pin_set_raw(dev, 5, 0);
+	gpio_request_empty(GB_GPIO_TYPE_PORT_SET, &set, sizeof(set));
+	zassert_equal(gpio_emul_output_get(dev, 4), 1, "Changed pin not written");
+	zassert_equal(gpio_emul_output_get(dev, 5), 0, "Unchanged pin written");
+	zassert_equal(get_value(4), 1, "Pin level not cached");
+	zassert_equal(get_value(5), 1, "Pin level not cached");
+}
+
+ZTEST(greybus_gpio_cache_tests, test_active_low_value)
+{
+	struct gb_gpio_set_value_request set = {
+		.which = 6,
+		.value = 1,
+	};
+
+	/* Single line values are logical with or without the cache */
+	gpio_pin_configure(dev, 6, GPIO_OUTPUT_INACTIVE | GPIO_ACTIVE_LOW);
+	zassert_ok(gb_gpio_cache_invalidate(GPIO_CPORT), "Failed to invalidate cache");
+
+	gpio_request_empty(GB_GPIO_TYPE_SET_VALUE, &set, sizeof(set));
+	zassert_equal(gpio_emul_output_get(dev, 6), 0, "Active line not driven low");
+	zassert_equal(get_value(6), 1, "Logical value not returned");
+
+	set.value = 0;
+	gpio_request_empty(GB_GPIO_TYPE_SET_VALUE, &set, sizeof(set));
+	zassert_equal(gpio_emul_output_get(dev, 6), 1, "Inactive line not driven high");
+	zassert_equal(get_value(6), 0, "Logical value not returned");
+}
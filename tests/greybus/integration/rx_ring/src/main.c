@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2026 BeagleBoard.org
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/sys/byteorder.h>
+#include <greybus/greybus.h>
+#include <greybus-utils/manifest.h>
+#include "greybus_transport.h"
+
+#define LOOPBACK_CPORT 1
+#define FRAME_LEN      (sizeof(__le16) + sizeof(struct gb_operation_msg_hdr))
+#define RING_RECORDS   3
+
+struct gb_msg_with_cport gb_transport_get_message(void);
+
+GB_RX_RING_DEFINE(ring, RING_RECORDS * GB_RX_RING_RECORD_SIZE(FRAME_LEN), NULL);
+
+static void ping_frame_put(uint8_t *buf)
+{
+	struct gb_message *req = gb_message_request_alloc(0, GB_LOOPBACK_TYPE_PING, false);
+
+	sys_put_le16(LOOPBACK_CPORT, buf);
+	memcpy(&buf[sizeof(__le16)], req, gb_message_len(req));
+	gb_message_dealloc(req);
+}
+
+static void ping_publish(size_t count)
+{
+	uint8_t *buf = gb_rx_ring_claim(&ring, count * FRAME_LEN);
+	size_t i;
+
+	zassert_not_null(buf, "Ring should have space");
+
+	for (i = 0; i < count; i++) {
+		ping_frame_put(&buf[i * FRAME_LEN]);
+	}
+
+	gb_rx_ring_commit(&ring, count * FRAME_LEN);
+}
+
+static void check_ping_responses(size_t count)
+{
+	struct gb_msg_with_cport resp;
+	size_t i;
+
+	for (i = 0; i < count; i++) {
+		resp = gb_transport_get_message();
+		zassert_equal(resp.cport, LOOPBACK_CPORT, "Invalid cport");
+		zassert_equal(gb_message_type(resp.msg), GB_RESPONSE(GB_LOOPBACK_TYPE_PING),
+			      "Invalid response type");
+		zassert_equal(resp.msg->header.result, GB_OP_SUCCESS,
+			      "Greybus loopback ping failed");
+		gb_message_dealloc(resp.msg);
+	}
+}
+
+static void *rx_ring_setup(void)
+{
+	zassert_ok(gb_rx_ring_register(&ring), "Failed to register ring");
+
+	return NULL;
+}
+
+ZTEST_SUITE(greybus_rx_ring_tests, NULL, rx_ring_setup, NULL, NULL, NULL);
+
+ZTEST(greybus_rx_ring_tests, test_ping)
+{
+	ping_publish(1);
+	check_ping_responses(1);
+}
+
+ZTEST(greybus_rx_ring_tests, test_frames_in_record)
+{
+	ping_publish(2);
+	check_ping_responses(2);
+}
+
+ZTEST(greybus_rx_ring_tests, test_wrap)
+{
+	size_t i;
+
+	/* Odd record sizes so records end up split by the end of the buffer */
+	for (i = 0; i < 4 * RING_RECORDS; i++) {
+		ping_publish(1 + i % 2);
+		check_ping_responses(1 + i % 2);
+	}
+}
+
+ZTEST(greybus_rx_ring_tests, test_full)
+{
+	size_t i;
+
+	/* Keep the dispatcher from draining the ring */
+	k_sched_lock();
+
+	for (i = 0; i < RING_RECORDS - 1; i++) {
+		ping_publish(1);
+	}
+
+	zassert_is_null(gb_rx_ring_claim(&ring, FRAME_LEN), "Ring should be full");
+
+	k_sched_unlock();
+
+	check_ping_responses(RING_RECORDS - 1);
+}
+
+ZTEST(greybus_rx_ring_tests, test_too_large)
+{
+	zassert_is_null(gb_rx_ring_claim(&ring, ring.size), "Record larger than the ring should not fit");
+}
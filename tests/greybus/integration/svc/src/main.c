@@ -9,7 +9,251 @@
 #include <greybus/greybus.h>
 #include <greybus-utils/manifest.h>
 #include <greybus/greybus_log.h>
+#include <greybus/apbridge.h>
+#include <greybus/svc.h>
+#include <zephyr/sys/byteorder.h>
 
-// struct gb_msg_with_cport gb_transport_get_message(void);
+#define SVC_QUEUE_DEPTH CONFIG_GREYBUS_SVC_QUEUE_DEPTH
 
-ZTEST_SUITE(greybus_svc_tests, NULL, NULL, NULL, NULL, NULL);
+K_MSGQ_DEFINE(ap_msgq, sizeof(struct gb_msg_with_cport), SVC_QUEUE_DEPTH + 4, 4);
+
+static bool ap_answers_hello;
+static k_tid_t ap_write_thread;
+/* Stalls the SVC work queue in the next write to the AP */
+static bool ap_stall;
+static K_SEM_DEFINE(ap_unstall, 0, K_SEM_MAX_LIMIT);
+
+/* Answers the SVC init exchange, everything else is left to the test */
+static int ap_write(struct gb_interface *intf, struct gb_message *msg, uint16_t cport)
+{
+	const struct gb_msg_with_cport item = {
+		.cport = cport,
+		.msg = msg,
+	};
+	struct gb_message *resp;
+
+	ARG_UNUSED(intf);
+
+	ap_write_thread = k_current_get();
+
+	switch (gb_message_type(msg)) {
+	case GB_SVC_TYPE_SVC_HELLO:
+		if (!ap_answers_hello) {
+			gb_message_dealloc(msg);
+			return 0;
+		}
+		__fallthrough;
+	case GB_SVC_TYPE_PROTOCOL_VERSION:
+		resp = gb_message_response_alloc_from_req(NULL, 0, msg, GB_OP_SUCCESS);
+		gb_message_dealloc(msg);
+		return gb_apbridge_send(AP_INF_ID, 0, resp);
+	default:
+		if (ap_stall) {
+			k_sem_take(&ap_unstall, K_FOREVER);
+		}
+		return k_msgq_put(&ap_msgq, &item, K_NO_WAIT);
+	}
+}
+
+static void ap_unstall_fn(struct k_work *work)
+{
+	ARG_UNUSED(work);
+
+	ap_stall = false;
+	k_sem_give(&ap_unstall);
+}
+
+static K_WORK_DELAYABLE_DEFINE(ap_unstall_work, ap_unstall_fn);
+
+static struct gb_interface ap_intf = {
+	.id = AP_INF_ID,
+	.write = ap_write,
+};
+
+static K_SEM_DEFINE(init_done, 0, 1);
+static int init_status;
+static k_tid_t init_thread;
+
+static void init_cb(int status, void *user_data)
+{
+	zassert_equal_ptr(user_data, &init_done, "Invalid user data");
+
+	init_status = status;
+	init_thread = k_current_get();
+	k_sem_give(&init_done);
+}
+
+static void *svc_setup(void)
+{
+	zassert_ok(gb_interface_add(&ap_intf), "Failed to add AP");
+
+	return NULL;
+}
+
+static void svc_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	ap_answers_hello = true;
+	ap_stall = false;
+	k_sem_reset(&init_done);
+	k_msgq_purge(&ap_msgq);
+}
+
+static void svc_after(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	gb_svc_deinit();
+}
+
+ZTEST_SUITE(greybus_svc_tests, NULL, svc_setup, svc_before, svc_after, NULL);
+
+ZTEST(greybus_svc_tests, test_init_async)
+{
+	zassert_ok(gb_svc_init_async(init_cb, &init_done), "Failed to start SVC init");
+
+	zassert_ok(k_sem_take(&init_done, K_SECONDS(1)), "Init not completed");
+	zassert_ok(init_status, "SVC init failed");
+	zassert_not_equal(init_thread, k_current_get(), "Callback should run on the SVC work queue");
+}
+
+ZTEST(greybus_svc_tests, test_init_timeout)
+{
+	ap_answers_hello = false;
+
+	zassert_ok(gb_svc_init_async(init_cb, &init_done), "Failed to start SVC init");
+
+	zassert_ok(k_sem_take(&init_done, K_MSEC(CONFIG_GREYBUS_SVC_INIT_TIMEOUT_MS * 2)),
+		   "Init not completed");
+	zassert_equal(init_status, -ETIMEDOUT, "Init should time out");
+}
+
+ZTEST(greybus_svc_tests, test_init_sync)
+{
+	zassert_ok(gb_svc_init(), "SVC init failed");
+}
+
+ZTEST(greybus_svc_tests, test_init_twice)
+{
+	zassert_ok(gb_svc_init(), "SVC init failed");
+	zassert_equal(gb_svc_init_async(init_cb, &init_done), -EALREADY,
+		      "SVC interface already added");
+}
+
+ZTEST(greybus_svc_tests, test_handled_on_work_queue)
+{
+	struct gb_message *req = gb_message_request_alloc(0, GB_SVC_TYPE_PING, false);
+	struct gb_msg_with_cport item;
+
+	zassert_ok(gb_svc_init(), "SVC init failed");
+
+	zassert_ok(gb_apbridge_send(AP_INF_ID, 0, req), "Failed to send request to SVC");
+
+	zassert_ok(k_msgq_get(&ap_msgq, &item, K_SECONDS(1)), "No response from SVC");
+	zassert_equal(gb_message_type(item.msg), GB_RESPONSE(GB_SVC_TYPE_PING),
+		      "Invalid response type");
+	zassert_true(gb_message_is_success(item.msg), "Ping failed");
+	zassert_not_equal(ap_write_thread, k_current_get(),
+			  "Request should not be handled in the sender's context");
+
+	gb_message_dealloc(item.msg);
+}
+
+static int svc_ping(void)
+{
+	return gb_apbridge_send(AP_INF_ID, 0,
+				gb_message_request_alloc(0, GB_SVC_TYPE_PING, false));
+}
+
+ZTEST(greybus_svc_tests, test_queue_full)
+{
+	struct gb_msg_with_cport item;
+	uint32_t dropped;
+	int i;
+
+	zassert_ok(gb_svc_init(), "SVC init failed");
+
+	/* The work queue blocks on the first response, the queue fills up behind it */
+	ap_stall = true;
+	zassert_ok(svc_ping(), "Failed to send request to SVC");
+	k_msleep(10);
+	for (i = 0; i < SVC_QUEUE_DEPTH; i++) {
+		zassert_ok(svc_ping(), "Failed to send request to SVC");
+	}
+
+	dropped = gb_svc_dropped();
+	zassert_equal(svc_ping(), -ENOBUFS, "Full queue should drop after the timeout");
+	zassert_equal(gb_svc_dropped(), dropped + 1, "Drop not counted");
+
+	/* Room within the timeout, the sender waits for it */
+	k_work_schedule(&ap_unstall_work, K_MSEC(CONFIG_GREYBUS_SVC_QUEUE_TIMEOUT_MS / 4));
+	zassert_ok(svc_ping(), "Sender should wait for room in the queue");
+
+	for (i = 0; i < SVC_QUEUE_DEPTH + 2; i++) {
+		zassert_ok(k_msgq_get(&ap_msgq, &item, K_SECONDS(1)), "No response from SVC");
+		zassert_equal(gb_message_type(item.msg), GB_RESPONSE(GB_SVC_TYPE_PING),
+			      "Invalid response type");
+		gb_message_dealloc(item.msg);
+	}
+	zassert_equal(gb_svc_dropped(), dropped + 1, "Nothing else should be dropped");
+}
+
+static struct gb_message *svc_request(uint8_t type, const void *payload, size_t len)
+{
+	struct gb_message *req = gb_message_request_alloc(len, type, false);
+	struct gb_msg_with_cport item;
+
+	if (len) {
+		memcpy(req->payload, payload, len);
+	}
+
+	zassert_ok(gb_apbridge_send(AP_INF_ID, 0, req), "Failed to send request to SVC");
+	zassert_ok(k_msgq_get(&ap_msgq, &item, K_SECONDS(1)), "No response from SVC");
+	zassert_equal(gb_message_type(item.msg), GB_RESPONSE(type), "Invalid response type");
+
+	return item.msg;
+}
+
+ZTEST(greybus_svc_tests, test_timesync)
+{
+	const struct gb_svc_timesync_enable_request enable = {
+		.count = 2,
+		.frame_time = sys_cpu_to_le64(1000000),
+		.strobe_delay = sys_cpu_to_le32(20000),
+		.refclk = sys_cpu_to_le32(1000000),
+	};
+	const struct gb_svc_timesync_authoritative_response *auth;
+	const struct gb_svc_timesync_ping_response *ping;
+	struct gb_message *resp;
+	uint64_t first, second;
+
+	zassert_ok(gb_svc_init(), "SVC init failed");
+
+	resp = svc_request(GB_SVC_TYPE_TIMESYNC_ENABLE, &enable, sizeof(enable));
+	zassert_true(gb_message_is_success(resp), "TimeSync enable failed");
+	gb_message_dealloc(resp);
+
+	/* Both strobes are sent 20 ms apart */
+	k_msleep(100);
+
+	resp = svc_request(GB_SVC_TYPE_TIMESYNC_AUTHORITATIVE, NULL, 0);
+	zassert_true(gb_message_is_success(resp), "TimeSync authoritative failed");
+	auth = (const struct gb_svc_timesync_authoritative_response *)resp->payload;
+	first = sys_le64_to_cpu(auth->frame_time[0]);
+	second = sys_le64_to_cpu(auth->frame_time[1]);
+	zassert_equal(first, 1000000, "First strobe should set the frame time");
+	zassert_within(second - first, 20000, 10000, "Strobes not 20 ms apart");
+	zassert_equal(auth->frame_time[2], 0, "Only two strobes requested");
+	gb_message_dealloc(resp);
+
+	resp = svc_request(GB_SVC_TYPE_TIMESYNC_PING, NULL, 0);
+	zassert_true(gb_message_is_success(resp), "TimeSync ping failed");
+	ping = (const struct gb_svc_timesync_ping_response *)resp->payload;
+	zassert_true(sys_le64_to_cpu(ping->frame_time) > second, "Ping should strobe again");
+	gb_message_dealloc(resp);
+
+	resp = svc_request(GB_SVC_TYPE_TIMESYNC_DISABLE, NULL, 0);
+	zassert_true(gb_message_is_success(resp), "TimeSync disable failed");
+	gb_message_dealloc(resp);
+}
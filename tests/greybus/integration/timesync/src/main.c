@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2026 BeagleBoard.org
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "greybus/greybus_messages.h"
+#include "greybus/greybus_protocols.h"
+#include <zephyr/ztest.h>
+#include <zephyr/sys/byteorder.h>
+#include <greybus/greybus.h>
+#include <greybus/timesync.h>
+
+#define CONTROL_CPORT 0
+#define FRAME_TIME    1000000
+#define REFCLK        1000000
+
+struct gb_msg_with_cport gb_transport_get_message(void);
+
+static struct gb_message *control_request(uint8_t type, const void *payload, size_t len)
+{
+	struct gb_message *req = gb_message_request_alloc(len, type, false);
+	struct gb_msg_with_cport resp;
+
+	zassert_not_null(req, "Failed to allocate request");
+	if (len) {
+		memcpy(req->payload, payload, len);
+	}
+	zassert_ok(greybus_rx_handler(CONTROL_CPORT, req), "Failed to handle request");
+
+	resp = gb_transport_get_message();
+	zassert_not_null(resp.msg, "No response received");
+	zassert_equal(resp.cport, CONTROL_CPORT, "Response received on wrong cport");
+	zassert_equal(gb_message_type(resp.msg), GB_RESPONSE(type), "Wrong response type");
+
+	return resp.msg;
+}
+
+static uint8_t timesync_enable(uint8_t count, uint32_t refclk)
+{
+	const struct gb_control_timesync_enable_request req = {
+		.count = count,
+		.frame_time = sys_cpu_to_le64(FRAME_TIME),
+		.strobe_delay = sys_cpu_to_le32(1000),
+		.refclk = sys_cpu_to_le32(refclk),
+	};
+	struct gb_message *resp =
+		control_request(GB_CONTROL_TYPE_TIMESYNC_ENABLE, &req, sizeof(req));
+	const uint8_t result = resp->header.result;
+
+	gb_message_dealloc(resp);
+
+	return result;
+}
+
+static uint64_t last_event(void)
+{
+	struct gb_message *resp = control_request(GB_CONTROL_TYPE_TIMESYNC_GET_LAST_EVENT, NULL, 0);
+	const struct gb_control_timesync_get_last_event_response *resp_data =
+		(const struct gb_control_timesync_get_last_event_response *)resp->payload;
+	uint64_t frame_time;
+
+	zassert_true(gb_message_is_success(resp), "Get last event failed");
+	zassert_equal(gb_message_payload_len(resp), sizeof(*resp_data), "Invalid response size");
+	frame_time = sys_le64_to_cpu(resp_data->frame_time);
+	gb_message_dealloc(resp);
+
+	return frame_time;
+}
+
+static void timesync_after(void *fixture)
+{
+	struct gb_message *resp;
+
+	ARG_UNUSED(fixture);
+
+	resp = control_request(GB_CONTROL_TYPE_TIMESYNC_DISABLE, NULL, 0);
+	gb_message_dealloc(resp);
+}
+
+ZTEST_SUITE(greybus_timesync_tests, NULL, NULL, NULL, timesync_after, NULL);
+
+ZTEST(greybus_timesync_tests, test_enable_invalid)
+{
+	zassert_not_equal(timesync_enable(0, REFCLK), GB_OP_SUCCESS, "No strobes accepted");
+	zassert_not_equal(timesync_enable(GB_TIMESYNC_MAX_STROBES + 1, REFCLK), GB_OP_SUCCESS,
+			  "Too many strobes accepted");
+	zassert_not_equal(timesync_enable(1, 0), GB_OP_SUCCESS, "Zero refclk accepted");
+}
+
+ZTEST(greybus_timesync_tests, test_frame_time)
+{
+	uint64_t before, after;
+
+	zassert_equal(timesync_enable(1, REFCLK), GB_OP_SUCCESS, "Enable failed");
+
+	/* The first strobe sets the frame time given by the AP */
+	gb_timesync_strobe();
+	zassert_equal(last_event(), FRAME_TIME, "First strobe should set the frame time");
+
+	before = gb_timesync_get_frame_time();
+	k_msleep(100);
+	after = gb_timesync_get_frame_time();
+
+	zassert_true(before >= FRAME_TIME, "Frame time went backwards");
+	zassert_within(after - before, REFCLK / 10, REFCLK / 50, "Frame time rate off: %llu",
+		       after - before);
+}
+
+ZTEST(greybus_timesync_tests, test_authoritative)
+{
+	struct gb_control_timesync_authoritative_request req = {0};
+	struct gb_message *resp;
+	uint64_t second;
+
+	zassert_equal(timesync_enable(2, REFCLK), GB_OP_SUCCESS, "Enable failed");
+
+	/* Nothing to correct before the first strobe */
+	resp = control_request(GB_CONTROL_TYPE_TIMESYNC_AUTHORITATIVE, &req, sizeof(req));
+	zassert_false(gb_message_is_success(resp), "Authoritative without strobes accepted");
+	gb_message_dealloc(resp);
+
+	gb_timesync_strobe();
+	k_msleep(1);
+	gb_timesync_strobe();
+	second = last_event();
+
+	/* AP is 500 ticks ahead */
+	req.frame_time[0] = sys_cpu_to_le64(FRAME_TIME + 500);
+	req.frame_time[1] = sys_cpu_to_le64(second + 500);
+	resp = control_request(GB_CONTROL_TYPE_TIMESYNC_AUTHORITATIVE, &req, sizeof(req));
+	zassert_true(gb_message_is_success(resp), "Authoritative failed");
+	gb_message_dealloc(resp);
+
+	zassert_equal(last_event(), second + 500, "Frame time not corrected");
+	zassert_true(gb_timesync_get_frame_time() >= second + 500, "Frame time not corrected");
+}
+
+ZTEST(greybus_timesync_tests, test_disable)
+{
+	struct gb_message *resp;
+	uint64_t event;
+
+	zassert_equal(timesync_enable(1, REFCLK), GB_OP_SUCCESS, "Enable failed");
+
+	resp = control_request(GB_CONTROL_TYPE_TIMESYNC_GET_LAST_EVENT, NULL, 0);
+	zassert_false(gb_message_is_success(resp), "No event before the first strobe");
+	gb_message_dealloc(resp);
+
+	gb_timesync_strobe();
+	event = last_event();
+
+	resp = control_request(GB_CONTROL_TYPE_TIMESYNC_DISABLE, NULL, 0);
+	zassert_true(gb_message_is_success(resp), "Disable failed");
+	gb_message_dealloc(resp);
+
+	k_msleep(1);
+	gb_timesync_strobe();
+	zassert_equal(last_event(), event, "Strobe latched while disabled");
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2026 BeagleBoard.org
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/bluetooth/l2cap.h>
+#include <greybus/greybus.h>
+#include <greybus-utils/manifest.h>
+#include "greybus_transport.h"
+
+static int accept_none(struct bt_conn *conn, struct bt_l2cap_server *server,
+		       struct bt_l2cap_chan **chan)
+{
+	return -ENOMEM;
+}
+
+ZTEST_SUITE(greybus_transport_ble_tests, NULL, NULL, NULL, NULL, NULL);
+
+ZTEST(greybus_transport_ble_tests, test_enabled)
+{
+	zassert_true(bt_is_ready(), "Transport should enable Bluetooth");
+}
+
+ZTEST(greybus_transport_ble_tests, test_psm_registered)
+{
+	static struct bt_l2cap_server server = {
+		.psm = CONFIG_GREYBUS_XPORT_BLE_PSM,
+		.accept = accept_none,
+	};
+
+	zassert_equal(bt_l2cap_server_register(&server), -EADDRINUSE,
+		      "Greybus PSM should be registered by the transport");
+}
+
+ZTEST(greybus_transport_ble_tests, test_send_not_connected)
+{
+	struct gb_message *req = gb_message_request_alloc(0, GB_LOOPBACK_TYPE_PING, false);
+	int ret;
+
+	ret = gb_transport_get_backend()->send(1, req);
+	gb_message_dealloc(req);
+
+	zassert_equal(ret, -ENOTCONN, "Send without a channel should fail");
+}
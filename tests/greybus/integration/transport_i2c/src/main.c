@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2026 BeagleBoard.org
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/gpio/gpio_emul.h>
+#include <zephyr/sys/byteorder.h>
+#include <greybus/greybus.h>
+#include <greybus-utils/manifest.h>
+
+#define LOOPBACK_CPORT 1
+#define NODE_ADDR      CONFIG_GREYBUS_XPORT_I2C_ADDRESS
+#define MAX_POLLS      10
+
+/* Target registers, see transport/i2c.c */
+#define GB_I2C_REG_DATA 0x00
+#define GB_I2C_REG_LEN  0x01
+
+/* Wire format of a frame, cport followed by the Greybus message */
+struct gb_i2c_frame {
+	__le16 cport;
+	struct gb_operation_msg_hdr hdr;
+} __packed;
+
+/* The test is the controller, i2c0 forwards transfers to the node on i2c1 */
+static const struct device *host = DEVICE_DT_GET(DT_NODELABEL(i2c0));
+
+static const struct gpio_dt_spec data_ready =
+	GPIO_DT_SPEC_GET(DT_PATH(zephyr_user), greybus_int_gpios);
+
+static int data_ready_get(void)
+{
+	return gpio_emul_output_get(data_ready.port, data_ready.pin);
+}
+
+/*
+ * Poll the data ready line until it reaches the expected level.
+ */
+static bool data_ready_wait(int level)
+{
+	size_t i;
+
+	for (i = 0; i < MAX_POLLS; i++) {
+		if (data_ready_get() == level) {
+			return true;
+		}
+		k_msleep(10);
+	}
+
+	return false;
+}
+
+static void host_send_ping(void)
+{
+	struct gb_message *req = gb_message_request_alloc(0, GB_LOOPBACK_TYPE_PING, false);
+	uint8_t buf[sizeof(__le16) + sizeof(struct gb_operation_msg_hdr)];
+
+	zassert_not_null(req, "Failed to allocate request");
+	zassert_equal(gb_message_len(req), sizeof(buf) - sizeof(__le16), "Invalid request size");
+
+	sys_put_le16(LOOPBACK_CPORT, buf);
+	memcpy(&buf[sizeof(__le16)], req, gb_message_len(req));
+	gb_message_dealloc(req);
+
+	zassert_ok(i2c_write(host, buf, sizeof(buf), NODE_ADDR), "Failed to write frame");
+}
+
+static uint16_t host_read_len(void)
+{
+	uint8_t reg = GB_I2C_REG_LEN;
+	uint8_t len[sizeof(__le16)];
+
+	zassert_ok(i2c_write(host, &reg, sizeof(reg), NODE_ADDR), "Failed to select register");
+	zassert_ok(i2c_read(host, len, sizeof(len), NODE_ADDR), "Failed to read length");
+
+	return sys_get_le16(len);
+}
+
+ZTEST_SUITE(greybus_transport_i2c_tests, NULL, NULL, NULL, NULL, NULL);
+
+ZTEST(greybus_transport_i2c_tests, test_idle)
+{
+	zassert_equal(data_ready_get(), 0, "Data ready should not be asserted");
+	zassert_equal(host_read_len(), 0, "Idle node should report an empty frame");
+}
+
+ZTEST(greybus_transport_i2c_tests, test_ping)
+{
+	struct gb_i2c_frame frame;
+	uint16_t len;
+
+	host_send_ping();
+	zassert_true(data_ready_wait(1), "Data ready not asserted");
+
+	len = host_read_len();
+	zassert_equal(len, sizeof(frame), "Invalid frame length");
+	zassert_equal(data_ready_get(), 1, "Data ready deasserted before the frame was read");
+
+	/* The whole frame in one transfer */
+	zassert_ok(i2c_read(host, (uint8_t *)&frame, len, NODE_ADDR), "Failed to read frame");
+	zassert_equal(sys_le16_to_cpu(frame.cport), LOOPBACK_CPORT, "Invalid cport");
+	zassert_equal(sys_le16_to_cpu(frame.hdr.size), sizeof(frame.hdr), "Invalid message size");
+	zassert_equal(frame.hdr.type, GB_RESPONSE(GB_LOOPBACK_TYPE_PING), "Invalid response type");
+	zassert_equal(frame.hdr.result, GB_OP_SUCCESS, "Greybus loopback ping failed");
+
+	zassert_true(data_ready_wait(0), "Data ready not deasserted");
+	zassert_equal(host_read_len(), 0, "Node should have nothing left to send");
+}
+
+ZTEST(greybus_transport_i2c_tests, test_queued)
+{
+	struct gb_i2c_frame frame;
+	size_t i;
+
+	host_send_ping();
+	host_send_ping();
+	zassert_true(data_ready_wait(1), "Data ready not asserted");
+	/* Let the second response get queued behind the first */
+	k_msleep(50);
+
+	for (i = 0; i < 2; i++) {
+		zassert_equal(data_ready_get(), 1, "Data ready should stay asserted");
+		zassert_equal(host_read_len(), sizeof(frame), "Invalid frame length");
+		zassert_ok(i2c_read(host, (uint8_t *)&frame, sizeof(frame), NODE_ADDR),
+			   "Failed to read frame");
+		zassert_equal(frame.hdr.type, GB_RESPONSE(GB_LOOPBACK_TYPE_PING),
+			      "Invalid response type");
+	}
+
+	zassert_true(data_ready_wait(0), "Data ready not deasserted");
+}
@@ -0,0 +1,260 @@
+/*
+ * Copyright (c) 2026 BeagleBoard.org
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/device.h>
+#include <zephyr/ipc/ipc_service.h>
+#include <zephyr/ipc/ipc_service_backend.h>
+#include <zephyr/sys/byteorder.h>
+#include <greybus/greybus.h>
+#include <greybus-utils/manifest.h>
+#include "greybus_transport.h"
+
+#define DT_DRV_COMPAT zephyr_greybus_ipc_emul
+
+#define LOOPBACK_CPORT 1
+#define SHM_BUF_SIZE   256
+
+/* Wire format of the IPC transport frame */
+struct gb_ipc_frame {
+	__le16 cport;
+	struct gb_operation_msg_hdr hdr;
+	uint8_t payload[];
+} __packed;
+
+/*
+ * Local stand-in for an IPC service backend. A single shared memory TX buffer is handed out
+ * when the no-copy API is enabled. Whatever the node sends is captured for the test.
+ */
+static const struct ipc_ept_cfg *node_ept;
+static bool nocopy = true;
+static bool shm_tx_taken;
+static uint8_t shm_tx[SHM_BUF_SIZE];
+static size_t nocopy_sends;
+static size_t copy_sends;
+
+static uint8_t host_rx[SHM_BUF_SIZE];
+static size_t host_rx_len;
+static K_SEM_DEFINE(host_rx_sem, 0, 1);
+
+static void host_capture(const void *data, size_t len)
+{
+	zassert_true(len <= sizeof(host_rx), "Frame too large");
+	memcpy(host_rx, data, len);
+	host_rx_len = len;
+	k_sem_give(&host_rx_sem);
+}
+
+static int emul_open_instance(const struct device *instance)
+{
+	ARG_UNUSED(instance);
+
+	return 0;
+}
+
+static int emul_register_endpoint(const struct device *instance, const struct ipc_ept_cfg *cfg,
+				  void **token)
+{
+	ARG_UNUSED(instance);
+
+	node_ept = cfg;
+	*token = (void *)cfg;
+	cfg->cb.bound(cfg->priv);
+
+	return 0;
+}
+
+static int emul_deregister_endpoint(const struct device *instance, void *token)
+{
+	ARG_UNUSED(instance);
+	ARG_UNUSED(token);
+
+	node_ept = NULL;
+
+	return 0;
+}
+
+static int emul_send(const struct device *instance, void *token, const void *data, size_t len)
+{
+	ARG_UNUSED(instance);
+	ARG_UNUSED(token);
+
+	copy_sends++;
+	host_capture(data, len);
+
+	return len;
+}
+
+static int emul_get_tx_buffer_size(const struct device *instance, void *token)
+{
+	ARG_UNUSED(instance);
+	ARG_UNUSED(token);
+
+	return nocopy ? sizeof(shm_tx) : -ENOTSUP;
+}
+
+static int emul_get_tx_buffer(const struct device *instance, void *token, void **data,
+			      uint32_t *len, k_timeout_t wait)
+{
+	ARG_UNUSED(instance);
+	ARG_UNUSED(token);
+	ARG_UNUSED(wait);
+
+	if (!nocopy) {
+		return -ENOTSUP;
+	}
+
+	if (shm_tx_taken) {
+		return -ENOBUFS;
+	}
+
+	if (*len > sizeof(shm_tx)) {
+		return -ENOMEM;
+	}
+
+	shm_tx_taken = true;
+	*data = shm_tx;
+	*len = sizeof(shm_tx);
+
+	return 0;
+}
+
+static int emul_drop_tx_buffer(const struct device *instance, void *token, const void *data)
+{
+	ARG_UNUSED(instance);
+	ARG_UNUSED(token);
+
+	zassert_equal_ptr(data, shm_tx, "Dropping unknown buffer");
+	shm_tx_taken = false;
+
+	return 0;
+}
+
+static int emul_send_nocopy(const struct device *instance, void *token, const void *data,
+			    size_t len)
+{
+	ARG_UNUSED(instance);
+	ARG_UNUSED(token);
+
+	zassert_equal_ptr(data, shm_tx, "Frame not in shared memory");
+	nocopy_sends++;
+	host_capture(data, len);
+	shm_tx_taken = false;
+
+	return len;
+}
+
+static const struct ipc_service_backend emul_backend = {
+	.open_instance = emul_open_instance,
+	.register_endpoint = emul_register_endpoint,
+	.deregister_endpoint = emul_deregister_endpoint,
+	.send = emul_send,
+	.get_tx_buffer_size = emul_get_tx_buffer_size,
+	.get_tx_buffer = emul_get_tx_buffer,
+	.drop_tx_buffer = emul_drop_tx_buffer,
+	.send_nocopy = emul_send_nocopy,
+};
+
+DEVICE_DT_INST_DEFINE(0, NULL, NULL, NULL, NULL, POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEVICE,
+		      &emul_backend);
+
+static void host_send_ping(void)
+{
+	struct gb_message *req = gb_message_request_alloc(0, GB_LOOPBACK_TYPE_PING, false);
+	uint8_t buf[sizeof(__le16) + sizeof(struct gb_operation_msg_hdr)];
+	struct gb_ipc_frame *frame = (struct gb_ipc_frame *)buf;
+
+	zassert_not_null(node_ept, "Node endpoint not registered");
+
+	frame->cport = sys_cpu_to_le16(LOOPBACK_CPORT);
+	memcpy(&frame->hdr, req, gb_message_len(req));
+	gb_message_dealloc(req);
+
+	node_ept->cb.received(buf, sizeof(buf), node_ept->priv);
+}
+
+static void check_ping_response(void)
+{
+	const struct gb_ipc_frame *frame = (const struct gb_ipc_frame *)host_rx;
+
+	zassert_ok(k_sem_take(&host_rx_sem, K_SECONDS(1)), "No response from node");
+	zassert_equal(host_rx_len, sizeof(__le16) + sizeof(struct gb_operation_msg_hdr),
+		      "Invalid frame length");
+	zassert_equal(sys_le16_to_cpu(frame->cport), LOOPBACK_CPORT, "Invalid cport");
+	zassert_equal(frame->hdr.type, GB_RESPONSE(GB_LOOPBACK_TYPE_PING),
+		      "Invalid response type");
+	zassert_equal(frame->hdr.result, GB_OP_SUCCESS, "Greybus loopback ping failed");
+}
+
+static void rebind(bool use_nocopy)
+{
+	nocopy = use_nocopy;
+	node_ept->cb.bound(node_ept->priv);
+}
+
+static void transport_ipc_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	rebind(true);
+	nocopy_sends = 0;
+	copy_sends = 0;
+	k_sem_reset(&host_rx_sem);
+}
+
+ZTEST_SUITE(greybus_transport_ipc_tests, NULL, NULL, transport_ipc_before, NULL, NULL);
+
+ZTEST(greybus_transport_ipc_tests, test_ping_nocopy)
+{
+	host_send_ping();
+	check_ping_response();
+
+	zassert_equal(nocopy_sends, 1, "Response should be sent from shared memory");
+	zassert_equal(copy_sends, 0, "Response should not be copied");
+	zassert_false(shm_tx_taken, "Shared memory buffer not released");
+}
+
+ZTEST(greybus_transport_ipc_tests, test_ping_copy)
+{
+	rebind(false);
+
+	host_send_ping();
+	check_ping_response();
+
+	zassert_equal(nocopy_sends, 0, "Backend has no no-copy support");
+	zassert_equal(copy_sends, 1, "Response should be copied");
+}
+
+ZTEST(greybus_transport_ipc_tests, test_invalid_frame)
+{
+	uint8_t buf[sizeof(__le16) + sizeof(struct gb_operation_msg_hdr)] = {0};
+	struct gb_ipc_frame *frame = (struct gb_ipc_frame *)buf;
+
+	/* Header claims a payload that is not there */
+	frame->cport = sys_cpu_to_le16(LOOPBACK_CPORT);
+	frame->hdr.size = sys_cpu_to_le16(sizeof(frame->hdr) + 4);
+	frame->hdr.type = GB_LOOPBACK_TYPE_PING;
+	node_ept->cb.received(buf, sizeof(buf), node_ept->priv);
+
+	zassert_equal(k_sem_take(&host_rx_sem, K_MSEC(100)), -EAGAIN,
+		      "Invalid frame should be dropped");
+}
+
+ZTEST(greybus_transport_ipc_tests, test_caps)
+{
+	struct gb_transport_caps caps;
+
+	gb_transport_get_caps(&caps);
+	zassert_equal(caps.max_message_size, SHM_BUF_SIZE - sizeof(__le16),
+		      "Shared memory buffer should limit the message size");
+	zassert_true(caps.flags & GB_TRANSPORT_CAP_ZERO_COPY, "No-copy TX not advertised");
+
+	rebind(false);
+
+	gb_transport_get_caps(&caps);
+	zassert_equal(caps.max_message_size, UINT16_MAX, "Copying TX has no known limit");
+	zassert_false(caps.flags & GB_TRANSPORT_CAP_ZERO_COPY, "Copying TX is not zero-copy");
+}
@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) 2026 BeagleBoard.org
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _TRANSPORT_MULTI_HOST_H_
+#define _TRANSPORT_MULTI_HOST_H_
+
+#include <greybus/greybus.h>
+
+/* Send a message to the node over the IPC stand-in */
+void ipc_host_send(uint16_t cport, const struct gb_message *msg);
+
+/*
+ * Wait for a message from the node over the IPC stand-in.
+ *
+ * @return message header, or NULL on timeout
+ */
+const struct gb_operation_msg_hdr *ipc_host_recv(uint16_t *cport, k_timeout_t timeout);
+
+/* Bind or unbind the node endpoint */
+void ipc_host_bind(bool bound);
+
+/* Send a message to the node over the SPI stand-in, msg can be NULL */
+void spi_host_send(uint16_t cport, const struct gb_message *msg);
+
+/*
+ * Clock frames until the node sends a message over the SPI stand-in.
+ *
+ * @return message header, or NULL if none arrived
+ */
+const struct gb_operation_msg_hdr *spi_host_recv(uint16_t *cport);
+
+#endif /* _TRANSPORT_MULTI_HOST_H_ */
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2026 BeagleBoard.org
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/ipc/ipc_service_backend.h>
+#include <zephyr/sys/byteorder.h>
+#include "host.h"
+
+#define DT_DRV_COMPAT zephyr_greybus_ipc_emul
+
+#define FRAME_MAX_SIZE 256
+
+static const struct ipc_ept_cfg *node_ept;
+static uint8_t host_rx[FRAME_MAX_SIZE];
+static K_SEM_DEFINE(host_rx_sem, 0, 1);
+
+static int emul_open_instance(const struct device *instance)
+{
+	return 0;
+}
+
+static int emul_register_endpoint(const struct device *instance, const struct ipc_ept_cfg *cfg,
+				  void **token)
+{
+	node_ept = cfg;
+	*token = (void *)cfg;
+	cfg->cb.bound(cfg->priv);
+
+	return 0;
+}
+
+static int emul_send(const struct device *instance, void *token, const void *data, size_t len)
+{
+	if (len > sizeof(host_rx)) {
+		return -EMSGSIZE;
+	}
+
+	memcpy(host_rx, data, len);
+	k_sem_give(&host_rx_sem);
+
+	return len;
+}
+
+static const struct ipc_service_backend emul_backend = {
+	.open_instance = emul_open_instance,
+	.register_endpoint = emul_register_endpoint,
+	.send = emul_send,
+};
+
+DEVICE_DT_INST_DEFINE(0, NULL, NULL, NULL, NULL, POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEVICE,
+		      &emul_backend);
+
+void ipc_host_send(uint16_t cport, const struct gb_message *msg)
+{
+	uint8_t buf[FRAME_MAX_SIZE];
+
+	sys_put_le16(cport, buf);
+	memcpy(&buf[sizeof(__le16)], msg, gb_message_len(msg));
+
+	node_ept->cb.received(buf, sizeof(__le16) + gb_message_len(msg), node_ept->priv);
+}
+
+const struct gb_operation_msg_hdr *ipc_host_recv(uint16_t *cport, k_timeout_t timeout)
+{
+	if (k_sem_take(&host_rx_sem, timeout) < 0) {
+		return NULL;
+	}
+
+	*cport = sys_get_le16(host_rx);
+
+	return (const struct gb_operation_msg_hdr *)&host_rx[sizeof(__le16)];
+}
+
+void ipc_host_bind(bool bound)
+{
+	if (bound) {
+		node_ept->cb.bound(node_ept->priv);
+	} else {
+		node_ept->cb.unbound(node_ept->priv);
+	}
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2026 BeagleBoard.org
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/ztest.h>
+#include <greybus/greybus.h>
+#include <greybus-utils/manifest.h>
+#include "greybus_transport.h"
+#include "host.h"
+
+#define LOOPBACK_CPORT 1
+#define BACKEND_IPC    0
+#define BACKEND_SPI    1
+
+static void check_ping_response(const struct gb_operation_msg_hdr *hdr, uint16_t cport)
+{
+	zassert_not_null(hdr, "No response from node");
+	zassert_equal(cport, LOOPBACK_CPORT, "Invalid cport");
+	zassert_equal(hdr->type, GB_RESPONSE(GB_LOOPBACK_TYPE_PING), "Invalid response type");
+	zassert_equal(hdr->result, GB_OP_SUCCESS, "Greybus loopback ping failed");
+}
+
+static void ping_over_ipc(void)
+{
+	struct gb_message *req = gb_message_request_alloc(0, GB_LOOPBACK_TYPE_PING, false);
+	const struct gb_operation_msg_hdr *hdr;
+	uint16_t cport;
+
+	ipc_host_send(LOOPBACK_CPORT, req);
+	gb_message_dealloc(req);
+
+	hdr = ipc_host_recv(&cport, K_SECONDS(1));
+	check_ping_response(hdr, cport);
+}
+
+static void transport_multi_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	ipc_host_bind(true);
+	/* Marks the IPC backend up again and routes the loopback cport over it */
+	ping_over_ipc();
+}
+
+ZTEST_SUITE(greybus_transport_multi_tests, NULL, NULL, transport_multi_before, NULL, NULL);
+
+ZTEST(greybus_transport_multi_tests, test_backends)
+{
+	zassert_equal(gb_transport_backend_count(), 2, "Invalid number of backends");
+	zassert_str_equal(gb_transport_backend_name(BACKEND_IPC), "ipc", "IPC should be active");
+	zassert_str_equal(gb_transport_backend_name(BACKEND_SPI), "spi", "SPI should be standby");
+	zassert_is_null(gb_transport_backend_name(2), "Out of range backend");
+}
+
+ZTEST(greybus_transport_multi_tests, test_caps)
+{
+	const size_t max_chunk =
+		CONFIG_GREYBUS_XPORT_SPI_MAX_MESSAGE_SIZE - sizeof(struct gb_operation_msg_hdr);
+	struct gb_transport_caps caps;
+
+	/* Only SPI has a limit, messages have to fit it in case of failover */
+	gb_transport_get_caps(&caps);
+	zassert_equal(caps.max_message_size, CONFIG_GREYBUS_XPORT_SPI_MAX_MESSAGE_SIZE,
+		      "Smallest backend should limit the message size");
+	zassert_equal(gb_transport_chunk_size(0, UINT16_MAX), max_chunk, "Invalid chunk size");
+	zassert_equal(gb_transport_chunk_size(0, 16), 16, "Chunk size should be limited");
+}
+
+ZTEST(greybus_transport_multi_tests, test_route_back)
+{
+	struct gb_message *req = gb_message_request_alloc(0, GB_LOOPBACK_TYPE_PING, false);
+	const struct gb_operation_msg_hdr *hdr;
+	struct gb_transport_stats before, after;
+	uint16_t cport;
+
+	zassert_ok(gb_transport_backend_stats(BACKEND_SPI, &before));
+
+	/* Request over the standby backend is answered over the standby backend */
+	spi_host_send(LOOPBACK_CPORT, req);
+	gb_message_dealloc(req);
+
+	hdr = spi_host_recv(&cport);
+	check_ping_response(hdr, cport);
+	zassert_is_null(ipc_host_recv(&cport, K_MSEC(50)), "Response sent over wrong backend");
+
+	zassert_ok(gb_transport_backend_stats(BACKEND_SPI, &after));
+	zassert_equal(after.rx_messages, before.rx_messages + 1, "SPI RX not counted");
+	zassert_equal(after.tx_messages, before.tx_messages + 1, "SPI TX not counted");
+	zassert_equal(after.rx_bytes, before.rx_bytes + sizeof(struct gb_operation_msg_hdr),
+		      "SPI RX bytes not counted");
+
+	/* And the active backend is used again once the request comes from there */
+	ping_over_ipc();
+}
+
+ZTEST(greybus_transport_multi_tests, test_failover)
+{
+	struct gb_message *msg = gb_message_request_alloc(0, GB_LOOPBACK_TYPE_PING, false);
+	const struct gb_operation_msg_hdr *hdr;
+	struct gb_transport_stats ipc, spi;
+	uint16_t cport;
+
+	ipc_host_bind(false);
+
+	zassert_ok(gb_transport_get_backend()->send(LOOPBACK_CPORT, msg),
+		   "Send should fail over to standby");
+	gb_message_dealloc(msg);
+
+	hdr = spi_host_recv(&cport);
+	zassert_not_null(hdr, "Message not sent over standby backend");
+	zassert_equal(cport, LOOPBACK_CPORT, "Invalid cport");
+	zassert_equal(hdr->type, GB_LOOPBACK_TYPE_PING, "Invalid message type");
+
+	zassert_ok(gb_transport_backend_stats(BACKEND_IPC, &ipc));
+	zassert_ok(gb_transport_backend_stats(BACKEND_SPI, &spi));
+	zassert_false(ipc.up, "IPC should be marked down");
+	zassert_true(spi.up, "SPI should be up");
+	zassert_true(spi.failovers > 0, "Failover not counted");
+}
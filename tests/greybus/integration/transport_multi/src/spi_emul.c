@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2026 BeagleBoard.org
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/emul.h>
+#include <zephyr/drivers/spi_emul.h>
+#include <zephyr/sys/byteorder.h>
+#include "host.h"
+
+#define DT_DRV_COMPAT zephyr_greybus_spi_host_emul
+
+#define HOST_CREDITS  4
+#define MAX_TRANSFERS 10
+
+/* cport, len, credits, pad */
+#define FRAME_HDR_SIZE 6
+#define FRAME_SIZE     (FRAME_HDR_SIZE + CONFIG_GREYBUS_XPORT_SPI_MAX_MESSAGE_SIZE)
+
+static uint8_t host_tx[FRAME_SIZE];
+static uint8_t host_rx[FRAME_SIZE];
+
+static K_SEM_DEFINE(xfer_start, 0, 1);
+static K_SEM_DEFINE(xfer_done, 0, 1);
+
+static int host_emul_io(const struct emul *target, const struct spi_config *config,
+			const struct spi_buf_set *tx_bufs, const struct spi_buf_set *rx_bufs)
+{
+	k_sem_take(&xfer_start, K_FOREVER);
+
+	memcpy(host_rx, tx_bufs->buffers[0].buf, FRAME_SIZE);
+	memcpy(rx_bufs->buffers[0].buf, host_tx, FRAME_SIZE);
+
+	k_sem_give(&xfer_done);
+
+	return FRAME_SIZE;
+}
+
+static const struct spi_emul_api host_emul_api = {
+	.io = host_emul_io,
+};
+
+static int host_emul_init(const struct emul *target, const struct device *parent)
+{
+	return 0;
+}
+
+DEVICE_DT_INST_DEFINE(0, NULL, NULL, NULL, NULL, POST_KERNEL, CONFIG_APPLICATION_INIT_PRIORITY,
+		      NULL);
+EMUL_DT_INST_DEFINE(0, host_emul_init, NULL, NULL, &host_emul_api, NULL);
+
+void spi_host_send(uint16_t cport, const struct gb_message *msg)
+{
+	memset(host_tx, 0, sizeof(host_tx));
+	host_tx[4] = HOST_CREDITS;
+
+	if (msg) {
+		sys_put_le16(cport, &host_tx[0]);
+		sys_put_le16(gb_message_len(msg), &host_tx[2]);
+		memcpy(&host_tx[FRAME_HDR_SIZE], msg, gb_message_len(msg));
+	}
+
+	k_sem_give(&xfer_start);
+	k_sem_take(&xfer_done, K_FOREVER);
+}
+
+const struct gb_operation_msg_hdr *spi_host_recv(uint16_t *cport)
+{
+	size_t i;
+
+	for (i = 0; i < MAX_TRANSFERS; i++) {
+		k_msleep(10);
+		spi_host_send(0, NULL);
+		if (sys_get_le16(&host_rx[2]) > 0) {
+			*cport = sys_get_le16(&host_rx[0]);
+			return (const struct gb_operation_msg_hdr *)&host_rx[FRAME_HDR_SIZE];
+		}
+	}
+
+	return NULL;
+}
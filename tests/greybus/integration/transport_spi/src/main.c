@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2026 BeagleBoard.org
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/emul.h>
+#include <zephyr/drivers/spi.h>
+#include <zephyr/drivers/spi_emul.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/gpio/gpio_emul.h>
+#include <zephyr/sys/byteorder.h>
+#include <greybus/greybus.h>
+#include <greybus-utils/manifest.h>
+
+#define DT_DRV_COMPAT zephyr_greybus_spi_host_emul
+
+#define LOOPBACK_CPORT 1
+#define HOST_CREDITS   4
+#define MAX_TRANSFERS  10
+
+/* Wire format of the SPI transport frame header */
+struct gb_spi_frame_hdr {
+	__le16 cport;
+	__le16 len;
+	uint8_t credits;
+	uint8_t pad;
+} __packed;
+
+#define FRAME_SIZE (sizeof(struct gb_spi_frame_hdr) + CONFIG_GREYBUS_XPORT_SPI_MAX_MESSAGE_SIZE)
+
+static uint8_t host_tx[FRAME_SIZE];
+static uint8_t host_rx[FRAME_SIZE];
+
+static K_SEM_DEFINE(xfer_start, 0, 1);
+static K_SEM_DEFINE(xfer_done, 0, 1);
+
+static const struct gpio_dt_spec data_ready =
+	GPIO_DT_SPEC_GET(DT_PATH(zephyr_user), greybus_int_gpios);
+
+/*
+ * Stand-in for the SPI controller. The node blocks in spi_transceive() until the test clocks a
+ * frame with host_transfer().
+ */
+static int host_emul_io(const struct emul *target, const struct spi_config *config,
+			const struct spi_buf_set *tx_bufs, const struct spi_buf_set *rx_bufs)
+{
+	ARG_UNUSED(target);
+
+	zassert_true(config->operation & SPI_OP_MODE_SLAVE, "Node should be an SPI target");
+	zassert_equal(tx_bufs->count, 1, "Frame should be a single transfer");
+	zassert_equal(tx_bufs->buffers[0].len, FRAME_SIZE, "Invalid frame size");
+	zassert_equal(rx_bufs->buffers[0].len, FRAME_SIZE, "Invalid frame size");
+
+	k_sem_take(&xfer_start, K_FOREVER);
+
+	memcpy(host_rx, tx_bufs->buffers[0].buf, FRAME_SIZE);
+	memcpy(rx_bufs->buffers[0].buf, host_tx, FRAME_SIZE);
+
+	k_sem_give(&xfer_done);
+
+	return FRAME_SIZE;
+}
+
+static const struct spi_emul_api host_emul_api = {
+	.io = host_emul_io,
+};
+
+static int host_emul_init(const struct emul *target, const struct device *parent)
+{
+	ARG_UNUSED(target);
+	ARG_UNUSED(parent);
+
+	return 0;
+}
+
+DEVICE_DT_INST_DEFINE(0, NULL, NULL, NULL, NULL, POST_KERNEL, CONFIG_APPLICATION_INIT_PRIORITY,
+		      NULL);
+EMUL_DT_INST_DEFINE(0, host_emul_init, NULL, NULL, &host_emul_api, NULL);
+
+/*
+ * Clock one frame. msg can be NULL to only update credits.
+ */
+static const struct gb_spi_frame_hdr *host_transfer(const struct gb_message *msg, uint8_t credits)
+{
+	struct gb_spi_frame_hdr *hdr = (struct gb_spi_frame_hdr *)host_tx;
+
+	memset(host_tx, 0, sizeof(host_tx));
+	hdr->credits = credits;
+
+	if (msg) {
+		hdr->cport = sys_cpu_to_le16(LOOPBACK_CPORT);
+		hdr->len = sys_cpu_to_le16(gb_message_len(msg));
+		memcpy(&host_tx[sizeof(*hdr)], msg, gb_message_len(msg));
+	}
+
+	k_sem_give(&xfer_start);
+	zassert_ok(k_sem_take(&xfer_done, K_SECONDS(1)), "Node did not clock a frame");
+
+	return (const struct gb_spi_frame_hdr *)host_rx;
+}
+
+/*
+ * Clock empty frames until the node sends a message.
+ */
+static const struct gb_spi_frame_hdr *host_fetch(void)
+{
+	const struct gb_spi_frame_hdr *hdr;
+	size_t i;
+
+	for (i = 0; i < MAX_TRANSFERS; i++) {
+		k_msleep(10);
+		hdr = host_transfer(NULL, HOST_CREDITS);
+		if (sys_le16_to_cpu(hdr->len) > 0) {
+			return hdr;
+		}
+	}
+
+	return NULL;
+}
+
+static void check_ping_response(const struct gb_spi_frame_hdr *hdr)
+{
+	const struct gb_operation_msg_hdr *resp =
+		(const struct gb_operation_msg_hdr *)&host_rx[sizeof(*hdr)];
+
+	zassert_not_null(hdr, "No response from node");
+	zassert_equal(sys_le16_to_cpu(hdr->cport), LOOPBACK_CPORT, "Invalid cport");
+	zassert_equal(sys_le16_to_cpu(hdr->len), sizeof(*resp), "Invalid frame length");
+	zassert_equal(resp->type, GB_RESPONSE(GB_LOOPBACK_TYPE_PING), "Invalid response type");
+	zassert_equal(resp->result, GB_OP_SUCCESS, "Greybus loopback ping failed");
+}
+
+ZTEST_SUITE(greybus_transport_spi_tests, NULL, NULL, NULL, NULL, NULL);
+
+ZTEST(greybus_transport_spi_tests, test_credits)
+{
+	const struct gb_spi_frame_hdr *hdr = host_transfer(NULL, HOST_CREDITS);
+
+	zassert_equal(sys_le16_to_cpu(hdr->len), 0, "Idle node should send empty frames");
+	zassert_equal(hdr->credits, CONFIG_GREYBUS_XPORT_SPI_RX_CREDITS, "Invalid node credits");
+
+	k_msleep(10);
+	zassert_equal(gpio_emul_output_get(data_ready.port, data_ready.pin), 0,
+		      "Data ready should not be asserted");
+}
+
+ZTEST(greybus_transport_spi_tests, test_ping)
+{
+	struct gb_message *req = gb_message_request_alloc(0, GB_LOOPBACK_TYPE_PING, false);
+
+	host_transfer(req, HOST_CREDITS);
+	gb_message_dealloc(req);
+
+	check_ping_response(host_fetch());
+}
+
+ZTEST(greybus_transport_spi_tests, test_no_host_credits)
+{
+	struct gb_message *req = gb_message_request_alloc(0, GB_LOOPBACK_TYPE_PING, false);
+	const struct gb_spi_frame_hdr *hdr;
+	size_t i;
+
+	host_transfer(req, 0);
+	gb_message_dealloc(req);
+
+	for (i = 0; i < MAX_TRANSFERS; i++) {
+		k_msleep(10);
+		hdr = host_transfer(NULL, 0);
+		zassert_equal(sys_le16_to_cpu(hdr->len), 0, "Node sent without credits");
+	}
+
+	zassert_equal(gpio_emul_output_get(data_ready.port, data_ready.pin), 1,
+		      "Data ready should be asserted");
+
+	check_ping_response(host_fetch());
+}
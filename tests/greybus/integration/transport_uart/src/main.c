@@ -0,0 +1,401 @@
+/*
+ * Copyright (c) 2026 BeagleBoard.org
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/serial/uart_emul.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/crc.h>
+#include <greybus/greybus.h>
+#include "transport/hdlc/hdlc.h"
+
+#define LOOPBACK_CPORT 1
+
+/* Wire format of the HDLC link, see transport/hdlc/hdlc.c */
+#define HDLC_FRAME      0x7E
+#define HDLC_ESC        0x7D
+#define HDLC_ADDRESS    0x01
+#define HDLC_SFRAME_RR  0x00
+#define HDLC_SFRAME_REJ 0x01
+
+#define HDLC_CTRL_IS_IFRAME(ctrl) (((ctrl) & 0x01) == 0x00)
+#define HDLC_CTRL_NS(ctrl)        (((ctrl) >> 1) & 0x07)
+#define HDLC_CTRL_NR(ctrl)        (((ctrl) >> 5) & 0x07)
+#define HDLC_CTRL_STYPE(ctrl)     (((ctrl) >> 2) & 0x03)
+#define HDLC_IFRAME(ns, nr)       ((uint8_t)(((nr) << 5) | ((ns) << 1)))
+#define HDLC_SFRAME(type, nr)     ((uint8_t)(((nr) << 5) | ((type) << 2) | 0x01))
+#define HDLC_SEQ(x)               ((uint8_t)((x) & 0x07))
+
+#define QUIET_TIME       K_MSEC(50)
+#define RESPONSE_TIMEOUT K_MSEC(100)
+#define RETRANSMIT_WAIT  K_MSEC(2 * CONFIG_GREYBUS_HDLC_RETRANSMIT_TIMEOUT_MS)
+
+struct host_frame {
+	uint8_t ctrl;
+	size_t len;
+	uint8_t payload[HDLC_MAX_BLOCK_SIZE];
+};
+
+/* Mirror of the node side frame, cport followed by the Greybus message */
+struct hdlc_greybus_frame {
+	__le16 cport;
+	struct gb_operation_msg_hdr hdr;
+} __packed;
+
+static const struct device *uart_dev = DEVICE_DT_GET(DT_NODELABEL(euart0));
+
+/* Sequence state of the emulated host */
+static uint8_t host_vs;
+static uint8_t host_vr;
+
+/* Partially received node frame */
+static uint8_t rx_raw[HDLC_MAX_BLOCK_SIZE];
+static size_t rx_len;
+static bool rx_escaped;
+
+static void host_put(uint8_t *buf, size_t *len, uint8_t byte)
+{
+	if (byte == HDLC_FRAME || byte == HDLC_ESC) {
+		buf[(*len)++] = HDLC_ESC;
+		byte ^= 0x20;
+	}
+	buf[(*len)++] = byte;
+}
+
+static void host_send(uint8_t ctrl, const void *payload, size_t len)
+{
+	uint8_t raw[HDLC_MAX_BLOCK_SIZE];
+	uint8_t wire[2 * HDLC_MAX_BLOCK_SIZE];
+	size_t raw_len = 0, wire_len = 0, i;
+	uint16_t crc;
+
+	raw[raw_len++] = HDLC_ADDRESS;
+	raw[raw_len++] = ctrl;
+	if (len) {
+		memcpy(&raw[raw_len], payload, len);
+		raw_len += len;
+	}
+
+	crc = crc16_ccitt(0xffff, raw, raw_len) ^ 0xffff;
+	raw[raw_len++] = crc & 0xff;
+	raw[raw_len++] = crc >> 8;
+
+	wire[wire_len++] = HDLC_FRAME;
+	for (i = 0; i < raw_len; i++) {
+		host_put(wire, &wire_len, raw[i]);
+	}
+	wire[wire_len++] = HDLC_FRAME;
+
+	zassert_equal(uart_emul_put_rx_data(uart_dev, wire, wire_len), wire_len,
+		      "UART RX FIFO full");
+}
+
+/* A whole U-frame with a broken CRC */
+static void host_send_corrupted(void)
+{
+	const uint8_t wire[] = {HDLC_FRAME, HDLC_ADDRESS, 0x03, 0x12, 0x34, 0x00, 0x00, HDLC_FRAME};
+
+	zassert_equal(uart_emul_put_rx_data(uart_dev, wire, sizeof(wire)), sizeof(wire),
+		      "UART RX FIFO full");
+}
+
+/* Send a loopback ping as I-frame with sequence number ns */
+static void host_send_ping(uint8_t ns)
+{
+	struct gb_message *req = gb_message_request_alloc(0, GB_LOOPBACK_TYPE_PING, false);
+	struct hdlc_greybus_frame frame = {
+		.cport = sys_cpu_to_le16(LOOPBACK_CPORT),
+		.hdr = req->header,
+	};
+
+	gb_message_dealloc(req);
+	host_send(HDLC_IFRAME(ns, host_vr), &frame, sizeof(frame));
+}
+
+static void host_send_sframe(uint8_t type, uint8_t nr)
+{
+	host_send(HDLC_SFRAME(type, nr), NULL, 0);
+}
+
+/* Receive the next valid frame sent by the node */
+static bool host_recv(struct host_frame *frame, k_timeout_t timeout)
+{
+	const k_timepoint_t end = sys_timepoint_calc(timeout);
+	uint8_t byte;
+
+	while (true) {
+		if (uart_emul_get_tx_data(uart_dev, &byte, 1) == 0) {
+			if (sys_timepoint_expired(end)) {
+				return false;
+			}
+			k_msleep(1);
+			continue;
+		}
+
+		if (byte == HDLC_FRAME) {
+			if (rx_len >= 4 && crc16_ccitt(0xffff, rx_raw, rx_len) == 0xf0b8) {
+				zassert_equal(rx_raw[0], HDLC_ADDRESS, "Invalid HDLC address");
+				frame->ctrl = rx_raw[1];
+				frame->len = rx_len - 4;
+				memcpy(frame->payload, &rx_raw[2], frame->len);
+				rx_len = 0;
+				return true;
+			}
+			rx_len = 0;
+		} else if (byte == HDLC_ESC) {
+			rx_escaped = true;
+		} else {
+			if (rx_escaped) {
+				byte ^= 0x20;
+				rx_escaped = false;
+			}
+			zassert_true(rx_len < sizeof(rx_raw), "Node frame too long");
+			rx_raw[rx_len++] = byte;
+		}
+	}
+}
+
+/* Next I-frame of the node, acknowledgements sent before it are skipped */
+static void host_expect_iframe(struct host_frame *frame, k_timeout_t timeout)
+{
+	do {
+		zassert_true(host_recv(frame, timeout), "No I-frame from node");
+	} while (!HDLC_CTRL_IS_IFRAME(frame->ctrl) &&
+		 HDLC_CTRL_STYPE(frame->ctrl) == HDLC_SFRAME_RR);
+
+	zassert_true(HDLC_CTRL_IS_IFRAME(frame->ctrl), "Expected an I-frame, got 0x%02x",
+		     frame->ctrl);
+}
+
+static void host_expect_ping_response(void)
+{
+	struct host_frame frame;
+	const struct hdlc_greybus_frame *resp = (const struct hdlc_greybus_frame *)frame.payload;
+
+	host_expect_iframe(&frame, RESPONSE_TIMEOUT);
+	zassert_equal(HDLC_CTRL_NS(frame.ctrl), host_vr, "Node skipped a sequence number");
+	zassert_equal(frame.len, sizeof(*resp), "Invalid frame length");
+	zassert_equal(sys_le16_to_cpu(resp->cport), LOOPBACK_CPORT, "Invalid cport");
+	zassert_equal(resp->hdr.type, GB_RESPONSE(GB_LOOPBACK_TYPE_PING), "Invalid response type");
+	zassert_equal(resp->hdr.result, GB_OP_SUCCESS, "Greybus loopback ping failed");
+
+	host_vr = HDLC_SEQ(host_vr + 1);
+}
+
+static void host_expect_sframe(struct host_frame *frame)
+{
+	zassert_true(host_recv(frame, RESPONSE_TIMEOUT), "No S-frame from node");
+	zassert_false(HDLC_CTRL_IS_IFRAME(frame->ctrl), "Expected an S-frame, got 0x%02x",
+		      frame->ctrl);
+}
+
+static void host_expect_quiet(void)
+{
+	struct host_frame frame;
+
+	while (host_recv(&frame, QUIET_TIME)) {
+		zassert_false(HDLC_CTRL_IS_IFRAME(frame.ctrl), "Unexpected I-frame from node");
+	}
+}
+
+/* Ping in sequence and acknowledge the response */
+static void host_ping(void)
+{
+	host_send_ping(host_vs);
+	host_vs = HDLC_SEQ(host_vs + 1);
+	host_expect_ping_response();
+	host_send_sframe(HDLC_SFRAME_RR, host_vr);
+}
+
+static void transport_uart_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	/* Drop acknowledgements left over by the previous test */
+	host_expect_quiet();
+}
+
+ZTEST_SUITE(greybus_transport_uart_tests, NULL, NULL, transport_uart_before, NULL, NULL);
+
+/* Tests run in name order, this one has to come before any I-frame reaches the node */
+ZTEST(greybus_transport_uart_tests, test_corrupted_before_iframes)
+{
+	struct hdlc_stats before, after;
+	struct host_frame frame;
+
+	hdlc_stats_get(&before);
+
+	/* The host may only speak U-frames, it could not parse a reject */
+	host_send_corrupted();
+	zassert_false(host_recv(&frame, QUIET_TIME), "Node should not send a reject");
+
+	hdlc_stats_get(&after);
+	zassert_equal(after.rx_crc_errors, before.rx_crc_errors + 1, "Corruption not counted");
+	zassert_equal(after.rej_sent, before.rej_sent, "Reject sent to a U-frame peer");
+}
+
+ZTEST(greybus_transport_uart_tests, test_ping)
+{
+	struct hdlc_stats before, after;
+
+	hdlc_stats_get(&before);
+	host_ping();
+	host_expect_quiet();
+	hdlc_stats_get(&after);
+
+	zassert_equal(after.rx_frames, before.rx_frames + 1, "Frame not delivered");
+	zassert_equal(after.tx_frames, before.tx_frames + 1, "Response not counted");
+	zassert_equal(after.tx_retransmits, before.tx_retransmits, "Acked frame retransmitted");
+}
+
+ZTEST(greybus_transport_uart_tests, test_lost_frame)
+{
+	struct hdlc_stats before, after;
+	struct host_frame frame;
+
+	hdlc_stats_get(&before);
+
+	/* Frame host_vs is lost, the next one is rejected */
+	host_send_ping(HDLC_SEQ(host_vs + 1));
+	host_expect_sframe(&frame);
+	zassert_equal(HDLC_CTRL_STYPE(frame.ctrl), HDLC_SFRAME_REJ, "Gap should be rejected");
+	zassert_equal(HDLC_CTRL_NR(frame.ctrl), host_vs, "Reject should point at the lost frame");
+
+	/* Go back to the lost frame */
+	host_send_ping(host_vs);
+	host_send_ping(HDLC_SEQ(host_vs + 1));
+	host_vs = HDLC_SEQ(host_vs + 2);
+	host_expect_ping_response();
+	host_expect_ping_response();
+	host_send_sframe(HDLC_SFRAME_RR, host_vr);
+
+	hdlc_stats_get(&after);
+	zassert_equal(after.rx_frames, before.rx_frames + 2, "Frames not delivered once");
+	zassert_equal(after.rx_out_of_seq, before.rx_out_of_seq + 1, "Gap not counted");
+	zassert_equal(after.rej_sent, before.rej_sent + 1, "Reject not counted");
+}
+
+ZTEST(greybus_transport_uart_tests, test_out_of_order)
+{
+	struct hdlc_stats before, after;
+	struct host_frame frame;
+
+	hdlc_stats_get(&before);
+
+	/* Frames host_vs and host_vs + 1 arrive swapped */
+	host_send_ping(HDLC_SEQ(host_vs + 1));
+	host_expect_sframe(&frame);
+	zassert_equal(HDLC_CTRL_STYPE(frame.ctrl), HDLC_SFRAME_REJ, "Gap should be rejected");
+	zassert_equal(HDLC_CTRL_NR(frame.ctrl), host_vs, "Reject should point at the gap");
+
+	host_send_ping(host_vs);
+	host_expect_ping_response();
+
+	/* Go-back-N dropped the early frame, it has to be sent again */
+	host_send_ping(HDLC_SEQ(host_vs + 1));
+	host_vs = HDLC_SEQ(host_vs + 2);
+	host_expect_ping_response();
+	host_send_sframe(HDLC_SFRAME_RR, host_vr);
+
+	hdlc_stats_get(&after);
+	zassert_equal(after.rx_frames, before.rx_frames + 2, "Frames not delivered once");
+	zassert_equal(after.rx_out_of_seq, before.rx_out_of_seq + 1, "Early frame not counted");
+}
+
+ZTEST(greybus_transport_uart_tests, test_lost_ack)
+{
+	struct hdlc_stats before, after;
+	struct host_frame frame;
+	const uint8_t ns = host_vs;
+
+	host_ping();
+	host_expect_quiet();
+	hdlc_stats_get(&before);
+
+	/* The host missed the acknowledgement and sends the frame again */
+	host_send_ping(ns);
+	host_expect_sframe(&frame);
+	zassert_equal(HDLC_CTRL_NR(frame.ctrl), host_vs, "Duplicate should be acknowledged");
+	host_expect_quiet();
+
+	hdlc_stats_get(&after);
+	zassert_equal(after.rx_frames, before.rx_frames, "Duplicate delivered");
+	zassert_equal(after.rx_out_of_seq, before.rx_out_of_seq + 1, "Duplicate not counted");
+
+	/* The link carries on in sequence */
+	host_ping();
+}
+
+ZTEST(greybus_transport_uart_tests, test_retransmit_timeout)
+{
+	struct hdlc_stats before, after;
+	struct host_frame frame;
+	uint8_t ns;
+
+	hdlc_stats_get(&before);
+
+	/* The acknowledgement of the response is lost */
+	host_send_ping(host_vs);
+	host_vs = HDLC_SEQ(host_vs + 1);
+	host_expect_ping_response();
+	ns = HDLC_SEQ(host_vr - 1);
+
+	host_expect_iframe(&frame, RETRANSMIT_WAIT);
+	zassert_equal(HDLC_CTRL_NS(frame.ctrl), ns, "Unacknowledged frame not retransmitted");
+	host_send_sframe(HDLC_SFRAME_RR, host_vr);
+	host_expect_quiet();
+
+	hdlc_stats_get(&after);
+	zassert_equal(after.tx_timeouts, before.tx_timeouts + 1, "Timeout not counted");
+	zassert_equal(after.tx_retransmits, before.tx_retransmits + 1, "Retransmit not counted");
+}
+
+ZTEST(greybus_transport_uart_tests, test_rej_received)
+{
+	struct hdlc_stats before, after;
+	struct host_frame frame;
+	uint8_t ns;
+
+	hdlc_stats_get(&before);
+
+	/* The response arrived corrupted, reject it */
+	host_send_ping(host_vs);
+	host_vs = HDLC_SEQ(host_vs + 1);
+	host_expect_ping_response();
+	ns = HDLC_SEQ(host_vr - 1);
+	host_send_sframe(HDLC_SFRAME_REJ, ns);
+
+	/* Well before the acknowledgement timeout */
+	host_expect_iframe(&frame, RESPONSE_TIMEOUT);
+	zassert_equal(HDLC_CTRL_NS(frame.ctrl), ns, "Rejected frame not retransmitted");
+	host_send_sframe(HDLC_SFRAME_RR, host_vr);
+	host_expect_quiet();
+
+	hdlc_stats_get(&after);
+	zassert_equal(after.rej_received, before.rej_received + 1, "Reject not counted");
+	zassert_equal(after.tx_timeouts, before.tx_timeouts, "Should not wait for the timeout");
+}
+
+ZTEST(greybus_transport_uart_tests, test_rej_sent_on_corruption)
+{
+	struct hdlc_stats before, after;
+	struct host_frame frame;
+
+	host_ping();
+	host_expect_quiet();
+	hdlc_stats_get(&before);
+
+	/* The peer sent I-frames, a corrupted frame is rejected right away */
+	host_send_corrupted();
+	host_expect_sframe(&frame);
+	zassert_equal(HDLC_CTRL_STYPE(frame.ctrl), HDLC_SFRAME_REJ, "Corruption should be rejected");
+	zassert_equal(HDLC_CTRL_NR(frame.ctrl), host_vs, "Reject should point at V(R)");
+
+	hdlc_stats_get(&after);
+	zassert_equal(after.rej_sent, before.rej_sent + 1, "Reject not counted");
+
+	host_ping();
+}
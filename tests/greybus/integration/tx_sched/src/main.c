@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2026 BeagleBoard.org
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/ztest.h>
+#include <greybus/greybus.h>
+#include <greybus-utils/manifest.h>
+#include "greybus_transport.h"
+
+#define CONTROL_CPORT  0
+#define LOOPBACK_CPORT 1
+/* Larger than half the quantum, so that a flow sends a single message per round */
+#define BULK_SIZE      100
+
+struct gb_msg_with_cport gb_transport_get_message(void);
+
+/*
+ * The test thread has a higher priority than the scheduler thread, so everything queued here is
+ * only picked once the test waits for the first message.
+ */
+static void queue(uint16_t cport, size_t payload_len, uint8_t type, bool oneshot)
+{
+	struct gb_message *msg = gb_message_request_alloc(payload_len, type, oneshot);
+
+	zassert_ok(gb_transport_message_send(msg, cport), "Failed to queue message");
+	gb_message_dealloc(msg);
+}
+
+static void expect(uint16_t cport, uint8_t type)
+{
+	struct gb_msg_with_cport resp = gb_transport_get_message();
+
+	zassert_equal(resp.cport, cport, "Invalid cport");
+	zassert_equal(gb_message_type(resp.msg), type, "Invalid message type");
+	gb_message_dealloc(resp.msg);
+}
+
+static void tx_sched_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	gb_tx_sched_set_class(CONTROL_CPORT, GB_TX_CLASS_AUTO);
+	gb_tx_sched_set_class(LOOPBACK_CPORT, GB_TX_CLASS_AUTO);
+}
+
+ZTEST_SUITE(greybus_tx_sched_tests, NULL, NULL, tx_sched_before, NULL, NULL);
+
+ZTEST(greybus_tx_sched_tests, test_control_preempts_bulk)
+{
+	size_t i;
+
+	gb_tx_sched_set_class(LOOPBACK_CPORT, GB_TX_CLASS_BULK);
+
+	for (i = 0; i < 3; i++) {
+		queue(LOOPBACK_CPORT, BULK_SIZE, GB_LOOPBACK_TYPE_TRANSFER, true);
+	}
+	queue(CONTROL_CPORT, 0, GB_LOOPBACK_TYPE_PING, false);
+
+	expect(CONTROL_CPORT, GB_LOOPBACK_TYPE_PING);
+	for (i = 0; i < 3; i++) {
+		expect(LOOPBACK_CPORT, GB_LOOPBACK_TYPE_TRANSFER);
+	}
+}
+
+ZTEST(greybus_tx_sched_tests, test_event_before_request)
+{
+	gb_tx_sched_set_class(CONTROL_CPORT, GB_TX_CLASS_REQUEST);
+	gb_tx_sched_set_class(LOOPBACK_CPORT, GB_TX_CLASS_EVENT);
+
+	queue(CONTROL_CPORT, 0, GB_LOOPBACK_TYPE_PING, false);
+	queue(LOOPBACK_CPORT, 0, GB_LOOPBACK_TYPE_SINK, true);
+
+	expect(LOOPBACK_CPORT, GB_LOOPBACK_TYPE_SINK);
+	expect(CONTROL_CPORT, GB_LOOPBACK_TYPE_PING);
+}
+
+ZTEST(greybus_tx_sched_tests, test_cport_order)
+{
+	/* An event must not overtake a request queued before it on the same cport */
+	queue(LOOPBACK_CPORT, 0, GB_LOOPBACK_TYPE_PING, false);
+	queue(LOOPBACK_CPORT, 0, GB_LOOPBACK_TYPE_SINK, true);
+
+	expect(LOOPBACK_CPORT, GB_LOOPBACK_TYPE_PING);
+	expect(LOOPBACK_CPORT, GB_LOOPBACK_TYPE_SINK);
+}
+
+ZTEST(greybus_tx_sched_tests, test_backend_failure)
+{
+	struct gb_message *msg = gb_message_request_alloc(0, GB_LOOPBACK_TYPE_SINK, true);
+	atomic_t failed = ATOMIC_INIT(0);
+	size_t i;
+
+	/* The dummy backend holds two messages, the third one fails once dequeued */
+	for (i = 0; i < 3; i++) {
+		zassert_ok(gb_transport_message_send_tracked(msg, LOOPBACK_CPORT, &failed),
+			   "Failed to queue message");
+	}
+	gb_message_dealloc(msg);
+
+	k_msleep(10);
+	zassert_equal(atomic_get(&failed), 1, "Backend failure not counted");
+
+	expect(LOOPBACK_CPORT, GB_LOOPBACK_TYPE_SINK);
+	expect(LOOPBACK_CPORT, GB_LOOPBACK_TYPE_SINK);
+}
+
+ZTEST(greybus_tx_sched_tests, test_round_robin)
+{
+	size_t i;
+
+	gb_tx_sched_set_class(CONTROL_CPORT, GB_TX_CLASS_BULK);
+	gb_tx_sched_set_class(LOOPBACK_CPORT, GB_TX_CLASS_BULK);
+
+	for (i = 0; i < 3; i++) {
+		queue(LOOPBACK_CPORT, BULK_SIZE, GB_LOOPBACK_TYPE_TRANSFER, true);
+	}
+	for (i = 0; i < 3; i++) {
+		queue(CONTROL_CPORT, BULK_SIZE, GB_LOOPBACK_TYPE_TRANSFER, true);
+	}
+
+	/* The stream queued first can't take the link for itself */
+	for (i = 0; i < 3; i++) {
+		expect(LOOPBACK_CPORT, GB_LOOPBACK_TYPE_TRANSFER);
+		expect(CONTROL_CPORT, GB_LOOPBACK_TYPE_TRANSFER);
+	}
+}